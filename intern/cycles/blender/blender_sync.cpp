@@ -275,6 +275,11 @@ void BlenderSync::sync_integrator()
 
   integrator->sample_clamp_direct = get_float(cscene, "sample_clamp_direct");
   integrator->sample_clamp_indirect = get_float(cscene, "sample_clamp_indirect");
+
+  integrator->use_adaptive_sampling = get_boolean(cscene, "use_adaptive_sampling");
+  integrator->adaptive_threshold = get_float(cscene, "adaptive_threshold");
+  integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
+
   if (!preview) {
     if (integrator->motion_blur != r.use_motion_blur()) {
       scene->object_manager->tag_update(scene);
@@ -482,6 +487,7 @@ PassType BlenderSync::get_pass_type(BL::RenderPass &b_pass)
   MAP_PASS("Debug Ray Bounces", PASS_RAY_BOUNCES);
 #endif
   MAP_PASS("Debug Render Time", PASS_RENDER_TIME);
+  MAP_PASS("Debug Sample Count", PASS_SAMPLE_COUNT);
   if (string_startswith(name, cryptomatte_prefix)) {
     return PASS_CRYPTOMATTE;
   }
@@ -589,6 +595,10 @@ vector<Pass> BlenderSync::sync_render_passes(BL::RenderLayer &b_rlay, BL::ViewLa
     b_engine.add_pass("Debug Render Time", 1, "X", b_view_layer.name().c_str());
     Pass::add(PASS_RENDER_TIME, passes);
   }
+  if (get_boolean(crp, "pass_debug_sample_count")) {
+    b_engine.add_pass("Debug Sample Count", 1, "X", b_view_layer.name().c_str());
+    Pass::add(PASS_SAMPLE_COUNT, passes);
+  }
   if (get_boolean(crp, "use_pass_volume_direct")) {
     b_engine.add_pass("VolumeDir", 3, "RGB", b_view_layer.name().c_str());
     Pass::add(PASS_VOLUME_DIRECT, passes);
@@ -635,6 +645,13 @@ vector<Pass> BlenderSync::sync_render_passes(BL::RenderLayer &b_rlay, BL::ViewLa
                                                         CRYPT_ACCURATE);
   }
 
+  /* Adaptive sampling keeps a second estimate and the sample count of every pixel. */
+  PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
+  if (get_boolean(cscene, "use_adaptive_sampling")) {
+    Pass::add(PASS_ADAPTIVE_AUX_BUFFER, passes);
+    Pass::add(PASS_SAMPLE_COUNT, passes);
+  }
+
   return passes;
 }
 
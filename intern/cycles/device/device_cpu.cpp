@@ -34,6 +34,7 @@
 #include "kernel/kernel_types.h"
 #include "kernel/split/kernel_split_data.h"
 #include "kernel/kernel_globals.h"
+#include "kernel/kernel_adaptive_sampling.h"
 
 #include "kernel/filter/filter.h"
 
@@ -854,11 +855,75 @@ class CPUDevice : public Device {
 
       tile.sample = sample + 1;
 
+      if (task.adaptive_sampling.need_filter(sample) &&
+          adaptive_sampling_filter(kg, tile, sample)) {
+        /* Every pixel of the tile converged, account for the samples that are skipped. */
+        tile.sample = end_sample;
+        task.update_progress(&tile, tile.w * tile.h * (end_sample - sample));
+        break;
+      }
+
       task.update_progress(&tile, tile.w * tile.h);
     }
     if (use_coverage) {
       coverage.finalize();
     }
+    if (task.adaptive_sampling.use) {
+      adaptive_sampling_post(kg, tile);
+    }
+  }
+
+  /* Marks converged pixels and dilates the unconverged ones, returns true once the whole
+   * tile has converged. */
+  bool adaptive_sampling_filter(KernelGlobals *kg, RenderTile &tile, int sample)
+  {
+    WorkTile wtile;
+    wtile.x = tile.x;
+    wtile.y = tile.y;
+    wtile.w = tile.w;
+    wtile.h = tile.h;
+    wtile.offset = tile.offset;
+    wtile.stride = tile.stride;
+    wtile.buffer = (float *)tile.buffer;
+
+    for (int y = tile.y; y < tile.y + tile.h; ++y) {
+      for (int x = tile.x; x < tile.x + tile.w; ++x) {
+        int index = tile.offset + x + y * tile.stride;
+        float *buffer = wtile.buffer + index * kernel_data.film.pass_stride;
+        if (!kernel_adaptive_pixel_converged(kg, buffer)) {
+          kernel_do_adaptive_stopping(kg, buffer, sample);
+        }
+      }
+    }
+
+    bool any = false;
+    for (int y = tile.y; y < tile.y + tile.h; ++y) {
+      any |= kernel_do_adaptive_filter_x(kg, y, &wtile);
+    }
+    for (int x = tile.x; x < tile.x + tile.w; ++x) {
+      any |= kernel_do_adaptive_filter_y(kg, x, &wtile);
+    }
+    return !any;
+  }
+
+  /* Rescales pixels that stopped early to the sample count of the tile. */
+  void adaptive_sampling_post(KernelGlobals *kg, const RenderTile &tile)
+  {
+    if (!kernel_data.film.pass_sample_count) {
+      return;
+    }
+
+    float *render_buffer = (float *)tile.buffer;
+    for (int y = tile.y; y < tile.y + tile.h; ++y) {
+      for (int x = tile.x; x < tile.x + tile.w; ++x) {
+        int index = tile.offset + x + y * tile.stride;
+        float *buffer = render_buffer + index * kernel_data.film.pass_stride;
+        float num_samples = buffer[kernel_data.film.pass_sample_count];
+        if (num_samples > 0.0f && num_samples < (float)tile.sample) {
+          kernel_adaptive_post_adjust(kg, buffer, (float)tile.sample / num_samples);
+        }
+      }
+    }
   }
 
   void denoise(DenoisingTask &denoising, RenderTile &tile)
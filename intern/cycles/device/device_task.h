@@ -59,6 +59,30 @@ class DenoiseParams {
   }
 };
 
+class AdaptiveSampling {
+ public:
+  /* Stop sampling pixels whose estimated error is below the integrator threshold. */
+  bool use;
+  /* Number of samples between convergence checks, must be a power of two. */
+  int adaptive_step;
+  /* Samples every pixel receives before it may be considered converged. */
+  int min_samples;
+
+  AdaptiveSampling()
+  {
+    use = false;
+    adaptive_step = 4;
+    min_samples = 0;
+  }
+
+  /* Whether convergence is checked after rendering the given zero based sample. */
+  bool need_filter(int sample) const
+  {
+    return use && sample > min_samples &&
+           (sample & (adaptive_step - 1)) == (adaptive_step - 1);
+  }
+};
+
 class DeviceTask : public Task {
  public:
   typedef enum { RENDER, FILM_CONVERT, SHADER } Type;
@@ -108,6 +132,8 @@ class DeviceTask : public Task {
   int pass_denoising_data;
   int pass_denoising_clean;
 
+  AdaptiveSampling adaptive_sampling;
+
   bool need_finish_queue;
   bool integrator_branched;
   int2 requested_tile_size;
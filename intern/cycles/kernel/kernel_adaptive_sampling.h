@@ -0,0 +1,217 @@
+/*
+ * Copyright 2019 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KERNEL_ADAPTIVE_SAMPLING_H__
+#define __KERNEL_ADAPTIVE_SAMPLING_H__
+
+CCL_NAMESPACE_BEGIN
+
+/* The auxiliary buffer accumulates twice the radiance of every odd sample, so its RGB is
+ * an independent estimate of the combined pass built from half of the samples. Its fourth
+ * component is non-zero once the pixel has converged and no more samples are taken. */
+
+ccl_device_inline ccl_global float4 *kernel_adaptive_aux(KernelGlobals *kg,
+                                                         ccl_global float *buffer)
+{
+  return (ccl_global float4 *)(buffer + kernel_data.film.pass_adaptive_aux_buffer);
+}
+
+ccl_device_inline bool kernel_adaptive_pixel_converged(KernelGlobals *kg,
+                                                       ccl_global float *buffer)
+{
+  return kernel_data.film.pass_adaptive_aux_buffer && kernel_adaptive_aux(kg, buffer)->w > 0.0f;
+}
+
+/* Determines whether to continue sampling a given pixel or if it has sufficiently converged.
+ * The per pixel error follows section 2.1 of "A hierarchical automatic stopping condition for
+ * Monte Carlo global illumination", comparing the full estimate against the half estimate. */
+ccl_device void kernel_do_adaptive_stopping(KernelGlobals *kg,
+                                            ccl_global float *buffer,
+                                            int sample)
+{
+  /* Pixels that resumed after dilation hold fewer samples than the tile. */
+  const int num_samples = kernel_data.film.pass_sample_count ?
+                              (int)buffer[kernel_data.film.pass_sample_count] :
+                              sample + 1;
+  float4 I = *((ccl_global float4 *)buffer);
+  ccl_global float4 *aux = kernel_adaptive_aux(kg, buffer);
+  float4 A = *aux;
+
+  /* A small epsilon is added to the divisor to prevent division by zero. */
+  float error = (fabsf(I.x - A.x) + fabsf(I.y - A.y) + fabsf(I.z - A.z)) /
+                (num_samples * 0.0001f + sqrtf(fmaxf(I.x + I.y + I.z, 0.0f)));
+  if (error < kernel_data.integrator.adaptive_threshold * (float)num_samples) {
+    aux->w += 1.0f;
+  }
+}
+
+/* Adjacent pixels of a pixel that is still being sampled are sampled as well, this dilates
+ * the unconverged regions to avoid artifacts at their boundaries. Returns true if any pixel
+ * of the row still needs samples. */
+ccl_device bool kernel_do_adaptive_filter_x(KernelGlobals *kg, int y, ccl_global WorkTile *tile)
+{
+  bool any = false;
+  bool prev = false;
+  const int x_begin = tile->x, x_end = tile->x + tile->w;
+  for (int x = x_begin; x < x_end; ++x) {
+    int index = tile->offset + x + y * tile->stride;
+    ccl_global float *buffer = tile->buffer + index * kernel_data.film.pass_stride;
+    ccl_global float4 *aux = kernel_adaptive_aux(kg, buffer);
+    if (aux->w == 0.0f) {
+      any = true;
+      if (x > x_begin && !prev) {
+        kernel_adaptive_aux(kg, buffer - kernel_data.film.pass_stride)->w = 0.0f;
+      }
+      prev = true;
+    }
+    else {
+      if (prev) {
+        aux->w = 0.0f;
+      }
+      prev = false;
+    }
+  }
+  return any;
+}
+
+ccl_device bool kernel_do_adaptive_filter_y(KernelGlobals *kg, int x, ccl_global WorkTile *tile)
+{
+  const int row_stride = tile->stride * kernel_data.film.pass_stride;
+  bool any = false;
+  bool prev = false;
+  const int y_begin = tile->y, y_end = tile->y + tile->h;
+  for (int y = y_begin; y < y_end; ++y) {
+    int index = tile->offset + x + y * tile->stride;
+    ccl_global float *buffer = tile->buffer + index * kernel_data.film.pass_stride;
+    ccl_global float4 *aux = kernel_adaptive_aux(kg, buffer);
+    if (aux->w == 0.0f) {
+      any = true;
+      if (y > y_begin && !prev) {
+        kernel_adaptive_aux(kg, buffer - row_stride)->w = 0.0f;
+      }
+      prev = true;
+    }
+    else {
+      if (prev) {
+        aux->w = 0.0f;
+      }
+      prev = false;
+    }
+  }
+  return any;
+}
+
+/* Pixels that stopped early hold fewer samples than the rest of the tile. Scale the
+ * accumulated passes so the film can keep dividing by the tile sample count. */
+
+ccl_device_inline void kernel_adaptive_scale_pass(ccl_global float *buffer,
+                                                  int components,
+                                                  float sample_multiplier)
+{
+  for (int i = 0; i < components; i++) {
+    buffer[i] *= sample_multiplier;
+  }
+}
+
+ccl_device void kernel_adaptive_post_adjust(KernelGlobals *kg,
+                                            ccl_global float *buffer,
+                                            float sample_multiplier)
+{
+  const int pass_stride = kernel_data.film.pass_stride;
+  const int pass_flag = kernel_data.film.pass_flag;
+
+  /* Passes that are not accumulated over samples keep their values as written, see the
+   * unfiltered passes in #Pass::add and the passes written only at sample 0. */
+  int skip_begin[4], skip_end[4], num_skip = 0;
+  if (pass_flag & PASSMASK(DEPTH)) {
+    skip_begin[num_skip] = kernel_data.film.pass_depth;
+    skip_end[num_skip++] = kernel_data.film.pass_depth + 1;
+  }
+  if (pass_flag & PASSMASK(OBJECT_ID)) {
+    skip_begin[num_skip] = kernel_data.film.pass_object_id;
+    skip_end[num_skip++] = kernel_data.film.pass_object_id + 1;
+  }
+  if (pass_flag & PASSMASK(MATERIAL_ID)) {
+    skip_begin[num_skip] = kernel_data.film.pass_material_id;
+    skip_end[num_skip++] = kernel_data.film.pass_material_id + 1;
+  }
+  /* Denoising data is rescaled separately below. */
+  if (kernel_data.film.pass_denoising_data) {
+    skip_begin[num_skip] = kernel_data.film.pass_denoising_data;
+    skip_end[num_skip++] = kernel_data.film.pass_denoising_data + DENOISING_PASS_SIZE_BASE;
+  }
+
+  int crypto_begin = 0, crypto_end = 0;
+  if (kernel_data.film.cryptomatte_passes) {
+    int num_types = ((kernel_data.film.cryptomatte_passes & CRYPT_OBJECT) ? 1 : 0) +
+                    ((kernel_data.film.cryptomatte_passes & CRYPT_MATERIAL) ? 1 : 0) +
+                    ((kernel_data.film.cryptomatte_passes & CRYPT_ASSET) ? 1 : 0);
+    crypto_begin = kernel_data.film.pass_cryptomatte;
+    crypto_end = crypto_begin + num_types * kernel_data.film.cryptomatte_depth * 4;
+  }
+
+  for (int i = 0; i < pass_stride; i++) {
+    if (kernel_data.film.pass_sample_count && i == kernel_data.film.pass_sample_count) {
+      continue;
+    }
+    /* The convergence flag of the auxiliary buffer. */
+    if (kernel_data.film.pass_adaptive_aux_buffer &&
+        i == kernel_data.film.pass_adaptive_aux_buffer + 3) {
+      continue;
+    }
+    /* Cryptomatte IDs, only the coverage weights are accumulated. */
+    if (i >= crypto_begin && i < crypto_end && ((i - crypto_begin) & 1) == 0) {
+      continue;
+    }
+    bool skip = false;
+    for (int j = 0; j < num_skip; j++) {
+      if (i >= skip_begin[j] && i < skip_end[j]) {
+        skip = true;
+        break;
+      }
+    }
+    if (!skip) {
+      buffer[i] *= sample_multiplier;
+    }
+  }
+
+#ifdef __DENOISING_FEATURES__
+  if (kernel_data.film.pass_denoising_data) {
+    /* Components accumulating squared samples for the variance estimate, see
+     * #kernel_write_pass_float3_variance and #kernel_write_denoising_shadow, are scaled by the
+     * square of the multiplier, otherwise the denoiser under-estimates their variance. */
+    ccl_global float *denoising = buffer + kernel_data.film.pass_denoising_data;
+    const float sample_multiplier_sq = sample_multiplier * sample_multiplier;
+
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_NORMAL, 3, sample_multiplier);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_NORMAL_VAR, 3, sample_multiplier_sq);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_ALBEDO, 3, sample_multiplier);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_ALBEDO_VAR, 3, sample_multiplier_sq);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_DEPTH, 1, sample_multiplier);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_DEPTH_VAR, 1, sample_multiplier_sq);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_SHADOW_A, 2, sample_multiplier);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_SHADOW_A + 2, 1, sample_multiplier_sq);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_SHADOW_B, 2, sample_multiplier);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_SHADOW_B + 2, 1, sample_multiplier_sq);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_COLOR, 3, sample_multiplier);
+    kernel_adaptive_scale_pass(denoising + DENOISING_PASS_COLOR_VAR, 3, sample_multiplier_sq);
+  }
+#endif /* __DENOISING_FEATURES__ */
+}
+
+CCL_NAMESPACE_END
+
+#endif /* __KERNEL_ADAPTIVE_SAMPLING_H__ */
@@ -401,6 +401,12 @@ ccl_device_inline void kernel_write_result(KernelGlobals *kg,
     kernel_write_pass_float4(buffer, make_float4(L_sum.x, L_sum.y, L_sum.z, alpha));
   }
 
+  /* Second, independent estimate from the odd samples, used for adaptive stopping. */
+  if (kernel_data.film.pass_adaptive_aux_buffer && (sample & 1)) {
+    kernel_write_pass_float4(buffer + kernel_data.film.pass_adaptive_aux_buffer,
+                             make_float4(L_sum.x * 2.0f, L_sum.y * 2.0f, L_sum.z * 2.0f, 0.0f));
+  }
+
   kernel_write_light_passes(kg, buffer, L);
 
 #ifdef __DENOISING_FEATURES__
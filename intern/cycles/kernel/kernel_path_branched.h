@@ -523,6 +523,14 @@ ccl_device void kernel_branched_path_trace(
 
   buffer += index * pass_stride;
 
+  if (kernel_adaptive_pixel_converged(kg, buffer)) {
+    return;
+  }
+
+  if (kernel_data.film.pass_sample_count) {
+    kernel_write_pass_float(buffer + kernel_data.film.pass_sample_count, 1.0f);
+  }
+
   /* initialize random numbers and ray */
   uint rng_hash;
   Ray ray;
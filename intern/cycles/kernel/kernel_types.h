@@ -371,6 +371,8 @@ typedef enum PassType {
 #endif
   PASS_RENDER_TIME,
   PASS_CRYPTOMATTE,
+  PASS_ADAPTIVE_AUX_BUFFER,
+  PASS_SAMPLE_COUNT,
   PASS_CATEGORY_MAIN_END = 31,
 
   PASS_MIST = 32,
@@ -1243,6 +1245,10 @@ typedef struct KernelFilm {
   int pass_denoising_clean;
   int denoising_flags;
 
+  int pass_adaptive_aux_buffer;
+  int pass_sample_count;
+  int pad1, pad2;
+
   /* XYZ to rendering color space transform. float4 instead of float3 to
    * ensure consistent padding/alignment across devices. */
   float4 xyz_to_r;
@@ -1355,7 +1361,12 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
-  int pad1;
+  /* adaptive sampling */
+  int adaptive_min_samples;
+  int adaptive_step;
+  float adaptive_threshold;
+
+  int pad1, pad2;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
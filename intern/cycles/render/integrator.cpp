@@ -66,6 +66,10 @@ NODE_DEFINE(Integrator)
   SOCKET_INT(volume_samples, "Volume Samples", 1);
   SOCKET_INT(start_sample, "Start Sample", 0);
 
+  SOCKET_BOOLEAN(use_adaptive_sampling, "Use Adaptive Sampling", false);
+  SOCKET_FLOAT(adaptive_threshold, "Adaptive Threshold", 0.0f);
+  SOCKET_INT(adaptive_min_samples, "Adaptive Min Samples", 0);
+
   SOCKET_BOOLEAN(sample_all_lights_direct, "Sample All Lights Direct", true);
   SOCKET_BOOLEAN(sample_all_lights_indirect, "Sample All Lights Indirect", true);
   SOCKET_FLOAT(light_sampling_threshold, "Light Sampling Threshold", 0.05f);
@@ -175,6 +179,16 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
   kintegrator->sampling_pattern = sampling_pattern;
   kintegrator->aa_samples = aa_samples;
 
+  /* Adaptive sampling, zero threshold and minimum samples derive from the sample count. */
+  const int num_aa_samples = max(aa_samples, 1);
+  kintegrator->adaptive_step = 4;
+  kintegrator->adaptive_threshold = (adaptive_threshold == 0.0f) ?
+                                        max(0.001f, 1.0f / (float)num_aa_samples) :
+                                        adaptive_threshold;
+  kintegrator->adaptive_min_samples = (adaptive_min_samples == 0) ?
+                                          max(4, (int)sqrtf((float)num_aa_samples)) :
+                                          max(kintegrator->adaptive_step, adaptive_min_samples);
+
   if (light_sampling_threshold > 0.0f) {
     kintegrator->light_inv_rr_threshold = 1.0f / light_sampling_threshold;
   }
@@ -71,6 +71,10 @@ class Integrator : public Node {
   int volume_samples;
   int start_sample;
 
+  bool use_adaptive_sampling;
+  float adaptive_threshold;
+  int adaptive_min_samples;
+
   bool sample_all_lights_direct;
   bool sample_all_lights_indirect;
   float light_sampling_threshold;
@@ -898,11 +898,12 @@ bool Session::update_scene()
   }
 
   /* number of samples is needed by multi jittered
-   * sampling pattern and by baking */
+   * sampling pattern, by baking and by adaptive sampling thresholds */
   Integrator *integrator = scene->integrator;
   BakeManager *bake_manager = scene->bake_manager;
 
-  if (integrator->sampling_pattern == SAMPLING_PATTERN_CMJ || bake_manager->get_baking()) {
+  if (integrator->sampling_pattern == SAMPLING_PATTERN_CMJ || bake_manager->get_baking() ||
+      integrator->use_adaptive_sampling) {
     int aa_samples = tile_manager.num_samples;
 
     if (aa_samples != integrator->aa_samples) {
@@ -1027,6 +1028,16 @@ void Session::render()
   task.requested_tile_size = params.tile_size;
   task.passes_size = tile_manager.params.get_passes_size();
 
+  /* Tiles rendered in a single pass can stop sampling converged pixels. */
+  if (scene->integrator->use_adaptive_sampling && params.background &&
+      !params.progressive_refine &&
+      Pass::contains(scene->film->passes, PASS_ADAPTIVE_AUX_BUFFER)) {
+    const KernelIntegrator &kintegrator = scene->dscene.data.integrator;
+    task.adaptive_sampling.use = true;
+    task.adaptive_sampling.adaptive_step = kintegrator.adaptive_step;
+    task.adaptive_sampling.min_samples = kintegrator.adaptive_min_samples;
+  }
+
   if (params.run_denoising) {
     task.denoising = params.denoising;
 
@@ -230,6 +230,46 @@ extern const char *(*MEM_name_ptr)(void *vmemh);
 /* Switch allocator to slower but fully guarded mode. */
 void MEM_use_guarded_allocator(void);
 
+/* Cache small blocks per thread in the default (lock-free) allocator, which scales better
+ * when lots of small allocations are done from multiple threads. Not supported on Windows. */
+void MEM_use_thread_cached_allocator(void);
+
+/**
+ * Allocation profiling.
+ *
+ * Sampling profiler of the default (lock-free) allocator, which estimates memory usage per
+ * allocation name and call site. It is cheap enough to be used in production, the guarded
+ * allocator has #MEM_printmemlist for exact results instead.
+ *
+ * Values are estimated from sampled allocations, roughly one per sample interval bytes.
+ * Call sites are return addresses of the allocation functions, for reallocated and
+ * duplicated blocks these point to the allocator itself.
+ */
+typedef struct MEM_ProfileStats {
+  const char *name;
+  /** NULL when statistics of all call sites were merged. */
+  const void *call_site;
+  size_t mem_in_use;
+  size_t peak_mem;
+  size_t blocks_in_use;
+  /** Memory and blocks allocated since profiling started or was reset. */
+  size_t total_mem;
+  size_t total_blocks;
+} MEM_ProfileStats;
+
+/** Enable profiling with an average of \a interval bytes between samples, zero disables it. */
+void MEM_profile_sample_interval_set(size_t interval);
+size_t MEM_profile_sample_interval_get(void);
+/** Reset peak memory to the current usage and clear the totals. */
+void MEM_profile_reset(void);
+/**
+ * Get statistics sorted by memory in use, either per call site or merged per name.
+ * Free the result with #MEM_profile_stats_free.
+ */
+MEM_ProfileStats *MEM_profile_stats_get(bool by_call_site, unsigned int *r_len);
+void MEM_profile_stats_free(MEM_ProfileStats *stats);
+void MEM_profile_print(bool by_call_site);
+
 #ifdef __cplusplus
 /* alloc funcs for C++ only */
 #  define MEM_CXX_CLASS_ALLOC_FUNCS(_id) \
@@ -96,6 +96,43 @@ void aligned_free(void *ptr)
 #endif
 }
 
+void MEM_use_thread_cached_allocator(void)
+{
+  MEM_lockfree_use_thread_cache();
+}
+
+/* Profiling is only done by the lock-free allocator, the guarded one has exact lists. */
+
+void MEM_profile_sample_interval_set(size_t interval)
+{
+  MEM_lockfree_profile_sample_interval_set(interval);
+}
+
+size_t MEM_profile_sample_interval_get(void)
+{
+  return MEM_lockfree_profile_sample_interval_get();
+}
+
+void MEM_profile_reset(void)
+{
+  MEM_lockfree_profile_reset();
+}
+
+MEM_ProfileStats *MEM_profile_stats_get(bool by_call_site, unsigned int *r_len)
+{
+  return MEM_lockfree_profile_stats_get(by_call_site, r_len);
+}
+
+void MEM_profile_stats_free(MEM_ProfileStats *stats)
+{
+  MEM_lockfree_profile_stats_free(stats);
+}
+
+void MEM_profile_print(bool by_call_site)
+{
+  MEM_lockfree_profile_print(by_call_site);
+}
+
 void MEM_use_guarded_allocator(void)
 {
   MEM_allocN_len = MEM_guarded_allocN_len;
@@ -154,6 +154,13 @@ size_t MEM_lockfree_get_mapped_memory_in_use(void);
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void);
 void MEM_lockfree_reset_peak_memory(void);
 size_t MEM_lockfree_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+void MEM_lockfree_use_thread_cache(void);
+void MEM_lockfree_profile_sample_interval_set(size_t interval);
+size_t MEM_lockfree_profile_sample_interval_get(void);
+void MEM_lockfree_profile_reset(void);
+MEM_ProfileStats *MEM_lockfree_profile_stats_get(const bool by_call_site, unsigned int *r_len);
+void MEM_lockfree_profile_stats_free(MEM_ProfileStats *stats);
+void MEM_lockfree_profile_print(const bool by_call_site);
 #ifndef NDEBUG
 const char *MEM_lockfree_name_ptr(void *vmemh);
 #endif
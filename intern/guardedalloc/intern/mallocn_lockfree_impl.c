@@ -21,10 +21,29 @@
  */
 
 #include <stdlib.h>
+#include <stddef.h> /* ptrdiff_t */
 #include <string.h> /* memcpy */
 #include <stdarg.h>
 #include <sys/types.h>
 
+/* Thread-local caching of small blocks, see MEM_use_thread_cached_allocator(). */
+#ifndef WIN32
+#  define USE_THREAD_CACHE
+#endif
+
+#ifdef USE_THREAD_CACHE
+#  include <pthread.h>
+#endif
+
+#ifdef _MSC_VER
+#  define MEM_THREAD_LOCAL __declspec(thread)
+#  define MEM_CALL_SITE() _ReturnAddress()
+#  include <intrin.h>
+#else
+#  define MEM_THREAD_LOCAL __thread
+#  define MEM_CALL_SITE() __builtin_return_address(0)
+#endif
+
 #include "MEM_guardedalloc.h"
 
 /* to ensure strict conversions */
@@ -54,13 +73,27 @@ static void (*thread_unlock_callback)(void) = NULL;
 enum {
   MEMHEAD_MMAP_FLAG = 1,
   MEMHEAD_ALIGN_FLAG = 2,
+  /* Blocks from the thread cache are never memory mapped nor aligned,
+   * so we can use the combination of both flags for them. */
+  MEMHEAD_CACHED_FLAGS = MEMHEAD_MMAP_FLAG | MEMHEAD_ALIGN_FLAG,
 };
 
 #define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
 #define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
 #define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
-#define MEMHEAD_IS_MMAP(memhead) ((memhead)->len & (size_t)MEMHEAD_MMAP_FLAG)
-#define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_FLAGS(memhead) ((memhead)->len & (size_t)MEMHEAD_CACHED_FLAGS)
+#define MEMHEAD_IS_MMAP(memhead) (MEMHEAD_FLAGS(memhead) == (size_t)MEMHEAD_MMAP_FLAG)
+#define MEMHEAD_IS_ALIGNED(memhead) (MEMHEAD_FLAGS(memhead) == (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_IS_CACHED(memhead) (MEMHEAD_FLAGS(memhead) == (size_t)MEMHEAD_CACHED_FLAGS)
+
+/* Sampled blocks of the profiler are stored as aligned blocks, with this bit set in
+ * #MemHeadAligned.alignment (alignment itself is always below 1024). */
+#define MEMHEAD_SAMPLED_ALIGNMENT_FLAG 0x4000
+#define MEMHEAD_ALIGNED_IS_SAMPLED(memh_aligned) \
+  (((memh_aligned)->alignment & MEMHEAD_SAMPLED_ALIGNMENT_FLAG) != 0)
+/* Alignment requested by the caller, zero for regular blocks that were sampled. */
+#define MEMHEAD_ALIGNMENT(memh_aligned) \
+  ((size_t)((memh_aligned)->alignment & ~MEMHEAD_SAMPLED_ALIGNMENT_FLAG))
 
 /* Uncomment this to have proper peak counter. */
 #define USE_ATOMIC_MAX
@@ -93,6 +126,550 @@ print_error(const char *str, ...)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Thread Cache
+ *
+ * Optional front-end which keeps freed small blocks in per-thread free lists,
+ * sorted by size class, and re-uses them for allocations from the same thread
+ * without going to the system allocator.
+ *
+ * Memory counters of cached blocks are accumulated per thread as well, and only
+ * merged into the global counters when they grow past a threshold or the thread
+ * exits. Functions reading the counters add up the pending per-thread values,
+ * so they stay accurate.
+ * \{ */
+
+#ifdef USE_THREAD_CACHE
+
+/* Blocks up to THREAD_CACHE_MAX_LEN are cached, in size classes of THREAD_CACHE_CLASS_LEN. */
+#  define THREAD_CACHE_CLASS_LEN 16
+#  define THREAD_CACHE_NUM_CLASSES 32
+#  define THREAD_CACHE_MAX_LEN (THREAD_CACHE_CLASS_LEN * THREAD_CACHE_NUM_CLASSES)
+/* Maximum number of free blocks per size class, half of them are released when exceeded. */
+#  define THREAD_CACHE_MAX_FREE_BLOCKS 256
+/* Per-thread counters are merged into the global ones once they exceed this many bytes. */
+#  define THREAD_CACHE_MERGE_LEN (1024 * 1024)
+
+#  define THREAD_CACHE_CLASS(len) ((len) == 0 ? 0 : ((len)-1) / THREAD_CACHE_CLASS_LEN)
+/* Free blocks are linked through their (unused) data. */
+#  define THREAD_CACHE_NEXT(memh) (*(MemHead **)PTR_FROM_MEMHEAD(memh))
+
+typedef struct ThreadCache {
+  struct ThreadCache *next, *prev;
+
+  MemHead *free_blocks[THREAD_CACHE_NUM_CLASSES];
+  unsigned int num_free_blocks[THREAD_CACHE_NUM_CLASSES];
+
+  /* Changes not merged into the global counters yet. These can be negative,
+   * since blocks can be freed from another thread than they were allocated in. */
+  ptrdiff_t mem_in_use;
+  int totblock;
+} ThreadCache;
+
+static bool use_thread_cache = false;
+static __thread ThreadCache *thread_cache = NULL;
+/* Only used to free the cache when its thread exits. */
+static pthread_key_t thread_cache_key;
+static pthread_once_t thread_cache_key_once = PTHREAD_ONCE_INIT;
+/* Protects the list of caches, and merging of their counters. */
+static pthread_mutex_t thread_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ThreadCache *thread_caches = NULL;
+
+/* Must be called with #thread_cache_mutex locked, so readers never count changes twice. */
+static void thread_cache_merge_counters(ThreadCache *cache)
+{
+  const size_t mem = atomic_add_and_fetch_z(&mem_in_use, (size_t)cache->mem_in_use);
+  atomic_add_and_fetch_u(&totblock, (unsigned int)cache->totblock);
+  update_maximum(&peak_mem, mem);
+  cache->mem_in_use = 0;
+  cache->totblock = 0;
+}
+
+static void thread_cache_release_blocks(ThreadCache *cache,
+                                        const size_t size_class,
+                                        const unsigned int num_keep)
+{
+  while (cache->num_free_blocks[size_class] > num_keep) {
+    MemHead *memh = cache->free_blocks[size_class];
+    cache->free_blocks[size_class] = THREAD_CACHE_NEXT(memh);
+    cache->num_free_blocks[size_class]--;
+    free(memh);
+  }
+}
+
+/* Called on thread exit. */
+static void thread_cache_free(void *cache_v)
+{
+  ThreadCache *cache = cache_v;
+
+  for (size_t size_class = 0; size_class < THREAD_CACHE_NUM_CLASSES; size_class++) {
+    thread_cache_release_blocks(cache, size_class, 0);
+  }
+
+  pthread_mutex_lock(&thread_cache_mutex);
+  if (cache->prev) {
+    cache->prev->next = cache->next;
+  }
+  else {
+    thread_caches = cache->next;
+  }
+  if (cache->next) {
+    cache->next->prev = cache->prev;
+  }
+  thread_cache_merge_counters(cache);
+  pthread_mutex_unlock(&thread_cache_mutex);
+
+  free(cache);
+  thread_cache = NULL;
+}
+
+static void thread_cache_key_create(void)
+{
+  pthread_key_create(&thread_cache_key, thread_cache_free);
+}
+
+static ThreadCache *thread_cache_ensure(void)
+{
+  ThreadCache *cache = thread_cache;
+  if (LIKELY(cache)) {
+    return cache;
+  }
+
+  pthread_once(&thread_cache_key_once, thread_cache_key_create);
+
+  cache = calloc(1, sizeof(ThreadCache));
+  if (UNLIKELY(cache == NULL)) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&thread_cache_mutex);
+  cache->next = thread_caches;
+  if (thread_caches) {
+    thread_caches->prev = cache;
+  }
+  thread_caches = cache;
+  pthread_mutex_unlock(&thread_cache_mutex);
+
+  pthread_setspecific(thread_cache_key, cache);
+  thread_cache = cache;
+  return cache;
+}
+
+/* Returns NULL on failure, the caller falls back to regular allocation then. */
+static void *thread_cache_alloc(size_t len, const bool clear)
+{
+  ThreadCache *cache = thread_cache_ensure();
+  if (UNLIKELY(cache == NULL)) {
+    return NULL;
+  }
+
+  const size_t size_class = THREAD_CACHE_CLASS(len);
+  MemHead *memh = cache->free_blocks[size_class];
+  if (memh != NULL) {
+    cache->free_blocks[size_class] = THREAD_CACHE_NEXT(memh);
+    cache->num_free_blocks[size_class]--;
+  }
+  else {
+    memh = (MemHead *)malloc(sizeof(MemHead) + (size_class + 1) * THREAD_CACHE_CLASS_LEN);
+    if (UNLIKELY(memh == NULL)) {
+      return NULL;
+    }
+  }
+
+  if (clear) {
+    memset(memh + 1, 0, len);
+  }
+  else if (UNLIKELY(malloc_debug_memset && len)) {
+    memset(memh + 1, 255, len);
+  }
+
+  memh->len = len | (size_t)MEMHEAD_CACHED_FLAGS;
+  cache->totblock++;
+  cache->mem_in_use += (ptrdiff_t)len;
+  if (cache->mem_in_use > THREAD_CACHE_MERGE_LEN) {
+    pthread_mutex_lock(&thread_cache_mutex);
+    thread_cache_merge_counters(cache);
+    pthread_mutex_unlock(&thread_cache_mutex);
+  }
+
+  return PTR_FROM_MEMHEAD(memh);
+}
+
+static void thread_cache_free_block(MemHead *memh, size_t len)
+{
+  ThreadCache *cache = thread_cache_ensure();
+  if (UNLIKELY(cache == NULL)) {
+    atomic_sub_and_fetch_u(&totblock, 1);
+    atomic_sub_and_fetch_z(&mem_in_use, len);
+    free(memh);
+    return;
+  }
+
+  /* The block goes to the cache of the thread freeing it. */
+  const size_t size_class = THREAD_CACHE_CLASS(len);
+  THREAD_CACHE_NEXT(memh) = cache->free_blocks[size_class];
+  cache->free_blocks[size_class] = memh;
+  cache->num_free_blocks[size_class]++;
+  if (cache->num_free_blocks[size_class] > THREAD_CACHE_MAX_FREE_BLOCKS) {
+    thread_cache_release_blocks(cache, size_class, THREAD_CACHE_MAX_FREE_BLOCKS / 2);
+  }
+
+  cache->totblock--;
+  cache->mem_in_use -= (ptrdiff_t)len;
+  if (cache->mem_in_use < -THREAD_CACHE_MERGE_LEN) {
+    pthread_mutex_lock(&thread_cache_mutex);
+    thread_cache_merge_counters(cache);
+    pthread_mutex_unlock(&thread_cache_mutex);
+  }
+}
+
+/* Global counters including changes which are not merged yet. */
+static void thread_cache_counters_get(size_t *r_mem_in_use, unsigned int *r_totblock)
+{
+  pthread_mutex_lock(&thread_cache_mutex);
+  size_t mem = mem_in_use;
+  unsigned int blocks = totblock;
+  for (ThreadCache *cache = thread_caches; cache; cache = cache->next) {
+    mem += (size_t)cache->mem_in_use;
+    blocks += (unsigned int)cache->totblock;
+  }
+  pthread_mutex_unlock(&thread_cache_mutex);
+
+  *r_mem_in_use = mem;
+  *r_totblock = blocks;
+}
+
+#endif /* USE_THREAD_CACHE */
+
+void MEM_lockfree_use_thread_cache(void)
+{
+#ifdef USE_THREAD_CACHE
+  use_thread_cache = true;
+#endif
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Allocation Profiling
+ *
+ * Sampling profiler which estimates memory usage per allocation name and call site.
+ *
+ * Every thread counts down the number of bytes it allocates, each time the counter drops
+ * below zero the allocation is sampled: it gets an extra header pointing to the statistics
+ * it was accounted to, so freeing it can update them again. Each sample stands for
+ * roughly #profile_sample_interval bytes, allocations larger than that are always sampled
+ * and stand for themselves only.
+ *
+ * Statistics are stored in a fixed size hash table which is never freed,
+ * so blocks sampled before profiling got disabled or reset can still be freed safely.
+ * \{ */
+
+/* Must be a power of two. */
+#define PROFILE_TABLE_SIZE 4096
+/* Minimum alignment of sampled blocks, so the regular alignment of malloc is kept. */
+#define PROFILE_MIN_ALIGNMENT 16
+
+typedef struct MemProfileSample {
+  MEM_ProfileStats *stats;
+  /* Estimated amount of memory and blocks this sample stands for. */
+  size_t weight_len;
+  size_t weight_blocks;
+} MemProfileSample;
+
+/* Padding from the start of a sampled block to its #MemHeadAligned. */
+#define PROFILE_SAMPLE_PADDING(alignment) \
+  (((sizeof(MemProfileSample) + sizeof(MemHeadAligned) + (alignment)-1) & ~((alignment)-1)) - \
+   sizeof(MemHeadAligned))
+
+static size_t profile_sample_interval = 0;
+static MEM_ProfileStats *profile_table = NULL;
+/* Last entry is used for samples which don't fit into the table anymore. */
+static MEM_ProfileStats profile_table_overflow = {"(other)", NULL, 0, 0, 0, 0, 0};
+static unsigned int profile_table_len = 0;
+/* Spin lock, sampled allocations are rare enough for this to not be contended. */
+static uint32_t profile_lock = 0;
+
+static MEM_THREAD_LOCAL ptrdiff_t profile_bytes_until_sample = 0;
+/* Interval the distance above was picked for. */
+static MEM_THREAD_LOCAL size_t profile_bytes_until_sample_interval = 0;
+static MEM_THREAD_LOCAL uint32_t profile_rng = 0;
+
+static void profile_lock_acquire(void)
+{
+  while (atomic_cas_uint32(&profile_lock, 0, 1) != 0) {
+    /* pass */
+  }
+}
+
+static void profile_lock_release(void)
+{
+  atomic_cas_uint32(&profile_lock, 1, 0);
+}
+
+/* Randomize the distance between samples, to avoid aliasing with repeating allocation
+ * patterns. Returns a value in [interval / 2, interval * 3 / 2). */
+static ptrdiff_t profile_next_sample_distance(size_t interval)
+{
+  uint32_t x = profile_rng;
+  if (x == 0) {
+    x = (uint32_t)(uintptr_t)&profile_rng | 1;
+  }
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  profile_rng = x;
+  return (ptrdiff_t)(interval / 2 + (size_t)x % (interval > 0 ? interval : 1));
+}
+
+/* Fast check done for every allocation while profiling is enabled. */
+MEM_INLINE bool profile_should_sample(size_t len)
+{
+  const size_t interval = profile_sample_interval;
+  if (LIKELY(interval == 0)) {
+    return false;
+  }
+  if (UNLIKELY(profile_bytes_until_sample_interval != interval)) {
+    /* Don't wait for a distance picked for another interval. */
+    profile_bytes_until_sample_interval = interval;
+    profile_bytes_until_sample = profile_next_sample_distance(interval);
+  }
+  profile_bytes_until_sample -= (ptrdiff_t)len;
+  if (LIKELY(profile_bytes_until_sample > 0)) {
+    return false;
+  }
+  profile_bytes_until_sample = profile_next_sample_distance(interval);
+  return true;
+}
+
+/* Must be called with the profile lock held. */
+static MEM_ProfileStats *profile_stats_ensure(const char *name, const void *call_site)
+{
+  if (profile_table == NULL) {
+    profile_table = calloc(PROFILE_TABLE_SIZE, sizeof(MEM_ProfileStats));
+    if (profile_table == NULL) {
+      return &profile_table_overflow;
+    }
+  }
+
+  const uintptr_t hash = ((uintptr_t)name * 31) ^ ((uintptr_t)call_site >> 4);
+  for (unsigned int i = 0; i < PROFILE_TABLE_SIZE; i++) {
+    MEM_ProfileStats *stats = &profile_table[(hash + i) & (PROFILE_TABLE_SIZE - 1)];
+    if (stats->name == name && stats->call_site == call_site) {
+      return stats;
+    }
+    if (stats->name == NULL) {
+      /* Keep a few free slots so lookups of missing entries stay short. */
+      if (profile_table_len >= PROFILE_TABLE_SIZE - PROFILE_TABLE_SIZE / 8) {
+        break;
+      }
+      stats->name = name;
+      stats->call_site = call_site;
+      profile_table_len++;
+      return stats;
+    }
+  }
+  return &profile_table_overflow;
+}
+
+/* Returns NULL on failure, the caller falls back to regular allocation then. */
+static void *profile_sample_alloc(
+    size_t len, size_t alignment, const bool clear, const char *str, const void *call_site)
+{
+  const size_t real_alignment = alignment > PROFILE_MIN_ALIGNMENT ? alignment :
+                                                                     PROFILE_MIN_ALIGNMENT;
+  const size_t padding = PROFILE_SAMPLE_PADDING(real_alignment);
+  MemProfileSample *sample = (MemProfileSample *)aligned_malloc(
+      padding + sizeof(MemHeadAligned) + len, real_alignment);
+  if (UNLIKELY(sample == NULL)) {
+    return NULL;
+  }
+
+  MemHeadAligned *memh = (MemHeadAligned *)((char *)sample + padding);
+  if (clear) {
+    memset(memh + 1, 0, len);
+  }
+  else if (UNLIKELY(malloc_debug_memset && len)) {
+    memset(memh + 1, 255, len);
+  }
+  memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG;
+  memh->alignment = (short)(alignment | MEMHEAD_SAMPLED_ALIGNMENT_FLAG);
+
+  const size_t interval = profile_sample_interval;
+  if (len >= interval) {
+    sample->weight_len = len;
+    sample->weight_blocks = 1;
+  }
+  else {
+    sample->weight_len = interval;
+    sample->weight_blocks = interval / (len > 0 ? len : 1);
+  }
+
+  profile_lock_acquire();
+  MEM_ProfileStats *stats = profile_stats_ensure(str, call_site);
+  stats->mem_in_use += sample->weight_len;
+  stats->blocks_in_use += sample->weight_blocks;
+  stats->total_mem += sample->weight_len;
+  stats->total_blocks += sample->weight_blocks;
+  if (stats->mem_in_use > stats->peak_mem) {
+    stats->peak_mem = stats->mem_in_use;
+  }
+  profile_lock_release();
+  sample->stats = stats;
+
+  atomic_add_and_fetch_u(&totblock, 1);
+  atomic_add_and_fetch_z(&mem_in_use, len);
+  update_maximum(&peak_mem, mem_in_use);
+
+  return PTR_FROM_MEMHEAD(memh);
+}
+
+static MemProfileSample *profile_sample_from_memhead(MemHeadAligned *memh)
+{
+  size_t alignment = MEMHEAD_ALIGNMENT(memh);
+  if (alignment < PROFILE_MIN_ALIGNMENT) {
+    alignment = PROFILE_MIN_ALIGNMENT;
+  }
+  return (MemProfileSample *)((char *)memh - PROFILE_SAMPLE_PADDING(alignment));
+}
+
+/* Memory counters are handled by the caller. */
+static void profile_sample_free(MemHeadAligned *memh)
+{
+  MemProfileSample *sample = profile_sample_from_memhead(memh);
+  MEM_ProfileStats *stats = sample->stats;
+
+  profile_lock_acquire();
+  stats->mem_in_use -= sample->weight_len;
+  stats->blocks_in_use -= sample->weight_blocks;
+  profile_lock_release();
+
+  aligned_free(sample);
+}
+
+void MEM_lockfree_profile_sample_interval_set(size_t interval)
+{
+  profile_sample_interval = interval;
+}
+
+size_t MEM_lockfree_profile_sample_interval_get(void)
+{
+  return profile_sample_interval;
+}
+
+void MEM_lockfree_profile_reset(void)
+{
+  profile_lock_acquire();
+  for (unsigned int i = 0; profile_table && i < PROFILE_TABLE_SIZE; i++) {
+    MEM_ProfileStats *stats = &profile_table[i];
+    stats->peak_mem = stats->mem_in_use;
+    stats->total_mem = 0;
+    stats->total_blocks = 0;
+  }
+  profile_table_overflow.peak_mem = profile_table_overflow.mem_in_use;
+  profile_table_overflow.total_mem = 0;
+  profile_table_overflow.total_blocks = 0;
+  profile_lock_release();
+}
+
+static int profile_stats_cmp_name(const void *a_v, const void *b_v)
+{
+  const MEM_ProfileStats *a = a_v, *b = b_v;
+  return strcmp(a->name, b->name);
+}
+
+static int profile_stats_cmp_mem_in_use(const void *a_v, const void *b_v)
+{
+  const MEM_ProfileStats *a = a_v, *b = b_v;
+  if (a->mem_in_use != b->mem_in_use) {
+    return a->mem_in_use > b->mem_in_use ? -1 : 1;
+  }
+  return a->peak_mem > b->peak_mem ? -1 : (a->peak_mem < b->peak_mem ? 1 : 0);
+}
+
+MEM_ProfileStats *MEM_lockfree_profile_stats_get(const bool by_call_site, unsigned int *r_len)
+{
+  /* Copy with the lock held, no allocation from here may get sampled. */
+  MEM_ProfileStats *result = malloc(sizeof(MEM_ProfileStats) * (PROFILE_TABLE_SIZE + 1));
+  unsigned int len = 0;
+
+  if (result == NULL) {
+    *r_len = 0;
+    return NULL;
+  }
+
+  profile_lock_acquire();
+  for (unsigned int i = 0; profile_table && i < PROFILE_TABLE_SIZE; i++) {
+    if (profile_table[i].name != NULL) {
+      result[len++] = profile_table[i];
+    }
+  }
+  if (profile_table_overflow.total_blocks || profile_table_overflow.blocks_in_use) {
+    result[len++] = profile_table_overflow;
+  }
+  profile_lock_release();
+
+  if (!by_call_site && len > 1) {
+    /* Merge entries with the same name. Peak values are summed, which is an upper bound
+     * since the peaks of different call sites may not have happened at the same time. */
+    qsort(result, len, sizeof(MEM_ProfileStats), profile_stats_cmp_name);
+    unsigned int merged_len = 1;
+    result[0].call_site = NULL;
+    for (unsigned int i = 1; i < len; i++) {
+      MEM_ProfileStats *dst = &result[merged_len - 1];
+      if (strcmp(dst->name, result[i].name) == 0) {
+        dst->mem_in_use += result[i].mem_in_use;
+        dst->peak_mem += result[i].peak_mem;
+        dst->blocks_in_use += result[i].blocks_in_use;
+        dst->total_mem += result[i].total_mem;
+        dst->total_blocks += result[i].total_blocks;
+      }
+      else {
+        result[merged_len] = result[i];
+        result[merged_len].call_site = NULL;
+        merged_len++;
+      }
+    }
+    len = merged_len;
+  }
+
+  qsort(result, len, sizeof(MEM_ProfileStats), profile_stats_cmp_mem_in_use);
+
+  *r_len = len;
+  return result;
+}
+
+void MEM_lockfree_profile_stats_free(MEM_ProfileStats *stats)
+{
+  free(stats);
+}
+
+void MEM_lockfree_profile_print(const bool by_call_site)
+{
+  unsigned int len;
+  MEM_ProfileStats *stats = MEM_lockfree_profile_stats_get(by_call_site, &len);
+
+  printf("\nmemory profile (sample interval: " SIZET_FORMAT " bytes, estimated values)\n",
+         SIZET_ARG(profile_sample_interval));
+  printf("%12s %12s %10s %12s  name\n", "in use (MB)", "peak (MB)", "blocks", "total (MB)");
+  for (unsigned int i = 0; i < len; i++) {
+    printf("%12.3f %12.3f %10u %12.3f  %s",
+           (double)stats[i].mem_in_use / (double)(1024 * 1024),
+           (double)stats[i].peak_mem / (double)(1024 * 1024),
+           (unsigned int)stats[i].blocks_in_use,
+           (double)stats[i].total_mem / (double)(1024 * 1024),
+           stats[i].name);
+    if (stats[i].call_site) {
+      printf(" (%p)", stats[i].call_site);
+    }
+    printf("\n");
+  }
+
+  MEM_lockfree_profile_stats_free(stats);
+}
+
+/** \} */
+
 #if defined(WIN32)
 static void mem_lock_thread(void)
 {
@@ -130,6 +707,16 @@ void MEM_lockfree_freeN(void *vmemh)
     return;
   }
 
+#ifdef USE_THREAD_CACHE
+  if (MEMHEAD_IS_CACHED(memh)) {
+    if (UNLIKELY(malloc_debug_memset && len)) {
+      memset(memh + 1, 255, len);
+    }
+    thread_cache_free_block(memh, len);
+    return;
+  }
+#endif
+
   atomic_sub_and_fetch_u(&totblock, 1);
   atomic_sub_and_fetch_z(&mem_in_use, len);
 
@@ -151,7 +738,12 @@ void MEM_lockfree_freeN(void *vmemh)
     }
     if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
       MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
-      aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
+      if (UNLIKELY(MEMHEAD_ALIGNED_IS_SAMPLED(memh_aligned))) {
+        profile_sample_free(memh_aligned);
+      }
+      else {
+        aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
+      }
     }
     else {
       free(memh);
@@ -159,6 +751,17 @@ void MEM_lockfree_freeN(void *vmemh)
   }
 }
 
+/* The allocation functions below take the call site of the public entry point, so
+ * allocations done through wrappers like #MEM_lockfree_malloc_arrayN are profiled for the code
+ * calling the wrapper. */
+static void *mem_lockfree_callocN_ex(size_t len, const char *str, const void *call_site);
+static void *mem_lockfree_mallocN_ex(size_t len, const char *str, const void *call_site);
+static void *mem_lockfree_mallocN_aligned_ex(size_t len,
+                                             size_t alignment,
+                                             const char *str,
+                                             const void *call_site);
+static void *mem_lockfree_mapallocN_ex(size_t len, const char *str, const void *call_site);
+
 void *MEM_lockfree_dupallocN(const void *vmemh)
 {
   void *newp = NULL;
@@ -166,15 +769,16 @@ void *MEM_lockfree_dupallocN(const void *vmemh)
     MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
     const size_t prev_size = MEM_lockfree_allocN_len(vmemh);
     if (UNLIKELY(MEMHEAD_IS_MMAP(memh))) {
-      newp = MEM_lockfree_mapallocN(prev_size, "dupli_mapalloc");
+      newp = mem_lockfree_mapallocN_ex(prev_size, "dupli_mapalloc", MEM_CALL_SITE());
     }
-    else if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+    else if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh) &&
+                      MEMHEAD_ALIGNMENT(MEMHEAD_ALIGNED_FROM_PTR(vmemh)) != 0)) {
       MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
-      newp = MEM_lockfree_mallocN_aligned(
-          prev_size, (size_t)memh_aligned->alignment, "dupli_malloc");
+      newp = mem_lockfree_mallocN_aligned_ex(
+          prev_size, MEMHEAD_ALIGNMENT(memh_aligned), "dupli_malloc", MEM_CALL_SITE());
     }
     else {
-      newp = MEM_lockfree_mallocN(prev_size, "dupli_malloc");
+      newp = mem_lockfree_mallocN_ex(prev_size, "dupli_malloc", MEM_CALL_SITE());
     }
     memcpy(newp, vmemh, prev_size);
   }
@@ -189,12 +793,14 @@ void *MEM_lockfree_reallocN_id(void *vmemh, size_t len, const char *str)
     MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
     size_t old_len = MEM_lockfree_allocN_len(vmemh);
 
-    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
-      newp = MEM_lockfree_mallocN(len, "realloc");
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh) ||
+               MEMHEAD_ALIGNMENT(MEMHEAD_ALIGNED_FROM_PTR(vmemh)) == 0)) {
+      newp = mem_lockfree_mallocN_ex(len, str, MEM_CALL_SITE());
     }
     else {
       MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
-      newp = MEM_lockfree_mallocN_aligned(len, (size_t)memh_aligned->alignment, "realloc");
+      newp = mem_lockfree_mallocN_aligned_ex(
+          len, MEMHEAD_ALIGNMENT(memh_aligned), str, MEM_CALL_SITE());
     }
 
     if (newp) {
@@ -211,7 +817,7 @@ void *MEM_lockfree_reallocN_id(void *vmemh, size_t len, const char *str)
     MEM_lockfree_freeN(vmemh);
   }
   else {
-    newp = MEM_lockfree_mallocN(len, str);
+    newp = mem_lockfree_mallocN_ex(len, str, MEM_CALL_SITE());
   }
 
   return newp;
@@ -225,12 +831,14 @@ void *MEM_lockfree_recallocN_id(void *vmemh, size_t len, const char *str)
     MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
     size_t old_len = MEM_lockfree_allocN_len(vmemh);
 
-    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
-      newp = MEM_lockfree_mallocN(len, "recalloc");
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh) ||
+               MEMHEAD_ALIGNMENT(MEMHEAD_ALIGNED_FROM_PTR(vmemh)) == 0)) {
+      newp = mem_lockfree_mallocN_ex(len, str, MEM_CALL_SITE());
     }
     else {
       MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
-      newp = MEM_lockfree_mallocN_aligned(len, (size_t)memh_aligned->alignment, "recalloc");
+      newp = mem_lockfree_mallocN_aligned_ex(
+          len, MEMHEAD_ALIGNMENT(memh_aligned), str, MEM_CALL_SITE());
     }
 
     if (newp) {
@@ -252,18 +860,34 @@ void *MEM_lockfree_recallocN_id(void *vmemh, size_t len, const char *str)
     MEM_lockfree_freeN(vmemh);
   }
   else {
-    newp = MEM_lockfree_callocN(len, str);
+    newp = mem_lockfree_callocN_ex(len, str, MEM_CALL_SITE());
   }
 
   return newp;
 }
 
-void *MEM_lockfree_callocN(size_t len, const char *str)
+static void *mem_lockfree_callocN_ex(size_t len, const char *str, const void *call_site)
 {
   MemHead *memh;
 
   len = SIZET_ALIGN_4(len);
 
+  if (UNLIKELY(profile_should_sample(len))) {
+    void *ptr = profile_sample_alloc(len, 0, true, str, call_site);
+    if (LIKELY(ptr)) {
+      return ptr;
+    }
+  }
+
+#ifdef USE_THREAD_CACHE
+  if (use_thread_cache && len <= THREAD_CACHE_MAX_LEN) {
+    void *ptr = thread_cache_alloc(len, true);
+    if (LIKELY(ptr)) {
+      return ptr;
+    }
+  }
+#endif
+
   memh = (MemHead *)calloc(1, len + sizeof(MemHead));
 
   if (LIKELY(memh)) {
@@ -281,6 +905,11 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
   return NULL;
 }
 
+void *MEM_lockfree_callocN(size_t len, const char *str)
+{
+  return mem_lockfree_callocN_ex(len, str, MEM_CALL_SITE());
+}
+
 void *MEM_lockfree_calloc_arrayN(size_t len, size_t size, const char *str)
 {
   size_t total_size;
@@ -296,15 +925,31 @@ void *MEM_lockfree_calloc_arrayN(size_t len, size_t size, const char *str)
     return NULL;
   }
 
-  return MEM_lockfree_callocN(total_size, str);
+  return mem_lockfree_callocN_ex(total_size, str, MEM_CALL_SITE());
 }
 
-void *MEM_lockfree_mallocN(size_t len, const char *str)
+static void *mem_lockfree_mallocN_ex(size_t len, const char *str, const void *call_site)
 {
   MemHead *memh;
 
   len = SIZET_ALIGN_4(len);
 
+  if (UNLIKELY(profile_should_sample(len))) {
+    void *ptr = profile_sample_alloc(len, 0, false, str, call_site);
+    if (LIKELY(ptr)) {
+      return ptr;
+    }
+  }
+
+#ifdef USE_THREAD_CACHE
+  if (use_thread_cache && len <= THREAD_CACHE_MAX_LEN) {
+    void *ptr = thread_cache_alloc(len, false);
+    if (LIKELY(ptr)) {
+      return ptr;
+    }
+  }
+#endif
+
   memh = (MemHead *)malloc(len + sizeof(MemHead));
 
   if (LIKELY(memh)) {
@@ -326,6 +971,11 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
   return NULL;
 }
 
+void *MEM_lockfree_mallocN(size_t len, const char *str)
+{
+  return mem_lockfree_mallocN_ex(len, str, MEM_CALL_SITE());
+}
+
 void *MEM_lockfree_malloc_arrayN(size_t len, size_t size, const char *str)
 {
   size_t total_size;
@@ -341,10 +991,13 @@ void *MEM_lockfree_malloc_arrayN(size_t len, size_t size, const char *str)
     return NULL;
   }
 
-  return MEM_lockfree_mallocN(total_size, str);
+  return mem_lockfree_mallocN_ex(total_size, str, MEM_CALL_SITE());
 }
 
-void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str)
+static void *mem_lockfree_mallocN_aligned_ex(size_t len,
+                                             size_t alignment,
+                                             const char *str,
+                                             const void *call_site)
 {
   MemHeadAligned *memh;
 
@@ -366,6 +1019,13 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 
   len = SIZET_ALIGN_4(len);
 
+  if (UNLIKELY(profile_should_sample(len))) {
+    void *ptr = profile_sample_alloc(len, alignment, false, str, call_site);
+    if (LIKELY(ptr)) {
+      return ptr;
+    }
+  }
+
   memh = (MemHeadAligned *)aligned_malloc(len + extra_padding + sizeof(MemHeadAligned), alignment);
 
   if (LIKELY(memh)) {
@@ -394,7 +1054,12 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
   return NULL;
 }
 
-void *MEM_lockfree_mapallocN(size_t len, const char *str)
+void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str)
+{
+  return mem_lockfree_mallocN_aligned_ex(len, alignment, str, MEM_CALL_SITE());
+}
+
+static void *mem_lockfree_mapallocN_ex(size_t len, const char *str, const void *call_site)
 {
   MemHead *memh;
 
@@ -402,7 +1067,7 @@ void *MEM_lockfree_mapallocN(size_t len, const char *str)
    * allocating > 4 GB on Windows. the only reason mapalloc exists
    * is to get around address space limitations in 32 bit OSes. */
   if (sizeof(void *) >= 8)
-    return MEM_lockfree_callocN(len, str);
+    return mem_lockfree_callocN_ex(len, str, call_site);
 
   len = SIZET_ALIGN_4(len);
 
@@ -432,7 +1097,12 @@ void *MEM_lockfree_mapallocN(size_t len, const char *str)
       SIZET_ARG(len),
       str,
       (unsigned int)mmap_in_use);
-  return MEM_lockfree_callocN(len, str);
+  return mem_lockfree_callocN_ex(len, str, call_site);
+}
+
+void *MEM_lockfree_mapallocN(size_t len, const char *str)
+{
+  return mem_lockfree_mapallocN_ex(len, str, MEM_CALL_SITE());
 }
 
 void MEM_lockfree_printmemlist_pydict(void)
@@ -451,8 +1121,10 @@ void MEM_lockfree_callbackmemlist(void (*func)(void *))
 
 void MEM_lockfree_printmemlist_stats(void)
 {
-  printf("\ntotal memory len: %.3f MB\n", (double)mem_in_use / (double)(1024 * 1024));
-  printf("peak memory len: %.3f MB\n", (double)peak_mem / (double)(1024 * 1024));
+  printf("\ntotal memory len: %.3f MB\n",
+         (double)MEM_lockfree_get_memory_in_use() / (double)(1024 * 1024));
+  printf("peak memory len: %.3f MB\n",
+         (double)MEM_lockfree_get_peak_memory() / (double)(1024 * 1024));
   printf(
       "\nFor more detailed per-block statistics run Blender with memory debugging command line "
       "argument.\n");
@@ -486,6 +1158,14 @@ void MEM_lockfree_set_memory_debug(void)
 
 size_t MEM_lockfree_get_memory_in_use(void)
 {
+#ifdef USE_THREAD_CACHE
+  if (use_thread_cache) {
+    size_t mem;
+    unsigned int blocks;
+    thread_cache_counters_get(&mem, &blocks);
+    return mem;
+  }
+#endif
   return mem_in_use;
 }
 
@@ -496,17 +1176,31 @@ size_t MEM_lockfree_get_mapped_memory_in_use(void)
 
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void)
 {
+#ifdef USE_THREAD_CACHE
+  if (use_thread_cache) {
+    size_t mem;
+    unsigned int blocks;
+    thread_cache_counters_get(&mem, &blocks);
+    return blocks;
+  }
+#endif
   return totblock;
 }
 
 /* dummy */
 void MEM_lockfree_reset_peak_memory(void)
 {
-  peak_mem = mem_in_use;
+  peak_mem = MEM_lockfree_get_memory_in_use();
 }
 
 size_t MEM_lockfree_get_peak_memory(void)
 {
+#ifdef USE_THREAD_CACHE
+  if (use_thread_cache) {
+    /* Peak is only updated when counters are merged, account for pending changes. */
+    update_maximum(&peak_mem, MEM_lockfree_get_memory_in_use());
+  }
+#endif
   return peak_mem;
 }
 
@@ -179,8 +179,11 @@ class DATA_PT_modifiers(ModifierButtonsPanel, Panel):
         col.prop(md, "operation", text="")
 
         col = split.column()
-        col.label(text="Object:")
-        col.prop(md, "object", text="")
+        col.prop(md, "operand_type", text="")
+        if md.operand_type == 'OBJECT':
+            col.prop(md, "object", text="")
+        else:
+            col.prop(md, "collection", text="")
 
         layout.prop(md, "double_threshold")
 
@@ -1196,12 +1199,23 @@ class DATA_PT_modifiers(ModifierButtonsPanel, Panel):
         col.prop(md, "narrowness", slider=True)
 
     def REMESH(self, layout, _ob, md):
+        layout.prop(md, "mode")
+
+        if md.mode == 'VOXEL':
+            if not bpy.app.build_options.openvdb:
+                layout.label(text="Built without OpenVDB")
+                return
+
+            row = layout.row()
+            row.prop(md, "voxel_size")
+            row.prop(md, "adaptivity")
+            layout.prop(md, "use_smooth_shade")
+            return
+
         if not bpy.app.build_options.mod_remesh:
             layout.label(text="Built without Remesh modifier")
             return
 
-        layout.prop(md, "mode")
-
         row = layout.row()
         row.prop(md, "octree_depth")
         row.prop(md, "scale")
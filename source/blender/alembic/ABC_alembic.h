@@ -67,6 +67,7 @@ struct AlembicExportParams {
   bool triangulate;
   bool export_hair;
   bool export_particles;
+  bool parallel_frames;
 
   unsigned int compression_type : 1;
 
@@ -20,6 +20,7 @@
 
 #include "abc_exporter.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "abc_archive.h"
@@ -44,6 +45,7 @@ extern "C" {
 #include "DNA_space_types.h" /* for FILE_MAX */
 
 #include "BLI_string.h"
+#include "BLI_threads.h"
 
 #ifdef WIN32
 /* needed for MSCV because of snprintf from BLI_string */
@@ -57,8 +59,11 @@ extern "C" {
 #include "BKE_mball.h"
 #include "BKE_modifier.h"
 #include "BKE_particle.h"
+#include "BKE_pointcache.h"
 #include "BKE_scene.h"
 
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_query.h"
 }
 
@@ -90,6 +95,7 @@ ExportSettings::ExportSettings()
       export_vweigths(false),
       export_hair(true),
       export_particles(true),
+      parallel_frames(false),
       apply_subdiv(false),
       use_subdiv_schema(false),
       export_child_hairs(true),
@@ -325,6 +331,17 @@ void AbcExporter::operator()(short *do_update, float *progress, bool *was_cancel
 
   /* Export all frames. */
 
+  if (frames.size() > 1 && canEvaluateFramesInParallel()) {
+    writeFramesParallel(frames,
+                        xform_frames,
+                        shape_frames,
+                        archive_bounds_prop,
+                        do_update,
+                        progress,
+                        was_canceled);
+    return;
+  }
+
   std::set<double>::const_iterator begin = frames.begin();
   std::set<double>::const_iterator end = frames.end();
 
@@ -345,30 +362,157 @@ void AbcExporter::operator()(short *do_update, float *progress, bool *was_cancel
     /* 'frame' is offset by start frame, so need to cancel the offset. */
     setCurrentFrame(m_bmain, frame);
 
-    if (shape_frames.count(frame) != 0) {
-      for (int i = 0, e = m_shapes.size(); i != e; i++) {
-        m_shapes[i]->write();
-      }
+    writeFrame(frame, xform_frames, shape_frames, archive_bounds_prop);
+  }
+}
+
+void AbcExporter::writeFrame(double frame,
+                             const std::set<double> &xform_frames,
+                             const std::set<double> &shape_frames,
+                             OBox3dProperty &archive_bounds_prop)
+{
+  if (shape_frames.count(frame) != 0) {
+    for (int i = 0, e = m_shapes.size(); i != e; i++) {
+      m_shapes[i]->write();
     }
+  }
 
-    if (xform_frames.count(frame) == 0) {
-      continue;
+  if (xform_frames.count(frame) == 0) {
+    return;
+  }
+
+  m_xforms_type::iterator xit, xe;
+  for (xit = m_xforms.begin(), xe = m_xforms.end(); xit != xe; ++xit) {
+    xit->second->write();
+  }
+
+  /* Save the archive 's bounding box. */
+  Imath::Box3d bounds;
+
+  for (xit = m_xforms.begin(), xe = m_xforms.end(); xit != xe; ++xit) {
+    Imath::Box3d box = xit->second->bounds();
+    bounds.extendBy(box);
+  }
+
+  archive_bounds_prop.set(bounds);
+}
+
+/* Frames can only be evaluated independently from each other when there is no simulation, which
+ * depends on the result of the previous frame. */
+bool AbcExporter::canEvaluateFramesInParallel() const
+{
+  if (!m_settings.parallel_frames) {
+    return false;
+  }
+
+  Scene *scene = m_settings.scene;
+
+  if (scene->rigidbody_world != NULL) {
+    return false;
+  }
+
+  for (Base *base = static_cast<Base *>(m_settings.view_layer->object_bases.first); base;
+       base = base->next) {
+    /* Particle systems are included as well, so hair and points writers never have to switch
+     * to the particle system of another dependency graph. */
+    if (BKE_ptcache_object_has(scene, base->object, 1)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void AbcExporter::updateEvaluatedObjects()
+{
+  for (int i = 0, e = m_shapes.size(); i != e; i++) {
+    m_shapes[i]->updateEvaluatedObject();
+  }
+
+  m_xforms_type::iterator xit, xe;
+  for (xit = m_xforms.begin(), xe = m_xforms.end(); xit != xe; ++xit) {
+    xit->second->updateEvaluatedObject();
+  }
+}
+
+/* Time at which BKE_scene_graph_update_for_newframe() evaluates the scene after
+ * AbcExporter::setCurrentFrame(), including the time remapping of the scene. */
+static float abc_frame_to_ctime(const Scene *scene, double t)
+{
+  const int cfra = static_cast<int>(t);
+  const float subframe = static_cast<float>(t) - cfra;
+  float ctime = cfra;
+  ctime += subframe;
+  ctime *= scene->r.framelen;
+  return ctime;
+}
+
+/* Evaluate batches of frames at once, using a dependency graph per frame, and write them in
+ * order. The scene frame is left at the last exported frame, like the serial export does. */
+void AbcExporter::writeFramesParallel(const std::set<double> &frames,
+                                      const std::set<double> &xform_frames,
+                                      const std::set<double> &shape_frames,
+                                      OBox3dProperty &archive_bounds_prop,
+                                      short *do_update,
+                                      float *progress,
+                                      bool *was_canceled)
+{
+  Depsgraph *depsgraph = m_settings.depsgraph;
+  /* Every dependency graph holds its own copy of the evaluated scene, limit memory usage. */
+  const int max_graphs = 8;
+  const int num_graphs = std::min(std::min(BLI_system_thread_count(), max_graphs),
+                                  static_cast<int>(frames.size()));
+
+  std::vector<Depsgraph *> graphs(num_graphs);
+  for (int j = 0; j < num_graphs; j++) {
+    graphs[j] = DEG_graph_new(m_bmain, m_settings.scene, m_settings.view_layer, DAG_EVAL_RENDER);
+    DEG_graph_build_from_view_layer(graphs[j], m_bmain, m_settings.scene, m_settings.view_layer);
+  }
+
+  std::vector<double> batch_frames;
+  std::vector<float> batch_ctimes;
+  std::set<double>::const_iterator begin = frames.begin();
+  std::set<double>::const_iterator end = frames.end();
+
+  const float size = static_cast<float>(frames.size());
+  size_t i = 0;
+
+  while (begin != end) {
+    if (G.is_break) {
+      *was_canceled = true;
+      break;
     }
 
-    m_xforms_type::iterator xit, xe;
-    for (xit = m_xforms.begin(), xe = m_xforms.end(); xit != xe; ++xit) {
-      xit->second->write();
+    batch_frames.clear();
+    batch_ctimes.clear();
+    for (; begin != end && batch_frames.size() < static_cast<size_t>(num_graphs); ++begin) {
+      batch_frames.push_back(*begin);
+      batch_ctimes.push_back(abc_frame_to_ctime(m_settings.scene, *begin));
     }
 
-    /* Save the archive 's bounding box. */
-    Imath::Box3d bounds;
+    DEG_evaluate_on_framechange_multiple(
+        m_bmain, &graphs[0], &batch_ctimes[0], static_cast<int>(batch_frames.size()));
+
+    for (size_t j = 0; j < batch_frames.size(); j++) {
+      *progress = (++i / size);
+      *do_update = 1;
 
-    for (xit = m_xforms.begin(), xe = m_xforms.end(); xit != xe; ++xit) {
-      Imath::Box3d box = xit->second->bounds();
-      bounds.extendBy(box);
+      m_settings.depsgraph = graphs[j];
+      updateEvaluatedObjects();
+
+      writeFrame(batch_frames[j], xform_frames, shape_frames, archive_bounds_prop);
     }
+  }
+
+  m_settings.depsgraph = depsgraph;
+  /* Leave the scene at the last written frame, like the serial export does. */
+  if (!batch_frames.empty()) {
+    setCurrentFrame(m_bmain, batch_frames.back());
+  }
+  updateEvaluatedObjects();
 
-    archive_bounds_prop.set(bounds);
+  for (int j = 0; j < num_graphs; j++) {
+    DEG_graph_free(graphs[j]);
   }
 }
 
@@ -68,6 +68,7 @@ struct ExportSettings {
   bool export_vweigths;
   bool export_hair;
   bool export_particles;
+  bool parallel_frames;
 
   bool apply_subdiv;
   bool curves_as_mesh;
@@ -126,6 +127,21 @@ class AbcExporter {
   AbcTransformWriter *getXForm(const std::string &name);
 
   void setCurrentFrame(Main *bmain, double t);
+
+  void writeFrame(double frame,
+                  const std::set<double> &xform_frames,
+                  const std::set<double> &shape_frames,
+                  Alembic::Abc::OBox3dProperty &archive_bounds_prop);
+
+  bool canEvaluateFramesInParallel() const;
+  void updateEvaluatedObjects();
+  void writeFramesParallel(const std::set<double> &frames,
+                           const std::set<double> &xform_frames,
+                           const std::set<double> &shape_frames,
+                           Alembic::Abc::OBox3dProperty &archive_bounds_prop,
+                           short *do_update,
+                           float *progress,
+                           bool *was_canceled);
 };
 
 #endif /* __ABC_EXPORTER_H__ */
@@ -335,6 +335,15 @@ AbcGenericMeshWriter::~AbcGenericMeshWriter()
   }
 }
 
+void AbcGenericMeshWriter::updateEvaluatedObject()
+{
+  AbcObjectWriter::updateEvaluatedObject();
+
+  if (m_is_subd) {
+    m_subsurf_mod = get_subsurf_modifier(m_settings.scene, m_object);
+  }
+}
+
 bool AbcGenericMeshWriter::isAnimated() const
 {
   if (m_object->data != NULL) {
@@ -57,6 +57,8 @@ class AbcGenericMeshWriter : public AbcObjectWriter {
   ~AbcGenericMeshWriter();
   void setIsAnimated(bool is_animated);
 
+  virtual void updateEvaluatedObject();
+
  protected:
   virtual void do_write();
   virtual bool isAnimated() const;
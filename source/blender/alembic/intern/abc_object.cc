@@ -38,6 +38,8 @@ extern "C" {
 #include "BLI_listbase.h"
 #include "BLI_math.h"
 #include "BLI_string.h"
+
+#include "DEG_depsgraph_query.h"
 }
 
 using Alembic::AbcGeom::IObject;
@@ -102,6 +104,11 @@ Imath::Box3d AbcObjectWriter::bounds()
   return this->m_bounds;
 }
 
+void AbcObjectWriter::updateEvaluatedObject()
+{
+  m_object = DEG_get_evaluated_object(m_settings.depsgraph, DEG_get_original_object(m_object));
+}
+
 void AbcObjectWriter::write()
 {
   do_write();
@@ -64,6 +64,10 @@ class AbcObjectWriter {
 
   virtual Imath::Box3d bounds();
 
+  /* Switch to the evaluated object from the dependency graph of the export settings, which
+   * differs between frames when they are evaluated in parallel. */
+  virtual void updateEvaluatedObject();
+
   void write();
 
  private:
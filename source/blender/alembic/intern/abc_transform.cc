@@ -130,6 +130,16 @@ Imath::Box3d AbcTransformWriter::bounds()
   return Imath::transform(bounds, m_matrix);
 }
 
+void AbcTransformWriter::updateEvaluatedObject()
+{
+  AbcObjectWriter::updateEvaluatedObject();
+
+  if (m_proxy_from) {
+    m_proxy_from = DEG_get_evaluated_object(m_settings.depsgraph,
+                                            DEG_get_original_object(m_proxy_from));
+  }
+}
+
 bool AbcTransformWriter::hasAnimation(Object * /*ob*/) const
 {
   /* TODO(kevin): implement this. */
@@ -52,6 +52,7 @@ class AbcTransformWriter : public AbcObjectWriter {
     return m_xform;
   }
   virtual Imath::Box3d bounds();
+  virtual void updateEvaluatedObject();
 
  private:
   virtual void do_write();
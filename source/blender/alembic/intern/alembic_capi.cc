@@ -358,6 +358,7 @@ bool ABC_export(Scene *scene,
   job->settings.export_vcols = params->vcolors;
   job->settings.export_hair = params->export_hair;
   job->settings.export_particles = params->export_particles;
+  job->settings.parallel_frames = params->parallel_frames;
   job->settings.apply_subdiv = params->apply_subdiv;
   job->settings.curves_as_mesh = params->curves_as_mesh;
   job->settings.flatten_hierarchy = params->flatten_hierarchy;
@@ -151,6 +151,7 @@ enum {
   G_DEBUG_IO = (1 << 17),                    /* IO Debugging (for Collada, ...)*/
   G_DEBUG_GPU_SHADERS = (1 << 18),           /* GLSL shaders */
   G_DEBUG_GPU_FORCE_WORKAROUNDS = (1 << 19), /* force gpu workarounds bypassing detections. */
+  G_DEBUG_DEPSGRAPH_VALIDATE = (1 << 20),    /* compare incremental depsgraph updates to full */
 };
 
 #define G_DEBUG_ALL \
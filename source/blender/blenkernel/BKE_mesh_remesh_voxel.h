@@ -44,6 +44,17 @@ struct Mesh *BKE_mesh_remesh_voxel_fix_poles(struct Mesh *mesh);
 struct Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain(struct Mesh *mesh,
                                                   float voxel_size,
                                                   float adaptivity);
+
+/* Level set cache, to remesh an unchanged input without voxelizing it again. */
+typedef struct MeshRemeshVoxelCache MeshRemeshVoxelCache;
+
+MeshRemeshVoxelCache *BKE_mesh_remesh_voxel_cache_new(void);
+void BKE_mesh_remesh_voxel_cache_free(MeshRemeshVoxelCache *cache);
+struct Mesh *BKE_mesh_remesh_voxel_to_mesh_cached_nomain(struct Mesh *mesh,
+                                                         float voxel_size,
+                                                         float adaptivity,
+                                                         MeshRemeshVoxelCache *cache);
+
 struct Mesh *BKE_mesh_remesh_quadriflow_to_mesh_nomain(struct Mesh *mesh,
                                                        int target_faces,
                                                        int seed,
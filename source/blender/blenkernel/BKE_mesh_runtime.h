@@ -31,18 +31,48 @@ struct CustomData;
 struct CustomData_MeshMasks;
 struct Depsgraph;
 struct KeyBlock;
+struct MEdge;
 struct MLoop;
 struct MLoopTri;
+struct MPoly;
 struct MVertTri;
 struct Mesh;
 struct Object;
 struct Scene;
 
+/**
+ * Compressed (CSR) vertex adjacency of a mesh, stored in #Mesh_Runtime.vert_adjacency.
+ * Copies of a mesh which reference its topology share an adjacency already calculated for it,
+ * it is only calculated again when the topology changes.
+ */
+typedef struct MeshVertAdjacency {
+  /** Number of meshes using the adjacency, changed atomically. */
+  int users;
+  /** #Mesh_Runtime.topology_generation the adjacency is calculated for. */
+  int topology_generation;
+
+  /** Vertices connected to each vertex by an edge, in the order of the edges.
+   * Neighbors of vertex `v` are in the range `[vert_verts_offset[v], vert_verts_offset[v + 1])`
+   * of `vert_verts`. */
+  int *vert_verts_offset;
+  int *vert_verts;
+  /** Loops using each vertex, in the order of the polygons, indexed the same way. */
+  int *vert_loops_offset;
+  int *vert_loops;
+  /** Polygon of each loop. */
+  int *loop_poly;
+} MeshVertAdjacency;
+
 void BKE_mesh_runtime_reset(struct Mesh *mesh);
 void BKE_mesh_runtime_reset_on_copy(struct Mesh *mesh, const int flag);
 int BKE_mesh_runtime_looptri_len(const struct Mesh *mesh);
 void BKE_mesh_runtime_looptri_recalc(struct Mesh *mesh);
 const struct MLoopTri *BKE_mesh_runtime_looptri_ensure(struct Mesh *mesh);
+const MeshVertAdjacency *BKE_mesh_runtime_vert_adjacency_ensure(struct Mesh *mesh);
+void BKE_mesh_runtime_vert_adjacency_share(struct Mesh *me_dst, const struct Mesh *me_src);
+void BKE_mesh_runtime_topology_changed(struct Mesh *mesh);
+int BKE_mesh_runtime_topology_key_new(void);
+int BKE_mesh_runtime_topology_key_ensure(struct Mesh *mesh);
 bool BKE_mesh_runtime_ensure_edit_data(struct Mesh *mesh);
 bool BKE_mesh_runtime_clear_edit_data(struct Mesh *mesh);
 void BKE_mesh_runtime_clear_geometry(struct Mesh *mesh);
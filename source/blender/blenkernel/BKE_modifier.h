@@ -213,6 +213,24 @@ typedef struct ModifierTypeInfo {
                                 const struct ModifierEvalContext *ctx,
                                 struct Mesh *mesh);
 
+  /* For non-deform types whose result topology only depends on the topology of the input and
+   * the modifier settings (never on vertex positions): update the vertex positions (and
+   * normals) of \a result, a copy of an earlier result of applyModifier, from \a mesh.
+   *
+   * \a mesh only differs by its vertex positions from the mesh that earlier result was created
+   * from, so the modifier stack can reuse its topology, custom data and index maps rather than
+   * rebuilding it (see #BKE_modifier_apply_topology_cached). The vertex array of \a result is
+   * writable, other data is shared with the cached result and must not be modified.
+   *
+   * Returns false when the positions can't be updated, the result is then rebuilt.
+   *
+   * This function is optional.
+   */
+  bool (*applyModifierDeform)(struct ModifierData *md,
+                              const struct ModifierEvalContext *ctx,
+                              struct Mesh *mesh,
+                              struct Mesh *result);
+
   /********************* Optional functions *********************/
 
   /* Initialize new instance data for this modifier type, this function
@@ -456,6 +474,14 @@ void modwrap_deformVertsEM(ModifierData *md,
                            float (*vertexCos)[3],
                            int numVerts);
 
+struct Mesh *BKE_modifier_apply_topology_cached(struct ModifierData *md,
+                                               const struct ModifierEvalContext *ctx,
+                                               struct Mesh *mesh,
+                                               const struct CustomData_MeshMasks *mask);
+void BKE_modifier_topology_cache_tag_unused(struct Object *ob);
+void BKE_modifier_topology_cache_free_unused(struct Object *ob);
+void BKE_modifier_topology_cache_free(struct Object *ob);
+
 struct Mesh *BKE_modifier_get_evaluated_mesh_from_evaluated_object(struct Object *ob_eval,
                                                                    const bool get_cage_mesh);
 
@@ -46,4 +46,12 @@ struct Mesh *BKE_subdiv_to_mesh(struct Subdiv *subdiv,
                                 const SubdivToMeshSettings *settings,
                                 const struct Mesh *coarse_mesh);
 
+/* Update vertex positions and normals of a mesh created by BKE_subdiv_to_mesh() from the
+ * same coarse topology and settings, leaving everything else untouched.
+ * Returns false if the subdivided mesh doesn't match the coarse mesh. */
+bool BKE_subdiv_to_mesh_positions(struct Subdiv *subdiv,
+                                  const SubdivToMeshSettings *settings,
+                                  const struct Mesh *coarse_mesh,
+                                  struct Mesh *subdiv_mesh);
+
 #endif /* __BKE_SUBDIV)MESH_H__ */
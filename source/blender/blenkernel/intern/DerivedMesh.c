@@ -963,6 +963,10 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   /* Clear errors before evaluation. */
   modifiers_clearErrors(ob);
 
+  if (use_cache) {
+    BKE_modifier_topology_cache_tag_unused(ob);
+  }
+
   /* Apply all leading deform modifiers. */
   if (useDeform) {
     for (; md; md = md->next, md_datamask = md_datamask->next) {
@@ -984,6 +988,9 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
           if (mesh_final == NULL) {
             mesh_final = BKE_mesh_copy_for_eval(mesh_input, true);
             ASSERT_IS_VALID_MESH(mesh_final);
+            if (use_cache) {
+              mesh_final->runtime.topology_key = BKE_mesh_runtime_topology_key_ensure(mesh_input);
+            }
           }
           BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
         }
@@ -1128,6 +1135,9 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       else {
         mesh_final = BKE_mesh_copy_for_eval(mesh_input, true);
         ASSERT_IS_VALID_MESH(mesh_final);
+        if (use_cache) {
+          mesh_final->runtime.topology_key = BKE_mesh_runtime_topology_key_ensure(mesh_input);
+        }
 
         if (deformed_verts) {
           BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
@@ -1187,7 +1197,18 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
         }
       }
 
-      Mesh *mesh_next = modwrap_applyModifier(md, &mectx, mesh_final);
+      /* Modifiers which can update the positions of their previous result reuse its topology
+       * when only vertex positions changed since the last evaluation. */
+      Mesh *mesh_next;
+      if (use_cache && mti->applyModifierDeform != NULL) {
+        mesh_next = BKE_modifier_apply_topology_cached(md, &mectx, mesh_final, &mask);
+      }
+      else {
+        mesh_next = modwrap_applyModifier(md, &mectx, mesh_final);
+        if (mesh_next) {
+          mesh_next->runtime.topology_key = 0;
+        }
+      }
       ASSERT_IS_VALID_MESH(mesh_next);
 
       if (mesh_next) {
@@ -1290,6 +1311,10 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
     modifier_freeTemporaryData(md);
   }
 
+  if (use_cache) {
+    BKE_modifier_topology_cache_free_unused(ob);
+  }
+
   /* Yay, we are done. If we have a Mesh and deformed vertices,
    * we need to apply these back onto the Mesh. If we have no
    * Mesh then we need to build one. */
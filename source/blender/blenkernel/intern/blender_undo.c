@@ -119,6 +119,16 @@ MemFileUndoData *BKE_memfile_undo_encode(Main *bmain, MemFileUndoData *mfu_prev)
     MemFile *prevfile = (mfu_prev) ? &(mfu_prev->memfile) : NULL;
     /* success = */ /* UNUSED */ BLO_write_file_mem(bmain, prevfile, &mfu->memfile, G.fileflags);
     mfu->undo_size = mfu->memfile.size;
+
+    if (G.debug & G_DEBUG_IO) {
+      MemFileChunkStats stats;
+      BLO_memfile_chunk_stats(&stats);
+      printf("Undo memory: %zu bytes added, %zu bytes stored in %u chunks (%.2fx de-duplication)\n",
+             mfu->undo_size,
+             stats.size_unique,
+             stats.chunks_unique,
+             stats.size_unique ? (double)stats.size_total / (double)stats.size_unique : 1.0);
+    }
   }
 
   bmain->is_memfile_undo_written = true;
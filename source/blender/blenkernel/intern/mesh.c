@@ -466,6 +466,9 @@ void BKE_mesh_update_customdata_pointers(Mesh *me, const bool do_ensure_tess_cd)
 
   me->mloopcol = CustomData_get_layer(&me->ldata, CD_MLOOPCOL);
   me->mloopuv = CustomData_get_layer(&me->ldata, CD_MLOOPUV);
+
+  /* Arrays freed and allocated again can have the same address, so always assume new ones. */
+  BKE_mesh_runtime_topology_changed(me);
 }
 
 bool BKE_mesh_has_custom_loop_normals(Mesh *me)
@@ -601,6 +604,11 @@ void BKE_mesh_copy_data(Main *bmain, Mesh *me_dst, const Mesh *me_src, const int
 
   BKE_mesh_update_customdata_pointers(me_dst, do_tessface);
 
+  if (alloc_type == CD_REFERENCE) {
+    /* Topology is referenced, so is its adjacency. */
+    BKE_mesh_runtime_vert_adjacency_share(me_dst, me_src);
+  }
+
   me_dst->edit_mesh = NULL;
 
   me_dst->mselect = MEM_dupallocN(me_dst->mselect);
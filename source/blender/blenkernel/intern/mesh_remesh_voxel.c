@@ -57,8 +57,12 @@
 #endif
 
 #ifdef WITH_OPENVDB
-struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
-    Mesh *mesh, struct OpenVDBTransform *transform)
+/* Flatten the triangulated mesh into the vertex and face arrays the level set is built from. */
+static void mesh_remesh_voxel_input_create(Mesh *mesh,
+                                           float **r_verts,
+                                           unsigned int **r_faces,
+                                           unsigned int *r_totverts,
+                                           unsigned int *r_totfaces)
 {
   BKE_mesh_runtime_looptri_recalc(mesh);
   const MLoopTri *looptri = BKE_mesh_runtime_looptri_ensure(mesh);
@@ -87,12 +91,27 @@ struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
     faces[i * 3 + 2] = vt->tri[2];
   }
 
+  MEM_freeN(verttri);
+
+  *r_verts = verts;
+  *r_faces = faces;
+  *r_totverts = totverts;
+  *r_totfaces = totfaces;
+}
+
+struct OpenVDBLevelSet *BKE_mesh_remesh_voxel_ovdb_mesh_to_level_set_create(
+    Mesh *mesh, struct OpenVDBTransform *transform)
+{
+  float *verts;
+  unsigned int *faces;
+  unsigned int totverts, totfaces;
+  mesh_remesh_voxel_input_create(mesh, &verts, &faces, &totverts, &totfaces);
+
   struct OpenVDBLevelSet *level_set = OpenVDBLevelSet_create(false, NULL);
   OpenVDBLevelSet_mesh_to_level_set(level_set, verts, faces, totverts, totfaces, transform);
 
   MEM_freeN(verts);
   MEM_freeN(faces);
-  MEM_freeN(verttri);
 
   return level_set;
 }
@@ -313,6 +332,111 @@ Mesh *BKE_mesh_remesh_voxel_to_mesh_nomain(Mesh *mesh, float voxel_size, float a
   return new_mesh;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Level Set Cache
+ *
+ * Voxelizing the input dominates the cost of a voxel remesh, while meshing the level set is
+ * comparatively cheap. The cache keeps the level set of the last input around so that changing
+ * only the adaptivity, or re-evaluating an unchanged mesh, skips the voxelization step.
+ * \{ */
+
+struct MeshRemeshVoxelCache {
+#ifdef WITH_OPENVDB
+  struct OpenVDBLevelSet *level_set;
+  struct OpenVDBTransform *xform;
+#endif
+  float voxel_size;
+
+  /* Input the level set was built from, compared against the next input. */
+  float *verts;
+  unsigned int *faces;
+  unsigned int totverts, totfaces;
+};
+
+MeshRemeshVoxelCache *BKE_mesh_remesh_voxel_cache_new(void)
+{
+  return MEM_callocN(sizeof(MeshRemeshVoxelCache), __func__);
+}
+
+static void mesh_remesh_voxel_cache_clear(MeshRemeshVoxelCache *cache)
+{
+#ifdef WITH_OPENVDB
+  if (cache->level_set) {
+    OpenVDBLevelSet_free(cache->level_set);
+    cache->level_set = NULL;
+  }
+  if (cache->xform) {
+    OpenVDBTransform_free(cache->xform);
+    cache->xform = NULL;
+  }
+#endif
+  MEM_SAFE_FREE(cache->verts);
+  MEM_SAFE_FREE(cache->faces);
+  cache->totverts = 0;
+  cache->totfaces = 0;
+}
+
+void BKE_mesh_remesh_voxel_cache_free(MeshRemeshVoxelCache *cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+  mesh_remesh_voxel_cache_clear(cache);
+  MEM_freeN(cache);
+}
+
+/**
+ * Same as #BKE_mesh_remesh_voxel_to_mesh_nomain, but reuses the level set stored in \a cache
+ * when \a mesh and \a voxel_size match the previous call.
+ */
+Mesh *BKE_mesh_remesh_voxel_to_mesh_cached_nomain(Mesh *mesh,
+                                                  float voxel_size,
+                                                  float adaptivity,
+                                                  MeshRemeshVoxelCache *cache)
+{
+  Mesh *new_mesh = NULL;
+#ifdef WITH_OPENVDB
+  float *verts;
+  unsigned int *faces;
+  unsigned int totverts, totfaces;
+  mesh_remesh_voxel_input_create(mesh, &verts, &faces, &totverts, &totfaces);
+
+  const bool is_cached = (cache->level_set != NULL) && (cache->voxel_size == voxel_size) &&
+                         (cache->totverts == totverts) && (cache->totfaces == totfaces) &&
+                         (memcmp(cache->verts, verts, sizeof(float[3]) * totverts) == 0) &&
+                         (memcmp(cache->faces, faces, sizeof(unsigned int[3]) * totfaces) == 0);
+
+  if (is_cached) {
+    MEM_freeN(verts);
+    MEM_freeN(faces);
+  }
+  else {
+    mesh_remesh_voxel_cache_clear(cache);
+
+    cache->xform = OpenVDBTransform_create();
+    OpenVDBTransform_create_linear_transform(cache->xform, (double)voxel_size);
+    cache->level_set = OpenVDBLevelSet_create(false, NULL);
+    OpenVDBLevelSet_mesh_to_level_set(
+        cache->level_set, verts, faces, totverts, totfaces, cache->xform);
+
+    /* Keep the input arrays to compare against on the next call. */
+    cache->voxel_size = voxel_size;
+    cache->verts = verts;
+    cache->faces = faces;
+    cache->totverts = totverts;
+    cache->totfaces = totfaces;
+  }
+
+  new_mesh = BKE_mesh_remesh_voxel_ovdb_volume_to_mesh_nomain(
+      cache->level_set, 0.0, (double)adaptivity, false);
+#else
+  UNUSED_VARS(mesh, voxel_size, adaptivity, cache);
+#endif
+  return new_mesh;
+}
+
+/** \} */
+
 void BKE_remesh_reproject_paint_mask(Mesh *target, Mesh *source)
 {
   BVHTreeFromMesh bvhtree = {
@@ -45,6 +45,8 @@
 
 static ThreadRWMutex loops_cache_lock = PTHREAD_RWLOCK_INITIALIZER;
 
+static void mesh_vert_adjacency_clear(Mesh *mesh);
+
 /**
  * Default values defined at read time.
  */
@@ -69,6 +71,9 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   memset(&runtime->looptris, 0, sizeof(runtime->looptris));
   runtime->bvh_cache = NULL;
   runtime->shrinkwrap_data = NULL;
+  runtime->vert_adjacency = NULL;
+  /* The copy is likely to be modified. */
+  runtime->topology_key = 0;
 
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
@@ -235,6 +240,216 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
     mesh->runtime.subdiv_ccg = NULL;
   }
   BKE_shrinkwrap_discard_boundary_data(mesh);
+  mesh_vert_adjacency_clear(mesh);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Vertex Adjacency
+ * \{ */
+
+static ThreadRWMutex vert_adjacency_lock = PTHREAD_RWLOCK_INITIALIZER;
+static int32_t topology_generation_last = 0;
+
+static int mesh_topology_generation_new(void)
+{
+  int32_t generation;
+  /* Zero is reserved for meshes without a generation, skip it when the counter wraps around. */
+  do {
+    generation = atomic_add_and_fetch_int32(&topology_generation_last, 1);
+  } while (generation == 0);
+  return generation;
+}
+
+/**
+ * Tag the topology arrays of \a mesh as possibly reallocated, so caches calculated for the
+ * previous topology are not used anymore.
+ */
+void BKE_mesh_runtime_topology_changed(Mesh *mesh)
+{
+  mesh->runtime.topology_generation = mesh_topology_generation_new();
+}
+
+static void mesh_vert_adjacency_calc(MeshVertAdjacency *adjacency, const Mesh *mesh)
+{
+  const MEdge *medge = mesh->medge;
+  const MLoop *mloop = mesh->mloop;
+  const MPoly *mpoly = mesh->mpoly;
+  const int totvert = mesh->totvert;
+  int *vert_verts_offset = MEM_calloc_arrayN((size_t)totvert + 1, sizeof(int), __func__);
+  int *vert_verts = MEM_malloc_arrayN((size_t)mesh->totedge * 2, sizeof(int), __func__);
+  int *vert_loops_offset = MEM_calloc_arrayN((size_t)totvert + 1, sizeof(int), __func__);
+  int *vert_loops = MEM_malloc_arrayN((size_t)mesh->totloop, sizeof(int), __func__);
+  int *loop_poly = MEM_malloc_arrayN((size_t)mesh->totloop, sizeof(int), __func__);
+  int *vert_fill;
+  int i;
+
+  /* Count users of every vertex, shifted by one so the offsets are the running sum. */
+  for (i = 0; i < mesh->totedge; i++) {
+    vert_verts_offset[medge[i].v1 + 1]++;
+    vert_verts_offset[medge[i].v2 + 1]++;
+  }
+  for (i = 0; i < mesh->totloop; i++) {
+    vert_loops_offset[mloop[i].v + 1]++;
+  }
+  for (i = 0; i < totvert; i++) {
+    vert_verts_offset[i + 1] += vert_verts_offset[i];
+    vert_loops_offset[i + 1] += vert_loops_offset[i];
+  }
+
+  /* Fill in, in the order of the edges and polygons. */
+  vert_fill = MEM_malloc_arrayN((size_t)totvert, sizeof(int), __func__);
+  memcpy(vert_fill, vert_verts_offset, sizeof(int) * (size_t)totvert);
+  for (i = 0; i < mesh->totedge; i++) {
+    vert_verts[vert_fill[medge[i].v1]++] = (int)medge[i].v2;
+    vert_verts[vert_fill[medge[i].v2]++] = (int)medge[i].v1;
+  }
+  memcpy(vert_fill, vert_loops_offset, sizeof(int) * (size_t)totvert);
+  for (i = 0; i < mesh->totpoly; i++) {
+    const MPoly *mp = &mpoly[i];
+    for (int l = mp->loopstart; l < mp->loopstart + mp->totloop; l++) {
+      vert_loops[vert_fill[mloop[l].v]++] = l;
+      loop_poly[l] = i;
+    }
+  }
+  MEM_freeN(vert_fill);
+
+  adjacency->topology_generation = mesh->runtime.topology_generation;
+  adjacency->vert_verts_offset = vert_verts_offset;
+  adjacency->vert_verts = vert_verts;
+  adjacency->vert_loops_offset = vert_loops_offset;
+  adjacency->vert_loops = vert_loops;
+  adjacency->loop_poly = loop_poly;
+}
+
+/* Must be called with #vert_adjacency_lock locked for writing. */
+static void mesh_vert_adjacency_release(Mesh *mesh)
+{
+  MeshVertAdjacency *adjacency = mesh->runtime.vert_adjacency;
+  mesh->runtime.vert_adjacency = NULL;
+
+  if (atomic_sub_and_fetch_int32(&adjacency->users, 1) != 0) {
+    return;
+  }
+  MEM_freeN(adjacency->vert_verts_offset);
+  MEM_freeN(adjacency->vert_verts);
+  MEM_freeN(adjacency->vert_loops_offset);
+  MEM_freeN(adjacency->vert_loops);
+  MEM_freeN(adjacency->loop_poly);
+  MEM_freeN(adjacency);
+}
+
+static void mesh_vert_adjacency_clear(Mesh *mesh)
+{
+  if (mesh->runtime.vert_adjacency != NULL) {
+    BLI_rw_mutex_lock(&vert_adjacency_lock, THREAD_LOCK_WRITE);
+    mesh_vert_adjacency_release(mesh);
+    BLI_rw_mutex_unlock(&vert_adjacency_lock);
+  }
+}
+
+/**
+ * Get the vertex adjacency of the mesh, calculating it if the mesh has none for its current
+ * topology. The result stays valid until the topology of the mesh changes.
+ */
+const MeshVertAdjacency *BKE_mesh_runtime_vert_adjacency_ensure(Mesh *mesh)
+{
+  MeshVertAdjacency *adjacency;
+
+  if (mesh->runtime.topology_generation == 0) {
+    atomic_cas_int32(&mesh->runtime.topology_generation, 0, mesh_topology_generation_new());
+  }
+  const int generation = mesh->runtime.topology_generation;
+
+  BLI_rw_mutex_lock(&vert_adjacency_lock, THREAD_LOCK_READ);
+  adjacency = mesh->runtime.vert_adjacency;
+  const bool is_valid = (adjacency != NULL && adjacency->topology_generation == generation);
+  BLI_rw_mutex_unlock(&vert_adjacency_lock);
+
+  if (is_valid) {
+    return adjacency;
+  }
+
+  BLI_rw_mutex_lock(&vert_adjacency_lock, THREAD_LOCK_WRITE);
+  adjacency = mesh->runtime.vert_adjacency;
+  /* The adjacency might be shared with other meshes which still use it, so a calculated
+   * adjacency is never changed. */
+  if (adjacency != NULL && adjacency->topology_generation != generation) {
+    mesh_vert_adjacency_release(mesh);
+    adjacency = NULL;
+  }
+  /* Some other thread might have already calculated the adjacency. */
+  if (adjacency == NULL) {
+    adjacency = MEM_callocN(sizeof(MeshVertAdjacency), __func__);
+    adjacency->users = 1;
+    mesh_vert_adjacency_calc(adjacency, mesh);
+    mesh->runtime.vert_adjacency = adjacency;
+  }
+  BLI_rw_mutex_unlock(&vert_adjacency_lock);
+
+  return adjacency;
+}
+
+/**
+ * Let \a me_dst, which references the topology of \a me_src, use the same topology generation
+ * and share the vertex adjacency already calculated for \a me_src.
+ */
+void BKE_mesh_runtime_vert_adjacency_share(Mesh *me_dst, const Mesh *me_src)
+{
+  BLI_assert(me_dst->runtime.vert_adjacency == NULL);
+  me_dst->runtime.topology_generation = me_src->runtime.topology_generation;
+
+  /* Only the reference owned by the source is needed, keep other threads from releasing it. */
+  BLI_rw_mutex_lock(&vert_adjacency_lock, THREAD_LOCK_READ);
+  MeshVertAdjacency *adjacency = me_src->runtime.vert_adjacency;
+  if (adjacency != NULL &&
+      adjacency->topology_generation == me_src->runtime.topology_generation) {
+    atomic_add_and_fetch_int32(&adjacency->users, 1);
+    me_dst->runtime.vert_adjacency = adjacency;
+  }
+  BLI_rw_mutex_unlock(&vert_adjacency_lock);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Topology Key
+ * \{ */
+
+static int32_t topology_key_last = 0;
+
+/**
+ * Return a key not used by any other mesh so far.
+ */
+int BKE_mesh_runtime_topology_key_new(void)
+{
+  int32_t key;
+  /* Zero is reserved for meshes without a key, skip it when the counter wraps around. */
+  do {
+    key = atomic_add_and_fetch_int32(&topology_key_last, 1);
+  } while (key == 0);
+  return key;
+}
+
+/**
+ * Return the key identifying everything but the vertex positions of \a mesh,
+ * see #Mesh_Runtime.topology_key.
+ *
+ * Meshes used as evaluation input are shared between objects evaluated from threads,
+ * so the key is assigned atomically.
+ */
+int BKE_mesh_runtime_topology_key_ensure(Mesh *mesh)
+{
+  int32_t key = mesh->runtime.topology_key;
+  if (key == 0) {
+    const int32_t key_new = BKE_mesh_runtime_topology_key_new();
+    key = atomic_cas_int32(&mesh->runtime.topology_key, 0, key_new);
+    if (key == 0) {
+      key = key_new;
+    }
+  }
+  return key;
 }
 
 /** \} */
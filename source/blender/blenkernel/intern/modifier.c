@@ -56,6 +56,7 @@
 #include "BKE_library.h"
 #include "BKE_library_query.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
 #include "BKE_multires.h"
 #include "BKE_object.h"
 #include "BKE_DerivedMesh.h"
@@ -995,6 +996,228 @@ void modwrap_deformVertsEM(ModifierData *md,
 
 /* end modifier callback wrappers */
 
+/* -------------------------------------------------------------------- */
+/** \name Topology Cache
+ *
+ * Constructive modifiers implementing #ModifierTypeInfo.applyModifierDeform keep a copy of
+ * their result in the evaluated object. When the next evaluation of the stack passes them an
+ * input which only differs by its vertex positions (an armature deforming the mesh before a
+ * subdivision surface for example), that copy is reused and only the positions are updated.
+ * \{ */
+
+typedef struct ModifierTopologyCache {
+  struct ModifierTopologyCache *next, *prev;
+
+  /** Original modifier, stays the same when the evaluated object is copied. */
+  const ModifierData *md_orig;
+  int type;
+  ModifierApplyFlag flag;
+  /** Modifier settings (everything after the #ModifierData header) the result was made with. */
+  void *settings;
+
+  /** #Mesh_Runtime.topology_key and custom data layers of the input. */
+  int input_key;
+  int input_totlayer[4];
+  CustomData_MeshMasks input_layers;
+  CustomData_MeshMasks mask;
+
+  /** Copy of the result, only stored once the same input was seen twice. */
+  Mesh *result;
+  int result_key;
+
+  bool is_used;
+} ModifierTopologyCache;
+
+static void modifier_topology_cache_result_clear(ModifierTopologyCache *cache)
+{
+  if (cache->result != NULL) {
+    BKE_id_free(NULL, cache->result);
+    cache->result = NULL;
+  }
+  cache->result_key = 0;
+}
+
+static void modifier_topology_cache_entry_free(ModifierTopologyCache *cache)
+{
+  modifier_topology_cache_result_clear(cache);
+  MEM_freeN(cache->settings);
+  MEM_freeN(cache);
+}
+
+static uint64_t customdata_layers_mask(const CustomData *data)
+{
+  uint64_t mask = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    mask |= CD_TYPE_AS_MASK(data->layers[i].type);
+  }
+  return mask;
+}
+
+static void mesh_layers_get(const Mesh *mesh,
+                            CustomData_MeshMasks *r_layers,
+                            int r_totlayer[4])
+{
+  r_layers->vmask = customdata_layers_mask(&mesh->vdata);
+  r_layers->emask = customdata_layers_mask(&mesh->edata);
+  r_layers->fmask = 0;
+  r_layers->pmask = customdata_layers_mask(&mesh->pdata);
+  r_layers->lmask = customdata_layers_mask(&mesh->ldata);
+
+  r_totlayer[0] = mesh->vdata.totlayer;
+  r_totlayer[1] = mesh->edata.totlayer;
+  r_totlayer[2] = mesh->pdata.totlayer;
+  r_totlayer[3] = mesh->ldata.totlayer;
+}
+
+/**
+ * Apply a constructive modifier, reusing the topology of its previous result when \a mesh only
+ * differs from the previous input by its vertex positions.
+ *
+ * Falls back to #modwrap_applyModifier when the modifier doesn't support this, when \a mesh has
+ * no topology key or when the cached result can't be used.
+ * The returned mesh has a topology key only when it can be used for such a comparison further
+ * down the stack.
+ */
+Mesh *BKE_modifier_apply_topology_cached(ModifierData *md,
+                                         const ModifierEvalContext *ctx,
+                                         Mesh *mesh,
+                                         const CustomData_MeshMasks *mask)
+{
+  const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+  Object *ob = ctx->object;
+  const ModifierData *md_orig = modifier_get_original(md);
+  const size_t settings_size = mti->structSize - sizeof(ModifierData);
+  const void *settings = (const char *)md + sizeof(ModifierData);
+  const int input_key = mesh->runtime.topology_key;
+  ModifierTopologyCache *cache;
+  Mesh *result;
+
+  /* Original coordinates and spaces are written into the result after the modifier is applied,
+   * they can't be shared with a cached result. */
+  const bool is_supported = (mti->applyModifierDeform != NULL) && (input_key != 0) &&
+                            (mask->vmask & (CD_MASK_ORCO | CD_MASK_CLOTH_ORCO)) == 0 &&
+                            (mask->lmask & CD_MASK_ORIGSPACE_MLOOP) == 0;
+
+  for (cache = ob->runtime.modifier_topology_cache.first; cache; cache = cache->next) {
+    if (cache->md_orig == md_orig && cache->type == md->type) {
+      break;
+    }
+  }
+
+  if (!is_supported) {
+    if (cache != NULL) {
+      BLI_remlink(&ob->runtime.modifier_topology_cache, cache);
+      modifier_topology_cache_entry_free(cache);
+    }
+    result = modwrap_applyModifier(md, ctx, mesh);
+    if (result != NULL) {
+      result->runtime.topology_key = 0;
+    }
+    return result;
+  }
+
+  if (cache == NULL) {
+    cache = MEM_callocN(sizeof(*cache), __func__);
+    cache->md_orig = md_orig;
+    cache->type = md->type;
+    cache->settings = MEM_mallocN(settings_size, __func__);
+    BLI_addtail(&ob->runtime.modifier_topology_cache, cache);
+  }
+  cache->is_used = true;
+
+  CustomData_MeshMasks input_layers;
+  int input_totlayer[4];
+  mesh_layers_get(mesh, &input_layers, input_totlayer);
+
+  const bool is_same_input =
+      (cache->input_key == input_key) && (cache->flag == ctx->flag) &&
+      memcmp(cache->settings, settings, settings_size) == 0 &&
+      memcmp(&cache->mask, mask, sizeof(*mask)) == 0 &&
+      memcmp(&cache->input_layers, &input_layers, sizeof(input_layers)) == 0 &&
+      memcmp(cache->input_totlayer, input_totlayer, sizeof(input_totlayer)) == 0;
+
+  if (is_same_input && cache->result != NULL) {
+    result = BKE_mesh_copy_for_eval(cache->result, true);
+    CustomData_duplicate_referenced_layer(&result->vdata, CD_MVERT, result->totvert);
+    /* Normals are calculated in place further down the stack. */
+    CustomData_duplicate_referenced_layer(&result->pdata, CD_NORMAL, result->totpoly);
+    CustomData_duplicate_referenced_layer(&result->ldata, CD_NORMAL, result->totloop);
+    BKE_mesh_update_customdata_pointers(result, false);
+    /* The topology arrays are still the ones of the cached result. */
+    result->runtime.topology_generation = cache->result->runtime.topology_generation;
+
+    if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
+      BKE_mesh_calc_normals(mesh);
+    }
+    if (mti->applyModifierDeform(md, ctx, mesh, result)) {
+      result->runtime.topology_key = cache->result_key;
+      return result;
+    }
+    BKE_id_free(NULL, result);
+  }
+
+  result = modwrap_applyModifier(md, ctx, mesh);
+  if (result == NULL) {
+    return NULL;
+  }
+  result->runtime.topology_key = 0;
+
+  if (is_same_input) {
+    /* Only keep a copy once the same input is seen twice, inputs changing topology on every
+     * evaluation (while editing for example) don't pay for copying the result. */
+    if (result != mesh) {
+      modifier_topology_cache_result_clear(cache);
+      cache->result = BKE_mesh_copy_for_eval(result, false);
+      cache->result_key = BKE_mesh_runtime_topology_key_new();
+      result->runtime.topology_key = cache->result_key;
+    }
+  }
+  else {
+    modifier_topology_cache_result_clear(cache);
+    cache->input_key = input_key;
+    cache->flag = ctx->flag;
+    memcpy(cache->settings, settings, settings_size);
+    cache->mask = *mask;
+    cache->input_layers = input_layers;
+    memcpy(cache->input_totlayer, input_totlayer, sizeof(input_totlayer));
+  }
+
+  return result;
+}
+
+/**
+ * Tag all cached results of \a ob as unused, entries which are still unused when
+ * #BKE_modifier_topology_cache_free_unused is called belong to removed or disabled modifiers.
+ */
+void BKE_modifier_topology_cache_tag_unused(Object *ob)
+{
+  LISTBASE_FOREACH (ModifierTopologyCache *, cache, &ob->runtime.modifier_topology_cache) {
+    cache->is_used = false;
+  }
+}
+
+void BKE_modifier_topology_cache_free_unused(Object *ob)
+{
+  ModifierTopologyCache *cache, *cache_next;
+  for (cache = ob->runtime.modifier_topology_cache.first; cache; cache = cache_next) {
+    cache_next = cache->next;
+    if (!cache->is_used) {
+      BLI_remlink(&ob->runtime.modifier_topology_cache, cache);
+      modifier_topology_cache_entry_free(cache);
+    }
+  }
+}
+
+void BKE_modifier_topology_cache_free(Object *ob)
+{
+  ModifierTopologyCache *cache;
+  while ((cache = BLI_pophead(&ob->runtime.modifier_topology_cache))) {
+    modifier_topology_cache_entry_free(cache);
+  }
+}
+
+/** \} */
+
 /**
  * Get evaluated mesh for other evaluated object, which is used as an operand for the modifier,
  * e.g. second operand for boolean modifier.
@@ -203,6 +203,7 @@ void BKE_object_free_modifiers(Object *ob, const int flag)
   BKE_object_free_softbody(ob);
 
   /* modifiers may have stored data in the DM cache */
+  BKE_modifier_topology_cache_free(ob);
   BKE_object_free_derived_caches(ob);
 }
 
@@ -510,6 +511,7 @@ void BKE_object_free_caches(Object *object)
    * object. In this case we can not free anything.
    */
   if ((object->base_flag & BASE_FROM_DUPLI) == 0) {
+    BKE_modifier_topology_cache_free(object);
     BKE_object_free_derived_caches(object);
     update_flag |= ID_RECALC_GEOMETRY;
   }
@@ -3916,6 +3918,7 @@ void BKE_object_runtime_reset_on_copy(Object *object, const int UNUSED(flag))
   runtime->mesh_deform_eval = NULL;
   runtime->curve_cache = NULL;
   runtime->gpencil_cache = NULL;
+  BLI_listbase_clear(&runtime->modifier_topology_cache);
 }
 
 /*
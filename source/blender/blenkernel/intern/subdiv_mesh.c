@@ -1082,25 +1082,16 @@ static void subdiv_mesh_vertex_of_loose_edge_interpolate(SubdivMeshContext *ctx,
   }
 }
 
-static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *foreach_context,
-                                             void *UNUSED(tls),
-                                             const int coarse_edge_index,
-                                             const float u,
-                                             const int subdiv_vertex_index)
+static void subdiv_mesh_vertex_of_loose_edge_position(SubdivMeshContext *ctx,
+                                                      const MEdge *coarse_edge,
+                                                      const float u,
+                                                      MVert *subdiv_vertex)
 {
-  SubdivMeshContext *ctx = foreach_context->user_data;
   const Mesh *coarse_mesh = ctx->coarse_mesh;
-  const MEdge *coarse_edge = &coarse_mesh->medge[coarse_edge_index];
-  Mesh *subdiv_mesh = ctx->subdiv_mesh;
-  MVert *subdiv_mvert = subdiv_mesh->mvert;
   const bool is_simple = ctx->subdiv->settings.is_simple;
   /* Find neighbors of the current loose edge. */
   const MEdge *neighbors[2];
   find_edge_neighbors(ctx, coarse_edge, neighbors);
-  /* Interpolate custom data. */
-  subdiv_mesh_vertex_of_loose_edge_interpolate(ctx, coarse_edge, u, subdiv_vertex_index);
-  /* Interpolate coordinate. */
-  MVert *subdiv_vertex = &subdiv_mvert[subdiv_vertex_index];
   if (is_simple) {
     const MVert *coarse_mvert = coarse_mesh->mvert;
     const MVert *vert_1 = &coarse_mvert[coarse_edge->v1];
@@ -1114,14 +1105,32 @@ static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *
     key_curve_position_weights(u, weights, KEY_BSPLINE);
     interp_v3_v3v3v3v3(subdiv_vertex->co, points[0], points[1], points[2], points[3], weights);
   }
+  /* Reset normal, initialize it in a similar way as edit mode does for a
+   * vertices adjacent to a loose edges. */
+  normal_float_to_short_v3(subdiv_vertex->no, subdiv_vertex->co);
+}
+
+static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *foreach_context,
+                                             void *UNUSED(tls),
+                                             const int coarse_edge_index,
+                                             const float u,
+                                             const int subdiv_vertex_index)
+{
+  SubdivMeshContext *ctx = foreach_context->user_data;
+  const Mesh *coarse_mesh = ctx->coarse_mesh;
+  const MEdge *coarse_edge = &coarse_mesh->medge[coarse_edge_index];
+  Mesh *subdiv_mesh = ctx->subdiv_mesh;
+  MVert *subdiv_mvert = subdiv_mesh->mvert;
+  /* Interpolate custom data. */
+  subdiv_mesh_vertex_of_loose_edge_interpolate(ctx, coarse_edge, u, subdiv_vertex_index);
+  /* Interpolate coordinate. */
+  MVert *subdiv_vertex = &subdiv_mvert[subdiv_vertex_index];
+  subdiv_mesh_vertex_of_loose_edge_position(ctx, coarse_edge, u, subdiv_vertex);
   /* Reset flags and such. */
   subdiv_vertex->flag = 0;
   /* TODO(sergey): This matches old behavior, but we can as well interpolate
    * it. Maybe even using vertex varying attributes. */
   subdiv_vertex->bweight = 0.0f;
-  /* Reset normal, initialize it in a similar way as edit mode does for a
-   * vertices adjacent to a loose edges. */
-  normal_float_to_short_v3(subdiv_vertex->no, subdiv_vertex->co);
 }
 
 /* =============================================================================
@@ -1154,6 +1163,140 @@ static void setup_foreach_callbacks(const SubdivMeshContext *subdiv_context,
   foreach_context->user_data_tls_free = subdiv_mesh_tls_free;
 }
 
+/* =============================================================================
+ * Positions update.
+ *
+ * Evaluates vertex coordinates and normals of an existing subdivided mesh, keeping its topology
+ * and custom data as-is. Used when only the coarse vertex positions changed.
+ */
+
+static bool subdiv_mesh_positions_topology_info(const SubdivForeachContext *foreach_context,
+                                                const int num_vertices,
+                                                const int num_edges,
+                                                const int num_loops,
+                                                const int num_polygons)
+{
+  SubdivMeshContext *subdiv_context = foreach_context->user_data;
+  Mesh *subdiv_mesh = subdiv_context->subdiv_mesh;
+  if (subdiv_mesh->totvert != num_vertices || subdiv_mesh->totedge != num_edges ||
+      subdiv_mesh->totloop != num_loops || subdiv_mesh->totpoly != num_polygons) {
+    return false;
+  }
+  subdiv_mesh_prepare_accumulator(subdiv_context, num_vertices);
+  if (subdiv_context->have_displacement) {
+    /* Displacement is accumulated in the vertex positions, which are expected to be zero. */
+    MVert *mvert = subdiv_mesh->mvert;
+    for (int i = 0; i < num_vertices; i++) {
+      zero_v3(mvert[i].co);
+    }
+  }
+  return true;
+}
+
+static void evaluate_vertex_position_and_apply_displacement(const SubdivMeshContext *ctx,
+                                                            const int ptex_face_index,
+                                                            const float u,
+                                                            const float v,
+                                                            const int subdiv_vertex_index)
+{
+  MVert *subdiv_vert = &ctx->subdiv_mesh->mvert[subdiv_vertex_index];
+  const float inv_num_accumulated = 1.0f / ctx->accumulated_counters[subdiv_vertex_index];
+  float D[3] = {0.0f, 0.0f, 0.0f};
+  if (ctx->have_displacement) {
+    copy_v3_v3(D, subdiv_vert->co);
+    mul_v3_fl(D, inv_num_accumulated);
+  }
+  BKE_subdiv_eval_limit_point(ctx->subdiv, ptex_face_index, u, v, subdiv_vert->co);
+  add_v3_v3(subdiv_vert->co, D);
+  if (ctx->can_evaluate_normals) {
+    float N[3];
+    copy_v3_v3(N, ctx->accumulated_normals[subdiv_vertex_index]);
+    normalize_v3(N);
+    normal_float_to_short_v3(subdiv_vert->no, N);
+  }
+}
+
+static void subdiv_mesh_positions_vertex_corner(const SubdivForeachContext *foreach_context,
+                                                void *UNUSED(tls),
+                                                const int ptex_face_index,
+                                                const float u,
+                                                const float v,
+                                                const int UNUSED(coarse_vertex_index),
+                                                const int UNUSED(coarse_poly_index),
+                                                const int UNUSED(coarse_corner),
+                                                const int subdiv_vertex_index)
+{
+  evaluate_vertex_position_and_apply_displacement(
+      foreach_context->user_data, ptex_face_index, u, v, subdiv_vertex_index);
+}
+
+static void subdiv_mesh_positions_vertex_edge(const SubdivForeachContext *foreach_context,
+                                              void *UNUSED(tls),
+                                              const int ptex_face_index,
+                                              const float u,
+                                              const float v,
+                                              const int UNUSED(coarse_edge_index),
+                                              const int UNUSED(coarse_poly_index),
+                                              const int UNUSED(coarse_corner),
+                                              const int subdiv_vertex_index)
+{
+  evaluate_vertex_position_and_apply_displacement(
+      foreach_context->user_data, ptex_face_index, u, v, subdiv_vertex_index);
+}
+
+static void subdiv_mesh_positions_vertex_inner(const SubdivForeachContext *foreach_context,
+                                               void *UNUSED(tls),
+                                               const int ptex_face_index,
+                                               const float u,
+                                               const float v,
+                                               const int UNUSED(coarse_poly_index),
+                                               const int UNUSED(coarse_corner),
+                                               const int subdiv_vertex_index)
+{
+  SubdivMeshContext *ctx = foreach_context->user_data;
+  MVert *subdiv_vert = &ctx->subdiv_mesh->mvert[subdiv_vertex_index];
+  eval_final_point_and_vertex_normal(
+      ctx->subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
+}
+
+static void subdiv_mesh_positions_vertex_loose(const SubdivForeachContext *foreach_context,
+                                               void *UNUSED(tls),
+                                               const int coarse_vertex_index,
+                                               const int subdiv_vertex_index)
+{
+  SubdivMeshContext *ctx = foreach_context->user_data;
+  const MVert *coarse_vertex = &ctx->coarse_mesh->mvert[coarse_vertex_index];
+  MVert *subdiv_vertex = &ctx->subdiv_mesh->mvert[subdiv_vertex_index];
+  copy_v3_v3(subdiv_vertex->co, coarse_vertex->co);
+  copy_v3_v3_short(subdiv_vertex->no, coarse_vertex->no);
+}
+
+static void subdiv_mesh_positions_vertex_of_loose_edge(
+    const struct SubdivForeachContext *foreach_context,
+    void *UNUSED(tls),
+    const int coarse_edge_index,
+    const float u,
+    const int subdiv_vertex_index)
+{
+  SubdivMeshContext *ctx = foreach_context->user_data;
+  const MEdge *coarse_edge = &ctx->coarse_mesh->medge[coarse_edge_index];
+  MVert *subdiv_vertex = &ctx->subdiv_mesh->mvert[subdiv_vertex_index];
+  subdiv_mesh_vertex_of_loose_edge_position(ctx, coarse_edge, u, subdiv_vertex);
+}
+
+static void setup_foreach_positions_callbacks(SubdivForeachContext *foreach_context)
+{
+  memset(foreach_context, 0, sizeof(*foreach_context));
+  foreach_context->topology_info = subdiv_mesh_positions_topology_info;
+  foreach_context->vertex_every_corner = subdiv_mesh_vertex_every_corner;
+  foreach_context->vertex_every_edge = subdiv_mesh_vertex_every_edge;
+  foreach_context->vertex_corner = subdiv_mesh_positions_vertex_corner;
+  foreach_context->vertex_edge = subdiv_mesh_positions_vertex_edge;
+  foreach_context->vertex_inner = subdiv_mesh_positions_vertex_inner;
+  foreach_context->vertex_loose = subdiv_mesh_positions_vertex_loose;
+  foreach_context->vertex_of_loose_edge = subdiv_mesh_positions_vertex_of_loose_edge;
+}
+
 /* =============================================================================
  * Public entry point.
  */
@@ -1204,3 +1347,35 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   subdiv_mesh_context_free(&subdiv_context);
   return result;
 }
+
+bool BKE_subdiv_to_mesh_positions(Subdiv *subdiv,
+                                  const SubdivToMeshSettings *settings,
+                                  const Mesh *coarse_mesh,
+                                  Mesh *subdiv_mesh)
+{
+  BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
+  if (!BKE_subdiv_eval_update_from_mesh(subdiv, coarse_mesh, NULL)) {
+    BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
+    return false;
+  }
+  SubdivMeshContext subdiv_context = {0};
+  subdiv_context.settings = settings;
+  subdiv_context.coarse_mesh = coarse_mesh;
+  subdiv_context.subdiv = subdiv;
+  subdiv_context.subdiv_mesh = subdiv_mesh;
+  subdiv_context.have_displacement = (subdiv->displacement_evaluator != NULL);
+  subdiv_context.can_evaluate_normals = !subdiv_context.have_displacement;
+  BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
+  SubdivForeachContext foreach_context;
+  setup_foreach_positions_callbacks(&foreach_context);
+  foreach_context.user_data = &subdiv_context;
+  const bool success = BKE_subdiv_foreach_subdiv_geometry(
+      subdiv, &foreach_context, settings, coarse_mesh);
+  BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
+  BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
+  if (success && !subdiv_context.can_evaluate_normals) {
+    subdiv_mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  }
+  subdiv_mesh_context_free(&subdiv_context);
+  return success;
+}
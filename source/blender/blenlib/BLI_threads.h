@@ -65,6 +65,8 @@ void BLI_threaded_malloc_end(void);
 int BLI_system_thread_count(void); /* gets the number of threads the system can make use of */
 void BLI_system_num_threads_override_set(int num);
 int BLI_system_num_threads_override_get(void);
+void BLI_system_numa_scheduling_set(bool use_numa);
+bool BLI_system_numa_scheduling_get(void);
 
 /* Global Mutex Locks
  *
@@ -200,6 +202,10 @@ void BLI_thread_queue_nowait(ThreadQueue *queue);
 void BLI_thread_put_process_on_fast_node(void);
 void BLI_thread_put_thread_on_fast_node(void);
 
+int BLI_thread_numa_num_nodes(void);
+int BLI_thread_numa_node_num_processors(int node);
+bool BLI_thread_put_thread_on_numa_node(int node);
+
 #ifdef __cplusplus
 }
 #endif
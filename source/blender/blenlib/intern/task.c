@@ -45,18 +45,13 @@
  */
 #define MEMPOOL_SIZE 256
 
-/* Number of tasks which are pushed directly to local thread queue.
+/* Number of tasks which fit into a per-thread work-stealing deque.
  *
- * This allows thread to fetch next task without locking the whole queue.
+ * Must be a power of two. When the deque is full, tasks are pushed to the
+ * scheduler's global queue instead. For more details see TaskDeque.
  */
-#define LOCAL_QUEUE_SIZE 1
-
-/* Number of tasks which are allowed to be scheduled in a delayed manner.
- *
- * This allows to use less locks per graph node children schedule. More details
- * could be found at TaskThreadLocalStorage::do_delayed_push.
- */
-#define DELAYED_QUEUE_SIZE 4096
+#define TASK_DEQUE_SIZE 1024
+#define TASK_DEQUE_MASK (TASK_DEQUE_SIZE - 1)
 
 #ifndef NDEBUG
 #  define ASSERT_THREAD_ID(scheduler, thread_id) \
@@ -138,25 +133,54 @@ typedef struct TaskThreadLocalStorage {
    */
   TaskMemPool task_mempool;
 
-  /* Local queue keeps thread alive by keeping small amount of tasks ready
-   * to be picked up without causing global thread locks for synchronization.
-   */
-  int num_local_queue;
-  Task *local_queue[LOCAL_QUEUE_SIZE];
-
   /* Thread can be marked for delayed tasks push. This is helpful when it's
    * know that lots of subsequent task pushed will happen from the same thread
    * without "interrupting" for task execution.
    *
-   * We try to accumulate as much tasks as possible in a local queue without
-   * any locks first, and then we push all of them into a schedulers queue
-   * from within a single mutex lock.
+   * Tasks are still pushed to the thread's deque right away, but sleeping
+   * worker threads are only woken up once all of them are pushed.
    */
   bool do_delayed_push;
-  int num_delayed_queue;
-  Task *delayed_queue[DELAYED_QUEUE_SIZE];
+
+  /* State of the random number generator used to pick a victim thread to
+   * steal tasks from.
+   */
+  uint32_t steal_rng;
+
+  /* NUMA node the thread is bound to, threads of the same node are preferred
+   * when stealing tasks. -1 when NUMA scheduling is not used.
+   */
+  int numa_node;
 } TaskThreadLocalStorage;
 
+typedef struct TaskDequeSlot {
+  Task *task;
+  /* Stored next to the task so thieves can check it without de-referencing
+   * a task which might have been taken (and freed) by another thread already.
+   */
+  TaskPool *pool;
+} TaskDequeSlot;
+
+/* Per-thread work-stealing deque (Chase-Lev, with a fixed size buffer).
+ *
+ * Only the owner thread pushes and pops tasks at the bottom of the deque, in
+ * LIFO order, so tasks spawned from within a task are executed while their
+ * data is still hot in the cache. Other threads steal tasks from the top of
+ * the deque, in FIFO order, which tends to take the biggest chunk of pending
+ * work. The only contention point between the owner and thieves is the last
+ * remaining task, which is resolved with a compare-and-swap on `top`.
+ *
+ * All writes to `top` and `bottom` are done using atomic operations, which
+ * are full memory barriers.
+ */
+typedef struct TaskDeque {
+  int64_t top;
+  /* Bottom is only written by the owner, keep it away from the cache line thieves write to. */
+  char _pad[64 - sizeof(int64_t)];
+  int64_t bottom;
+  TaskDequeSlot slots[TASK_DEQUE_SIZE];
+} TaskDeque;
+
 struct TaskPool {
   TaskScheduler *scheduler;
 
@@ -206,11 +230,21 @@ struct TaskScheduler {
   struct TaskThread *task_threads;
   int num_threads;
   bool background_thread_only;
+  /* Worker threads are bound to NUMA nodes, see BLI_system_numa_scheduling_set(). */
+  bool use_numa;
 
+  /* Global queue, used by threads which do not own a deque, for tasks pushed
+   * while the deque was full and for the background-thread-only mode.
+   */
   ListBase queue;
   ThreadMutex queue_mutex;
   ThreadCondition queue_cond;
 
+  /* Number of worker threads waiting on queue_cond, read without lock by
+   * threads pushing to their deque to know whether a wake up is needed.
+   */
+  int32_t num_sleeping;
+
   ThreadMutex startup_mutex;
   ThreadCondition startup_cond;
   volatile int num_thread_started;
@@ -225,6 +259,7 @@ typedef struct TaskThread {
   TaskScheduler *scheduler;
   int id;
   TaskThreadLocalStorage tls;
+  TaskDeque deque;
 } TaskThread;
 
 /* Helper */
@@ -243,6 +278,9 @@ BLI_INLINE void task_data_free(Task *task, const int thread_id)
 BLI_INLINE void initialize_task_tls(TaskThreadLocalStorage *tls)
 {
   memset(tls, 0, sizeof(TaskThreadLocalStorage));
+  /* Any non-zero seed works, use the address so threads pick different victims. */
+  tls->steal_rng = (uint32_t)((uintptr_t)tls >> 4) | 1u;
+  tls->numa_node = -1;
 }
 
 BLI_INLINE TaskThreadLocalStorage *get_task_tls(TaskPool *pool, const int thread_id)
@@ -326,6 +364,102 @@ static void task_free(TaskPool *pool, Task *task, const int thread_id)
   }
 }
 
+/* Task Deque */
+
+BLI_INLINE void task_deque_init(TaskDeque *deque)
+{
+  deque->top = 0;
+  deque->bottom = 0;
+}
+
+/* Load which also acts as a full memory barrier. */
+BLI_INLINE int64_t task_deque_load(int64_t *value)
+{
+  return atomic_fetch_and_add_int64(value, 0);
+}
+
+/* Unsynchronized check, only valid as a hint, or after a memory barrier. */
+BLI_INLINE bool task_deque_is_empty(const TaskDeque *deque)
+{
+  return *(volatile const int64_t *)&deque->bottom <= *(volatile const int64_t *)&deque->top;
+}
+
+/* Push task to the bottom of the deque, only to be called from the owner thread.
+ * Returns false if the deque is full. */
+static bool task_deque_push(TaskDeque *deque, Task *task)
+{
+  const int64_t bottom = deque->bottom;
+  /* Top only ever grows, so a stale value can only make us think the deque is fuller. */
+  const int64_t top = *(volatile int64_t *)&deque->top;
+  if (bottom - top >= TASK_DEQUE_SIZE) {
+    return false;
+  }
+  TaskDequeSlot *slot = &deque->slots[bottom & TASK_DEQUE_MASK];
+  slot->task = task;
+  slot->pool = task->pool;
+  /* Publish the task to thieves. */
+  atomic_add_and_fetch_int64(&deque->bottom, 1);
+  return true;
+}
+
+/* Pop task from the bottom of the deque, only to be called from the owner thread.
+ * When pool is not NULL, only a task from that pool is returned. */
+static Task *task_deque_pop(TaskDeque *deque, TaskPool *pool)
+{
+  int64_t bottom = deque->bottom - 1;
+  if (bottom < *(volatile int64_t *)&deque->top) {
+    return NULL;
+  }
+  if (pool != NULL && deque->slots[bottom & TASK_DEQUE_MASK].pool != pool) {
+    return NULL;
+  }
+
+  bottom = atomic_sub_and_fetch_int64(&deque->bottom, 1);
+  const int64_t top = *(volatile int64_t *)&deque->top;
+  if (top > bottom) {
+    /* Thieves took everything in the meantime. */
+    atomic_add_and_fetch_int64(&deque->bottom, 1);
+    return NULL;
+  }
+
+  Task *task = deque->slots[bottom & TASK_DEQUE_MASK].task;
+  if (top == bottom) {
+    /* Last task in the deque, race against thieves for it. */
+    if (atomic_cas_int64(&deque->top, top, top + 1) != top) {
+      task = NULL;
+    }
+    atomic_add_and_fetch_int64(&deque->bottom, 1);
+  }
+  return task;
+}
+
+/* Steal task from the top of the deque, can be called from any thread.
+ * When pool is not NULL, only a task from that pool is returned. */
+static Task *task_deque_steal(TaskDeque *deque, TaskPool *pool)
+{
+  if (task_deque_is_empty(deque)) {
+    return NULL;
+  }
+
+  const int64_t top = task_deque_load(&deque->top);
+  const int64_t bottom = task_deque_load(&deque->bottom);
+  if (top >= bottom) {
+    return NULL;
+  }
+
+  /* The slot can not be re-used by the owner until top is increased, so if the
+   * compare-and-swap below succeeds we know the copy is consistent. */
+  const TaskDequeSlot slot = deque->slots[top & TASK_DEQUE_MASK];
+  if (pool != NULL && slot.pool != pool) {
+    return NULL;
+  }
+  if (atomic_cas_int64(&deque->top, top, top + 1) != top) {
+    /* Lost the race against the owner or another thief. */
+    return NULL;
+  }
+  return slot.task;
+}
+
 /* Task Scheduler */
 
 static void task_pool_num_decrease(TaskPool *pool, size_t done)
@@ -353,23 +487,108 @@ static void task_pool_num_increase(TaskPool *pool, size_t new)
   BLI_mutex_unlock(&pool->num_mutex);
 }
 
-static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
+/* Run the task (unless its pool got canceled), free it and notify the pool. */
+BLI_INLINE void task_execute(TaskPool *pool, Task *task, const int thread_id)
 {
-  bool found_task = false;
-  BLI_mutex_lock(&scheduler->queue_mutex);
+  if (!pool->do_cancel) {
+    task->run(pool, task->taskdata, thread_id);
+  }
+  task_free(pool, task, thread_id);
+  task_pool_num_decrease(pool, 1);
+}
 
-  while (!scheduler->queue.first && !scheduler->do_exit) {
-    BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+/* Try to steal a task from deques of other threads, starting at a random one
+ * to spread thieves over victims. */
+static Task *task_scheduler_steal(TaskScheduler *scheduler,
+                                  TaskPool *pool,
+                                  TaskThreadLocalStorage *tls,
+                                  const TaskDeque *own_deque)
+{
+  if (scheduler->background_thread_only) {
+    return NULL;
+  }
+
+  const int num_deques = scheduler->num_threads + 1;
+  int start = 0;
+  if (tls != NULL) {
+    /* Xorshift, good enough to pick a victim. */
+    uint32_t x = tls->steal_rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tls->steal_rng = x;
+    start = (int)(x % (uint32_t)num_deques);
+  }
+
+  /* With NUMA scheduling, first try threads of our own node so the task data
+   * stays in its memory, and only then go to other nodes. */
+  const int numa_node = (tls != NULL) ? tls->numa_node : -1;
+  for (int pass = (numa_node != -1) ? 0 : 1; pass < 2; pass++) {
+    for (int i = 0; i < num_deques; i++) {
+      TaskThread *victim = &scheduler->task_threads[(start + i) % num_deques];
+      if (&victim->deque == own_deque) {
+        continue;
+      }
+      if (numa_node != -1 && (victim->tls.numa_node == numa_node) != (pass == 0)) {
+        continue;
+      }
+      Task *task = task_deque_steal(&victim->deque, pool);
+      if (task != NULL) {
+        return task;
+      }
+    }
   }
+  return NULL;
+}
 
-  do {
-    Task *current_task;
+static bool task_scheduler_deques_are_empty(TaskScheduler *scheduler)
+{
+  for (int i = 0; i < scheduler->num_threads + 1; i++) {
+    if (!task_deque_is_empty(&scheduler->task_threads[i].deque)) {
+      return false;
+    }
+  }
+  return true;
+}
 
-    /* Assuming we can only have a void queue in 'exit' case here seems logical
-     * (we should only be here after our worker thread has been woken up from a
-     * condition_wait(), which only happens after a new task was added to the queue),
-     * but it is wrong.
-     * Waiting on condition may wake up the thread even if condition is not signaled
+/* Wake up worker threads after tasks were pushed to a deque.
+ *
+ * Pushing to a deque is a full memory barrier, and sleeping threads increase
+ * num_sleeping before checking deques a last time, so either they see the
+ * new task or we see them sleeping.
+ */
+static void task_scheduler_wake_sleeping(TaskScheduler *scheduler, const bool wake_all)
+{
+  if (*(volatile int32_t *)&scheduler->num_sleeping == 0) {
+    return;
+  }
+  BLI_mutex_lock(&scheduler->queue_mutex);
+  if (wake_all) {
+    BLI_condition_notify_all(&scheduler->queue_cond);
+  }
+  else {
+    BLI_condition_notify_one(&scheduler->queue_cond);
+  }
+  BLI_mutex_unlock(&scheduler->queue_mutex);
+}
+
+static bool task_scheduler_thread_wait_pop(TaskThread *thread, Task **task)
+{
+  TaskScheduler *scheduler = thread->scheduler;
+
+  while (true) {
+    /* Own deque first, then try stealing, both without any lock. */
+    *task = task_deque_pop(&thread->deque, NULL);
+    if (*task == NULL) {
+      *task = task_scheduler_steal(scheduler, NULL, &thread->tls, &thread->deque);
+    }
+    if (*task != NULL) {
+      return true;
+    }
+
+    BLI_mutex_lock(&scheduler->queue_mutex);
+
+    /* Waiting on condition may wake up the thread even if condition is not signaled
      * (spurious wake-ups), and some race condition may also empty the queue **after**
      * condition has been signaled, but **before** awoken thread reaches this point...
      * See http://stackoverflow.com/questions/8594591
@@ -381,7 +600,7 @@ static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task
       return false;
     }
 
-    for (current_task = scheduler->queue.first; current_task != NULL;
+    for (Task *current_task = scheduler->queue.first; current_task != NULL;
          current_task = current_task->next) {
       TaskPool *pool = current_task->pool;
 
@@ -390,37 +609,25 @@ static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task
       }
 
       *task = current_task;
-      found_task = true;
       BLI_remlink(&scheduler->queue, *task);
       break;
     }
-    if (!found_task) {
-      BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
-    }
-  } while (!found_task);
 
-  BLI_mutex_unlock(&scheduler->queue_mutex);
+    if (*task == NULL) {
+      /* See task_scheduler_wake_sleeping() for why this does not miss deque pushes. */
+      atomic_add_and_fetch_int32(&scheduler->num_sleeping, 1);
+      if (task_scheduler_deques_are_empty(scheduler)) {
+        BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+      }
+      atomic_sub_and_fetch_int32(&scheduler->num_sleeping, 1);
+    }
 
-  return true;
-}
+    BLI_mutex_unlock(&scheduler->queue_mutex);
 
-BLI_INLINE void handle_local_queue(TaskThreadLocalStorage *tls, const int thread_id)
-{
-  BLI_assert(!tls->do_delayed_push);
-  while (tls->num_local_queue > 0) {
-    /* We pop task from queue before handling it so handler of the task can
-     * push next job to the local queue.
-     */
-    tls->num_local_queue--;
-    Task *local_task = tls->local_queue[tls->num_local_queue];
-    /* TODO(sergey): Double-check work_and_wait() doesn't handle other's
-     * pool tasks.
-     */
-    TaskPool *local_pool = local_task->pool;
-    local_task->run(local_pool, local_task->taskdata, thread_id);
-    task_free(local_pool, local_task, thread_id);
+    if (*task != NULL) {
+      return true;
+    }
   }
-  BLI_assert(!tls->do_delayed_push);
 }
 
 static void *task_scheduler_thread_run(void *thread_p)
@@ -433,6 +640,10 @@ static void *task_scheduler_thread_run(void *thread_p)
 
   pthread_setspecific(scheduler->tls_id_key, thread);
 
+  if (scheduler->use_numa) {
+    BLI_thread_put_thread_on_numa_node(tls->numa_node);
+  }
+
   /* signal the main thread when all threads have started */
   BLI_mutex_lock(&scheduler->startup_mutex);
   scheduler->num_thread_started++;
@@ -442,25 +653,40 @@ static void *task_scheduler_thread_run(void *thread_p)
   BLI_mutex_unlock(&scheduler->startup_mutex);
 
   /* keep popping off tasks */
-  while (task_scheduler_thread_wait_pop(scheduler, &task)) {
-    TaskPool *pool = task->pool;
-
-    /* run task */
+  while (task_scheduler_thread_wait_pop(thread, &task)) {
+    /* run task, delete it and notify pool task was done */
     BLI_assert(!tls->do_delayed_push);
-    task->run(pool, task->taskdata, thread_id);
+    task_execute(task->pool, task, thread_id);
     BLI_assert(!tls->do_delayed_push);
+  }
+  UNUSED_VARS_NDEBUG(tls);
 
-    /* delete task */
-    task_free(pool, task, thread_id);
-
-    /* Handle all tasks from local queue. */
-    handle_local_queue(tls, thread_id);
+  return NULL;
+}
 
-    /* notify pool task was done */
-    task_pool_num_decrease(pool, 1);
+/* Fill nodes with threads in order, as many threads as the node has processors.
+ * The main thread counts as the first thread of node 0, although it is not bound to it. */
+static int task_scheduler_numa_node_for_thread(const int thread_id)
+{
+  const int num_nodes = BLI_thread_numa_num_nodes();
+  int num_processors = 0;
+  for (int node = 0; node < num_nodes; node++) {
+    num_processors += BLI_thread_numa_node_num_processors(node);
+  }
+  if (num_processors == 0) {
+    return 0;
   }
 
-  return NULL;
+  /* More threads than processors, wrap around. */
+  int index = thread_id % num_processors;
+  for (int node = 0; node < num_nodes; node++) {
+    const int num_node_processors = BLI_thread_numa_node_num_processors(node);
+    if (index < num_node_processors) {
+      return node;
+    }
+    index -= num_node_processors;
+  }
+  return 0;
 }
 
 TaskScheduler *BLI_task_scheduler_create(int num_threads)
@@ -499,6 +725,17 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
   /* Initialize TLS for main thread. */
   initialize_task_tls(&scheduler->task_threads[0].tls);
 
+  /* Initialize all deques before any thread starts stealing from them. */
+  for (int i = 0; i < num_threads + 1; i++) {
+    task_deque_init(&scheduler->task_threads[i].deque);
+  }
+
+  /* Only used on systems with multiple nodes, and when there are worker threads. */
+  scheduler->use_numa = !scheduler->background_thread_only && BLI_system_numa_scheduling_get();
+  if (scheduler->use_numa) {
+    scheduler->task_threads[0].tls.numa_node = task_scheduler_numa_node_for_thread(0);
+  }
+
   pthread_key_create(&scheduler->tls_id_key, NULL);
 
   /* launch threads that will be waiting for work */
@@ -513,6 +750,9 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
       thread->scheduler = scheduler;
       thread->id = i + 1;
       initialize_task_tls(&thread->tls);
+      if (scheduler->use_numa) {
+        thread->tls.numa_node = task_scheduler_numa_node_for_thread(thread->id);
+      }
 
       if (pthread_create(&scheduler->threads[i], NULL, task_scheduler_thread_run, thread) != 0) {
         fprintf(stderr, "TaskScheduler failed to launch thread %d/%d\n", i, num_threads);
@@ -563,6 +803,12 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
   if (scheduler->task_threads) {
     for (int i = 0; i < scheduler->num_threads + 1; i++) {
       TaskThreadLocalStorage *tls = &scheduler->task_threads[i].tls;
+      TaskDeque *deque = &scheduler->task_threads[i].deque;
+      for (int64_t j = deque->top; j < deque->bottom; j++) {
+        task = deque->slots[j & TASK_DEQUE_MASK].task;
+        task_data_free(task, 0);
+        MEM_freeN(task);
+      }
       free_task_tls(tls);
     }
 
@@ -589,10 +835,8 @@ int BLI_task_scheduler_num_threads(TaskScheduler *scheduler)
   return scheduler->num_threads + 1;
 }
 
-static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
+static void task_scheduler_queue_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
 {
-  task_pool_num_increase(task->pool, 1);
-
   /* add task to queue */
   BLI_mutex_lock(&scheduler->queue_mutex);
 
@@ -607,25 +851,10 @@ static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriori
   BLI_mutex_unlock(&scheduler->queue_mutex);
 }
 
-static void task_scheduler_push_all(TaskScheduler *scheduler,
-                                    TaskPool *pool,
-                                    Task **tasks,
-                                    int num_tasks)
+static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
 {
-  if (num_tasks == 0) {
-    return;
-  }
-
-  task_pool_num_increase(pool, num_tasks);
-
-  BLI_mutex_lock(&scheduler->queue_mutex);
-
-  for (int i = 0; i < num_tasks; i++) {
-    BLI_addhead(&scheduler->queue, tasks[i]);
-  }
-
-  BLI_condition_notify_all(&scheduler->queue_cond);
-  BLI_mutex_unlock(&scheduler->queue_mutex);
+  task_pool_num_increase(task->pool, 1);
+  task_scheduler_queue_push(scheduler, task, priority);
 }
 
 static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
@@ -635,7 +864,8 @@ static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
 
   BLI_mutex_lock(&scheduler->queue_mutex);
 
-  /* free all tasks from this pool from the queue */
+  /* Free all tasks from this pool from the queue.
+   * NOTE: Tasks in thread deques can not be removed here, see BLI_task_pool_cancel(). */
   for (task = scheduler->queue.first; task; task = nexttask) {
     nexttask = task->next;
 
@@ -801,6 +1031,25 @@ BLI_INLINE bool task_can_use_local_queues(TaskPool *pool, int thread_id)
   return (thread_id != -1 && (thread_id != pool->thread_id || pool->do_work));
 }
 
+/* Deque owned by the given thread, NULL if the thread has none we can use. */
+BLI_INLINE TaskDeque *get_task_deque(TaskPool *pool, const int thread_id)
+{
+  TaskScheduler *scheduler = pool->scheduler;
+  if (thread_id == -1 || scheduler->background_thread_only) {
+    /* Worker may only run tasks from background pools, keep everything in the global queue
+     * where it can filter them. */
+    return NULL;
+  }
+  if (thread_id == 0) {
+    if (pool->use_local_tls) {
+      /* Thread which is not managed by the scheduler. */
+      return NULL;
+    }
+    BLI_assert(BLI_thread_is_main());
+  }
+  return &scheduler->task_threads[thread_id].deque;
+}
+
 static void task_pool_push(TaskPool *pool,
                            TaskRunFunction run,
                            void *taskdata,
@@ -827,27 +1076,27 @@ static void task_pool_push(TaskPool *pool,
     atomic_fetch_and_add_z(&pool->num_suspended, 1);
     return;
   }
-  /* Populate to any local queue first, this is cheapest push ever. */
-  if (task_can_use_local_queues(pool, thread_id)) {
+  /* Populate to the thread's own deque first, this is cheapest push ever.
+   * The task will be picked up next by this thread, or stolen by an idle one.
+   */
+  TaskDeque *deque = task_can_use_local_queues(pool, thread_id) ?
+                         get_task_deque(pool, thread_id) :
+                         NULL;
+  if (deque != NULL) {
     ASSERT_THREAD_ID(pool->scheduler, thread_id);
-    TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
-    /* Try to push to a local execution queue.
-     * These tasks will be picked up next.
-     */
-    if (tls->num_local_queue < LOCAL_QUEUE_SIZE) {
-      tls->local_queue[tls->num_local_queue] = task;
-      tls->num_local_queue++;
-      return;
-    }
-    /* If we are in the delayed tasks push mode, we push tasks to a
-     * temporary local queue first without any locks, and then move them
-     * to global execution queue with a single lock.
-     */
-    if (tls->do_delayed_push && tls->num_delayed_queue < DELAYED_QUEUE_SIZE) {
-      tls->delayed_queue[tls->num_delayed_queue] = task;
-      tls->num_delayed_queue++;
+    /* Increase before pushing, so a thief can not finish the task before it is counted. */
+    task_pool_num_increase(pool, 1);
+    if (task_deque_push(deque, task)) {
+      TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
+      /* In the delayed tasks push mode threads are woken up once all tasks are pushed. */
+      if (!tls->do_delayed_push) {
+        task_scheduler_wake_sleeping(pool->scheduler, false);
+      }
       return;
     }
+    /* Deque is full, fall back to the global execution queue. */
+    task_scheduler_queue_push(pool->scheduler, task, priority);
+    return;
   }
   /* Do push to a global execution pool, slowest possible method,
    * causes quite reasonable amount of threading overhead.
@@ -884,11 +1133,22 @@ void BLI_task_pool_push_from_thread(TaskPool *pool,
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
   TaskThreadLocalStorage *tls = get_task_tls(pool, pool->thread_id);
+  TaskDeque *deque = get_task_deque(pool, pool->thread_id);
   TaskScheduler *scheduler = pool->scheduler;
 
   if (atomic_fetch_and_and_uint8((uint8_t *)&pool->is_suspended, 0)) {
     if (pool->num_suspended) {
       task_pool_num_increase(pool, pool->num_suspended);
+
+      /* Move as many tasks as possible to our own deque, other threads will
+       * steal them from there without having to lock the global queue. */
+      if (deque != NULL) {
+        Task *task;
+        while ((task = pool->suspended_queue.first) && task_deque_push(deque, task)) {
+          BLI_remlink(&pool->suspended_queue, task);
+        }
+      }
+
       BLI_mutex_lock(&scheduler->queue_mutex);
 
       BLI_movelisttolist(&scheduler->queue, &pool->suspended_queue);
@@ -904,47 +1164,47 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 
   ASSERT_THREAD_ID(pool->scheduler, pool->thread_id);
 
-  handle_local_queue(tls, pool->thread_id);
-
   BLI_mutex_lock(&pool->num_mutex);
 
   while (pool->num != 0) {
     Task *task, *work_task = NULL;
-    bool found_task = false;
 
     BLI_mutex_unlock(&pool->num_mutex);
 
-    BLI_mutex_lock(&scheduler->queue_mutex);
-
-    /* find task from this pool. if we get a task from another pool,
-     * we can get into deadlock */
+    /* Find task from this pool. if we get a task from another pool,
+     * we can get into deadlock.
+     *
+     * Tasks pushed from our own tasks are at the bottom of our deque,
+     * then try to steal ones pushed by tasks running on other threads
+     * (including the top of our own deque, which might be below tasks from
+     * another pool).
+     */
+    if (deque != NULL) {
+      work_task = task_deque_pop(deque, pool);
+    }
+    if (work_task == NULL) {
+      work_task = task_scheduler_steal(scheduler, pool, tls, NULL);
+    }
+    if (work_task == NULL) {
+      BLI_mutex_lock(&scheduler->queue_mutex);
 
-    for (task = scheduler->queue.first; task; task = task->next) {
-      if (task->pool == pool) {
-        work_task = task;
-        found_task = true;
-        BLI_remlink(&scheduler->queue, task);
-        break;
+      for (task = scheduler->queue.first; task; task = task->next) {
+        if (task->pool == pool) {
+          work_task = task;
+          BLI_remlink(&scheduler->queue, task);
+          break;
+        }
       }
-    }
 
-    BLI_mutex_unlock(&scheduler->queue_mutex);
+      BLI_mutex_unlock(&scheduler->queue_mutex);
+    }
 
     /* if found task, do it, otherwise wait until other tasks are done */
-    if (found_task) {
-      /* run task */
+    if (work_task != NULL) {
+      /* run task, delete it and notify pool task was done */
       BLI_assert(!tls->do_delayed_push);
-      work_task->run(pool, work_task->taskdata, pool->thread_id);
+      task_execute(pool, work_task, pool->thread_id);
       BLI_assert(!tls->do_delayed_push);
-
-      /* delete task */
-      task_free(pool, task, pool->thread_id);
-
-      /* Handle all tasks from local queue. */
-      handle_local_queue(tls, pool->thread_id);
-
-      /* notify pool task was done */
-      task_pool_num_decrease(pool, 1);
     }
 
     BLI_mutex_lock(&pool->num_mutex);
@@ -952,14 +1212,12 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
       break;
     }
 
-    if (!found_task) {
+    if (work_task == NULL) {
       BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
     }
   }
 
   BLI_mutex_unlock(&pool->num_mutex);
-
-  BLI_assert(tls->num_local_queue == 0);
 }
 
 void BLI_task_pool_work_wait_and_reset(TaskPool *pool)
@@ -976,10 +1234,27 @@ void BLI_task_pool_cancel(TaskPool *pool)
 
   task_scheduler_clear(pool->scheduler, pool);
 
-  /* wait until all entries are cleared */
+  /* Wait until all entries are cleared.
+   *
+   * Tasks in thread deques can not be removed from there, they are discarded
+   * by whichever thread takes them. Steal what we can to help with that, so we
+   * are not waiting for busy threads to get to them.
+   */
   BLI_mutex_lock(&pool->num_mutex);
   while (pool->num) {
-    BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
+    BLI_mutex_unlock(&pool->num_mutex);
+
+    Task *task = task_scheduler_steal(pool->scheduler, pool, NULL, NULL);
+    if (task != NULL) {
+      task_data_free(task, pool->thread_id);
+      MEM_freeN(task);
+      task_pool_num_decrease(pool, 1);
+    }
+
+    BLI_mutex_lock(&pool->num_mutex);
+    if (task == NULL && pool->num) {
+      BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
+    }
   }
   BLI_mutex_unlock(&pool->num_mutex);
 
@@ -1016,9 +1291,9 @@ void BLI_task_pool_delayed_push_end(TaskPool *pool, int thread_id)
     ASSERT_THREAD_ID(pool->scheduler, thread_id);
     TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
     BLI_assert(tls->do_delayed_push);
-    task_scheduler_push_all(pool->scheduler, pool, tls->delayed_queue, tls->num_delayed_queue);
     tls->do_delayed_push = false;
-    tls->num_delayed_queue = 0;
+    /* Tasks are in the deque already, wake up threads to steal them. */
+    task_scheduler_wake_sleeping(pool->scheduler, true);
   }
 }
 
@@ -1050,6 +1325,12 @@ typedef struct ParallelRangeState {
 
   int iter;
   int chunk_size;
+
+  /* When set, tasks get a pointer to their userdata_chunk slot instead of the
+   * chunk itself, and allocate their copy of this chunk when they start.
+   * See BLI_task_parallel_range(). */
+  void *userdata_chunk_numa;
+  size_t userdata_chunk_size;
 } ParallelRangeState;
 
 BLI_INLINE void task_parallel_range_calc_chunk_size(const TaskParallelSettings *settings,
@@ -1116,6 +1397,12 @@ BLI_INLINE bool parallel_range_next_iter_get(ParallelRangeState *__restrict stat
 static void parallel_range_func(TaskPool *__restrict pool, void *userdata_chunk, int thread_id)
 {
   ParallelRangeState *__restrict state = BLI_task_pool_userdata(pool);
+  if (state->userdata_chunk_numa != NULL) {
+    void **userdata_chunk_p = userdata_chunk;
+    userdata_chunk = MEM_mallocN(state->userdata_chunk_size, "parallel range userdata chunk");
+    memcpy(userdata_chunk, state->userdata_chunk_numa, state->userdata_chunk_size);
+    *userdata_chunk_p = userdata_chunk;
+  }
   TaskParallelTLS tls = {
       .thread_id = thread_id,
       .userdata_chunk = userdata_chunk,
@@ -1209,6 +1496,8 @@ void BLI_task_parallel_range(const int start,
   state.userdata = userdata;
   state.func = func;
   state.iter = start;
+  state.userdata_chunk_numa = NULL;
+  state.userdata_chunk_size = userdata_chunk_size;
 
   task_parallel_range_calc_chunk_size(settings, num_tasks, &state);
   num_tasks = min_ii(num_tasks, max_ii(1, (stop - start) / state.chunk_size));
@@ -1224,12 +1513,24 @@ void BLI_task_parallel_range(const int start,
    * threads can read and modify the value, without any locks. */
   atomic_fetch_and_add_int32(&state.iter, 0);
 
-  if (use_userdata_chunk) {
+  /* With NUMA scheduling, let the thread running the task allocate and initialize
+   * its userdata chunk, so the chunk's memory is placed on the thread's node
+   * (first touch policy) instead of the node of the calling thread. */
+  const bool use_userdata_chunk_numa = use_userdata_chunk && task_scheduler->use_numa;
+
+  if (use_userdata_chunk_numa) {
+    state.userdata_chunk_numa = userdata_chunk;
+    userdata_chunk_array = MEM_callocN(sizeof(void *) * num_tasks, "parallel range chunks");
+  }
+  else if (use_userdata_chunk) {
     userdata_chunk_array = MALLOCA(userdata_chunk_size * num_tasks);
   }
 
   for (i = 0; i < num_tasks; i++) {
-    if (use_userdata_chunk) {
+    if (use_userdata_chunk_numa) {
+      userdata_chunk_local = &((void **)userdata_chunk_array)[i];
+    }
+    else if (use_userdata_chunk) {
       userdata_chunk_local = (char *)userdata_chunk_array + (userdata_chunk_size * i);
       memcpy(userdata_chunk_local, userdata_chunk, userdata_chunk_size);
     }
@@ -1245,7 +1546,19 @@ void BLI_task_parallel_range(const int start,
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
-  if (use_userdata_chunk) {
+  if (use_userdata_chunk_numa) {
+    for (i = 0; i < num_tasks; i++) {
+      userdata_chunk_local = ((void **)userdata_chunk_array)[i];
+      if (userdata_chunk_local != NULL) {
+        if (settings->func_finalize != NULL) {
+          settings->func_finalize(userdata, userdata_chunk_local);
+        }
+        MEM_freeN(userdata_chunk_local);
+      }
+    }
+    MEM_freeN(userdata_chunk_array);
+  }
+  else if (use_userdata_chunk) {
     if (settings->func_finalize != NULL) {
       for (i = 0; i < num_tasks; i++) {
         userdata_chunk_local = (char *)userdata_chunk_array + (userdata_chunk_size * i);
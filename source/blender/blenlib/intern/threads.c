@@ -125,6 +125,7 @@ static pthread_t mainid;
 static bool is_numa_available = false;
 static unsigned int thread_levels = 0; /* threads can be invoked inside threads */
 static int num_threads_override = 0;
+static bool use_numa_scheduling = false;
 
 /* just a max for security reasons */
 #define RE_MAX_THREAD BLENDER_MAX_THREADS
@@ -392,6 +393,18 @@ int BLI_system_num_threads_override_get(void)
   return num_threads_override;
 }
 
+/* Request NUMA-aware task scheduling, used by task schedulers created afterwards.
+ * Only has effect on systems with more than one NUMA node. */
+void BLI_system_numa_scheduling_set(bool use_numa)
+{
+  use_numa_scheduling = use_numa;
+}
+
+bool BLI_system_numa_scheduling_get(void)
+{
+  return use_numa_scheduling && BLI_thread_numa_num_nodes() > 1;
+}
+
 /* Global Mutex Locks */
 
 static ThreadMutex *global_mutex_from_type(const int type)
@@ -966,3 +979,34 @@ void BLI_thread_put_thread_on_fast_node(void)
   }
 #endif
 }
+
+int BLI_thread_numa_num_nodes(void)
+{
+  if (!is_numa_available) {
+    return 1;
+  }
+  const int num_nodes = numaAPI_GetNumNodes();
+  return (num_nodes > 0) ? num_nodes : 1;
+}
+
+/* Number of processors of the given node, 0 if the node is not available. */
+int BLI_thread_numa_node_num_processors(int node)
+{
+  if (!is_numa_available) {
+    return (node == 0) ? BLI_system_thread_count() : 0;
+  }
+  if (!numaAPI_IsNodeAvailable(node)) {
+    return 0;
+  }
+  return numaAPI_GetNumNodeProcessors(node);
+}
+
+/* Restrict the calling thread to processors of the given node.
+ * NOTE: Threads created by this thread afterwards inherit the affinity. */
+bool BLI_thread_put_thread_on_numa_node(int node)
+{
+  if (!is_numa_available) {
+    return false;
+  }
+  return numaAPI_RunThreadOnNode(node);
+}
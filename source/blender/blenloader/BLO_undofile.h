@@ -32,15 +32,28 @@ typedef struct {
   const char *buf;
   /** Size in bytes. */
   unsigned int size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /**
+   * When true, the memory was already stored by another #MemFileChunk
+   * (chunk memory is reference counted, shared by all chunks with the same content).
+   */
   bool is_identical;
 } MemFileChunk;
 
 typedef struct MemFile {
   ListBase chunks;
+  /** Size of the chunk memory this file added (not shared with previously stored files). */
   size_t size;
 } MemFile;
 
+typedef struct MemFileChunkStats {
+  /** Memory used by chunk data, each unique chunk is stored once. */
+  size_t size_unique;
+  /** Memory all chunks would use without de-duplication. */
+  size_t size_total;
+  /** Number of unique chunks. */
+  unsigned int chunks_unique;
+} MemFileChunkStats;
+
 typedef struct MemFileUndoData {
   char filename[1024]; /* FILE_MAX */
   MemFile memfile;
@@ -56,11 +69,17 @@ extern void memfile_chunk_add(MemFile *memfile,
 /* exports */
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
+extern void BLO_memfile_chunk_stats(MemFileChunkStats *r_stats);
 
 /* utilities */
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                          struct Main *bmain,
                                          struct Scene **r_scene);
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+extern bool BLO_memfile_write_file_ex(struct MemFile *memfile,
+                                      const char *filename,
+                                      const short *stop,
+                                      float *progress);
+extern void BLO_memfile_copy_shared(MemFile *memfile_dst, const MemFile *memfile_src);
 
 #endif /* __BLO_UNDOFILE_H__ */
@@ -39,5 +39,8 @@ extern bool BLO_write_file_mem(struct Main *mainvar,
                                struct MemFile *compare,
                                struct MemFile *current,
                                int write_flags);
+extern bool BLO_write_file_to_memfile(struct Main *mainvar,
+                                      struct MemFile *r_memfile,
+                                      int write_flags);
 
 #endif
@@ -34,6 +34,15 @@
 #include "BLI_utildefines.h"
 #ifndef WIN32
 #  include <unistd.h>  // for read close
+#  include <setjmp.h>
+#  include <signal.h>
+#  include <sys/mman.h>  // for mmap
+#  ifdef __linux__
+#    include <sys/vfs.h>  // for fstatfs
+#  else
+#    include <sys/param.h>
+#    include <sys/mount.h>  // for fstatfs
+#  endif
 #else
 #  include <io.h>  // for open close read
 #  include "winsock2.h"
@@ -100,6 +109,7 @@
 #include "BLI_threads.h"
 #include "BLI_mempool.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -216,6 +226,35 @@
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
+/**
+ * Memory map uncompressed files on local file-systems instead of reading them with system calls.
+ *
+ * Blocks read on demand are then copied directly from the mapping, without an intermediate
+ * buffer, pages the OS already has cached are shared between processes that open the same file.
+ *
+ * Accessing a mapping raises SIGBUS when the file is truncated or can't be read anymore,
+ * all copies from the mapping are guarded, see #blo_mmap_copy.
+ * Without signals (WIN32) files are read with system calls.
+ */
+#ifndef WIN32
+#  define USE_BLEND_FILE_MMAP
+#endif
+
+/**
+ * Only read the data blocks of an ID which direct linking can look up: the blocks reachable
+ * from the ID through the pointers stored in the ID and the blocks read so far.
+ * The large blocks (mesh arrays, custom-data layers, packed files... etc)
+ * are read in parallel when reading doesn't change the #FileData state,
+ * see #datamap_block_read_is_threadsafe.
+ *
+ * Pointers are found by scanning all pointer aligned words of data which may hold pointers,
+ * this can only reach more blocks than needed, never less.
+ * Files written with another pointer size or endianness read all blocks.
+ */
+#define USE_DATAMAP_READ_PARALLEL
+/** Blocks smaller than this are read right away. */
+#define DATAMAP_READ_PARALLEL_MIN_SIZE (1 << 16)
+
 /* use GHash for BHead name-based lookups (speeds up linking) */
 #define USE_GHASH_BHEAD
 
@@ -237,6 +276,9 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname);
 static void direct_link_modifiers(FileData *fd, ListBase *lb);
 static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const char *name);
 static BHead *find_bhead_from_idname(FileData *fd, const char *idname);
+#ifdef USE_BLEND_FILE_MMAP
+static bool blo_mmap_copy(void *dst, const void *src, size_t size);
+#endif
 
 #ifdef USE_COLLECTION_COMPAT_28
 static void expand_scene_collection(FileData *fd, Main *mainvar, SceneCollection *sc);
@@ -950,11 +992,35 @@ BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
 }
 
 #ifdef USE_BHEAD_READ_ON_DEMAND
+#  ifdef USE_BLEND_FILE_MMAP
+/**
+ * \return The data of a block which has not been read yet, directly from the memory mapped file
+ * or NULL when the file isn't mapped.
+ */
+static const void *blo_bhead_data_mapped(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->mmap_data != NULL) {
+    /* Bounds are checked when seeking past the block in #get_bhead. */
+    BLI_assert(new_bhead->file_offset + new_bhead->bhead.len <= (off64_t)fd->mmap_size);
+    return fd->mmap_data + new_bhead->file_offset;
+  }
+  return NULL;
+}
+#  endif
+
 static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
 {
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+#  ifdef USE_BLEND_FILE_MMAP
+  const void *data_mapped = blo_bhead_data_mapped(fd, thisblock);
+  if (data_mapped != NULL) {
+    return blo_mmap_copy(buf, data_mapped, (size_t)new_bhead->bhead.len);
+  }
+#  endif
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -1031,6 +1097,50 @@ static void decode_blender_header(FileData *fd)
   }
 }
 
+/**
+ * \return Per struct of \a sdna, whether it holds pointers, either as members
+ * or in members which are structs themselves.
+ */
+static const bool *read_file_dna_struct_has_pointers(const SDNA *sdna)
+{
+  bool *struct_has_pointers = MEM_calloc_arrayN(
+      sdna->structs_len, sizeof(*struct_has_pointers), __func__);
+  int *struct_from_type = MEM_malloc_arrayN(sdna->types_len, sizeof(*struct_from_type), __func__);
+
+  for (int type_nr = 0; type_nr < sdna->types_len; type_nr++) {
+    struct_from_type[type_nr] = -1;
+  }
+  for (int struct_nr = 0; struct_nr < sdna->structs_len; struct_nr++) {
+    struct_from_type[sdna->structs[struct_nr][0]] = struct_nr;
+  }
+
+  /* Propagate from nested structs until nothing changes, nesting is only a few levels deep. */
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int struct_nr = 0; struct_nr < sdna->structs_len; struct_nr++) {
+      if (struct_has_pointers[struct_nr]) {
+        continue;
+      }
+      const short *sp = sdna->structs[struct_nr];
+      for (int elem = 0; elem < sp[1]; elem++) {
+        const short elem_type = sp[2 + elem * 2];
+        const char *elem_name = sdna->names[sp[3 + elem * 2]];
+        const int elem_struct_nr = struct_from_type[elem_type];
+        if (ELEM(elem_name[0], '*', '(') ||
+            ((elem_struct_nr != -1) && struct_has_pointers[elem_struct_nr])) {
+          struct_has_pointers[struct_nr] = true;
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+
+  MEM_freeN(struct_from_type);
+  return struct_has_pointers;
+}
+
 /**
  * \return Success if the file is read correctly, else set \a r_error_message.
  */
@@ -1063,6 +1173,7 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
       if (fd->filesdna) {
         blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
         fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
+        fd->struct_has_pointers = read_file_dna_struct_has_pointers(fd->filesdna);
         /* used to retrieve ID names from (bhead+1) */
         fd->id_name_offs = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
 
@@ -1149,6 +1260,198 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+/* Memory mapped file reading. */
+
+#ifdef USE_BLEND_FILE_MMAP
+/* Installing the signal handler & mapping, thumbnails are read from threads. */
+static ThreadMutex blo_mmap_lock = BLI_MUTEX_INITIALIZER;
+
+/**
+ * Jump buffer of the thread copying from a mapping, see #blo_mmap_copy.
+ * Volatile so setting it around the copy isn't optimized away.
+ */
+static ThreadLocal(sigjmp_buf *volatile) blo_mmap_jmp;
+static struct sigaction blo_mmap_sigbus_prev;
+static bool blo_mmap_sigbus_installed = false;
+
+static void blo_mmap_sigbus_handler(int sig, siginfo_t *siginfo, void *context)
+{
+  sigjmp_buf *jmp = BLI_thread_local_get(blo_mmap_jmp);
+  if (jmp != NULL) {
+    siglongjmp(*jmp, 1);
+  }
+
+  /* Not raised while copying from a mapping, pass it on. */
+  if (blo_mmap_sigbus_prev.sa_flags & SA_SIGINFO) {
+    blo_mmap_sigbus_prev.sa_sigaction(sig, siginfo, context);
+  }
+  else if (!ELEM(blo_mmap_sigbus_prev.sa_handler, SIG_DFL, SIG_IGN)) {
+    blo_mmap_sigbus_prev.sa_handler(sig);
+  }
+  else {
+    /* Returning raises the signal again, now with the default action. */
+    sigaction(SIGBUS, &blo_mmap_sigbus_prev, NULL);
+  }
+}
+
+/**
+ * The handler stays installed once a file has been mapped,
+ * signals it doesn't handle go to the previously installed handler.
+ */
+static bool blo_mmap_sigbus_install(void)
+{
+  if (blo_mmap_sigbus_installed) {
+    return true;
+  }
+
+  BLI_thread_local_create(blo_mmap_jmp);
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = blo_mmap_sigbus_handler;
+  sa.sa_flags = SA_SIGINFO;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(SIGBUS, &sa, &blo_mmap_sigbus_prev) != 0) {
+    BLI_thread_local_delete(blo_mmap_jmp);
+    return false;
+  }
+
+  blo_mmap_sigbus_installed = true;
+  return true;
+}
+
+/**
+ * Copy from a memory mapped file.
+ *
+ * 
+eturn false when the data couldn't be read,
+ * the file was truncated by another process, on I/O errors... etc.
+ */
+static bool blo_mmap_copy(void *dst, const void *src, size_t size)
+{
+  sigjmp_buf jmp;
+  if (sigsetjmp(jmp, 1) != 0) {
+    BLI_thread_local_set(blo_mmap_jmp, NULL);
+    return false;
+  }
+  BLI_thread_local_set(blo_mmap_jmp, &jmp);
+  memcpy(dst, src, size);
+  BLI_thread_local_set(blo_mmap_jmp, NULL);
+  return true;
+}
+
+/**
+ * Mapping files on network file-systems is slow to fault in
+ * and they're more likely to change or disappear while mapped.
+ */
+static bool blo_file_is_local(int file)
+{
+#  ifdef __linux__
+  struct statfs st;
+  if (fstatfs(file, &st) != 0) {
+    return false;
+  }
+  switch ((uint)st.f_type) {
+    case 0x6969:     /* NFS_SUPER_MAGIC */
+    case 0x517B:     /* SMB_SUPER_MAGIC */
+    case 0xFF534D42: /* CIFS_MAGIC_NUMBER */
+    case 0xFE534D42: /* SMB2_MAGIC_NUMBER */
+    case 0x65735546: /* FUSE_SUPER_MAGIC */
+    case 0x5346414F: /* AFS_SUPER_MAGIC */
+    case 0x73757245: /* CODA_SUPER_MAGIC */
+    case 0x00C36400: /* CEPH_SUPER_MAGIC */
+    case 0x01021997: /* V9FS_MAGIC */
+      return false;
+  }
+  return true;
+#  elif defined(MNT_LOCAL)
+  struct statfs st;
+  return (fstatfs(file, &st) == 0) && (st.f_flags & MNT_LOCAL);
+#  else
+  UNUSED_VARS(file);
+  return false;
+#  endif
+}
+
+static int fd_read_from_mmap(FileData *filedata, void *buffer, uint size)
+{
+  /* don't read more bytes then there are available in the mapping */
+  const size_t offset = (size_t)filedata->file_offset;
+  const int readsize = (int)((offset < filedata->mmap_size) ?
+                                 MIN2((size_t)size, filedata->mmap_size - offset) :
+                                 0);
+
+  if (UNLIKELY(!blo_mmap_copy(buffer, filedata->mmap_data + offset, (size_t)readsize))) {
+    return -1;
+  }
+  filedata->file_offset += readsize;
+
+  return readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t offset_new;
+  switch (whence) {
+    case SEEK_SET:
+      offset_new = offset;
+      break;
+    case SEEK_CUR:
+      offset_new = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      offset_new = (off64_t)filedata->mmap_size + offset;
+      break;
+    default:
+      return -1;
+  }
+  /* Unlike a regular file, seeking past the end isn't allowed,
+   * so data read on demand is known to be within the mapping. */
+  if (offset_new < 0 || offset_new > (off64_t)filedata->mmap_size) {
+    return -1;
+  }
+  filedata->file_offset = offset_new;
+  return offset_new;
+}
+
+/**
+ * Map the whole file, the file descriptor can be closed afterwards.
+ *
+ * 
+eturn NULL when the file should be read with system calls instead.
+ */
+static const char *blo_file_mmap(int file, size_t *r_size)
+{
+  const size_t size = BLI_file_descriptor_size(file);
+  if ((size == (size_t)-1) || (size == 0) || !blo_file_is_local(file)) {
+    return NULL;
+  }
+
+  void *mem = (void *)-1;
+  BLI_mutex_lock(&blo_mmap_lock);
+  if (blo_mmap_sigbus_install()) {
+    mem = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+  }
+  BLI_mutex_unlock(&blo_mmap_lock);
+
+  if (mem == (void *)-1) {
+    return NULL;
+  }
+
+  *r_size = size;
+  return mem;
+}
+
+static void blo_file_munmap(const char *mem, size_t size)
+{
+  BLI_mutex_lock(&blo_mmap_lock);
+  if (munmap((void *)mem, size)) {
+    printf("%s: couldn't unmap file\n", __func__);
+  }
+  BLI_mutex_unlock(&blo_mmap_lock);
+}
+#endif /* USE_BLEND_FILE_MMAP */
+
 /* GZip file reading. */
 
 static int fd_read_gzip_from_file(FileData *filedata, void *buffer, uint size)
@@ -1165,6 +1468,233 @@ static int fd_read_gzip_from_file(FileData *filedata, void *buffer, uint size)
   return (readsize);
 }
 
+/* Block-framed GZip file reading (see #BLO_ZLIB_BLOCK_SIZE). */
+
+typedef struct ZlibBlock {
+  /** Compressed gzip member, without its header. */
+  char *in;
+  uint in_len;
+  uint in_alloc_len;
+  /** Decompressed data, #BLO_ZLIB_BLOCK_SIZE bytes. */
+  char *out;
+  uint out_len;
+  bool error;
+} ZlibBlock;
+
+typedef struct ZlibBlockReader {
+  /** Blocks decompressed in parallel, then read in order. */
+  ZlibBlock *blocks;
+  int blocks_len;
+  /** Number of blocks holding data. */
+  int blocks_used;
+  /** Block & offset the next read starts at. */
+  int block_active;
+  uint block_offset;
+} ZlibBlockReader;
+
+static uint zlib_block_get_uint32(const uchar *buf)
+{
+  return ((uint)buf[0]) | ((uint)buf[1] << 8) | ((uint)buf[2] << 16) | ((uint)buf[3] << 24);
+}
+
+/**
+ * \return true when \a header is the start of a gzip member written by #ww_open_zlib.
+ */
+static bool zlib_block_header_decode(const uchar header[BLO_ZLIB_BLOCK_HEADER_SIZE],
+                                     uint *r_member_len)
+{
+  /* ID1, ID2, CM (deflate), FLG (FEXTRA only), XLEN & the sub-field header. */
+  if ((header[0] != 0x1f) || (header[1] != 0x8b) || (header[2] != 8) || (header[3] != 4) ||
+      (header[10] != 8) || (header[11] != 0) || (header[12] != BLO_ZLIB_BLOCK_SI1) ||
+      (header[13] != BLO_ZLIB_BLOCK_SI2) || (header[14] != 4) || (header[15] != 0)) {
+    return false;
+  }
+
+  const uint member_len = zlib_block_get_uint32(&header[16]);
+  if (member_len < BLO_ZLIB_BLOCK_HEADER_SIZE + BLO_ZLIB_BLOCK_FOOTER_SIZE) {
+    return false;
+  }
+  *r_member_len = member_len;
+  return true;
+}
+
+static bool zlib_block_read_exact(int filedes, char *buffer, uint size)
+{
+  while (size != 0) {
+    const int readsize = read(filedes, buffer, size);
+    if (readsize <= 0) {
+      return false;
+    }
+    buffer += readsize;
+    size -= (uint)readsize;
+  }
+  return true;
+}
+
+static void zlib_block_decompress_cb(void *__restrict userdata,
+                                     const int index,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ZlibBlock *block = &((ZlibBlock *)userdata)[index];
+  z_stream strm = {NULL};
+
+  block->error = true;
+
+  if (inflateInit2(&strm, -MAX_WBITS) != Z_OK) {
+    return;
+  }
+
+  const uchar *footer = (const uchar *)block->in + block->in_len - BLO_ZLIB_BLOCK_FOOTER_SIZE;
+  const uint crc_expected = zlib_block_get_uint32(&footer[0]);
+
+  strm.next_in = (Bytef *)block->in;
+  strm.avail_in = block->in_len - BLO_ZLIB_BLOCK_FOOTER_SIZE;
+  strm.next_out = (Bytef *)block->out;
+  strm.avail_out = block->out_len;
+
+  const int ret = inflate(&strm, Z_FINISH);
+  const uint out_len = (uint)strm.total_out;
+  inflateEnd(&strm);
+
+  if ((ret != Z_STREAM_END) || (out_len != block->out_len) ||
+      ((uint)crc32(0, (const Bytef *)block->out, out_len) != crc_expected)) {
+    return;
+  }
+
+  block->error = false;
+}
+
+/**
+ * Read the next batch of gzip members and decompress them in parallel.
+ *
+ * \return false on error, at the end of the file no blocks are used.
+ */
+static bool zlib_block_reader_fill(FileData *fd)
+{
+  ZlibBlockReader *zbr = fd->zlib_blocks;
+
+  zbr->blocks_used = 0;
+  zbr->block_active = 0;
+  zbr->block_offset = 0;
+
+  while (zbr->blocks_used < zbr->blocks_len) {
+    ZlibBlock *block = &zbr->blocks[zbr->blocks_used];
+    uchar header[BLO_ZLIB_BLOCK_HEADER_SIZE];
+    uint member_len;
+
+    const int header_len = read(fd->filedes, header, sizeof(header));
+    if (header_len == 0) {
+      break;
+    }
+    if (header_len < 0) {
+      return false;
+    }
+    if ((header_len != sizeof(header) &&
+         !zlib_block_read_exact(
+             fd->filedes, (char *)header + header_len, sizeof(header) - header_len)) ||
+        !zlib_block_header_decode(header, &member_len)) {
+      return false;
+    }
+
+    const uint in_len = member_len - BLO_ZLIB_BLOCK_HEADER_SIZE;
+    if (in_len > block->in_alloc_len) {
+      MEM_SAFE_FREE(block->in);
+      block->in = MEM_mallocN(in_len, __func__);
+      block->in_alloc_len = in_len;
+    }
+    if (!zlib_block_read_exact(fd->filedes, block->in, in_len)) {
+      return false;
+    }
+    block->in_len = in_len;
+    block->out_len = zlib_block_get_uint32((const uchar *)block->in + in_len - 4);
+    if (block->out_len > BLO_ZLIB_BLOCK_SIZE) {
+      return false;
+    }
+    zbr->blocks_used += 1;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, zbr->blocks_used, zbr->blocks, zlib_block_decompress_cb, &settings);
+
+  for (int i = 0; i < zbr->blocks_used; i++) {
+    if (zbr->blocks[i].error) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static ZlibBlockReader *zlib_block_reader_create(void)
+{
+  ZlibBlockReader *zbr = MEM_callocN(sizeof(*zbr), __func__);
+  zbr->blocks_len = max_ii(1, BLI_system_thread_count() * 2);
+  zbr->blocks = MEM_callocN(sizeof(*zbr->blocks) * zbr->blocks_len, __func__);
+  for (int i = 0; i < zbr->blocks_len; i++) {
+    zbr->blocks[i].out = MEM_mallocN(BLO_ZLIB_BLOCK_SIZE, __func__);
+  }
+  return zbr;
+}
+
+static void zlib_block_reader_free(ZlibBlockReader *zbr)
+{
+  for (int i = 0; i < zbr->blocks_len; i++) {
+    MEM_SAFE_FREE(zbr->blocks[i].in);
+    MEM_freeN(zbr->blocks[i].out);
+  }
+  MEM_freeN(zbr->blocks);
+  MEM_freeN(zbr);
+}
+
+/**
+ * \return true when the file is a block-framed gzip file, see #BLO_ZLIB_BLOCK_SIZE.
+ * The file position is reset to the start.
+ */
+static bool zlib_block_file_check(int file)
+{
+  uchar header[BLO_ZLIB_BLOCK_HEADER_SIZE];
+  uint member_len;
+  const bool ok = (read(file, header, sizeof(header)) == sizeof(header)) &&
+                  zlib_block_header_decode(header, &member_len);
+  lseek(file, 0, SEEK_SET);
+  return ok;
+}
+
+static int fd_read_zlib_blocks_from_file(FileData *filedata, void *buffer, uint size)
+{
+  ZlibBlockReader *zbr = filedata->zlib_blocks;
+  uint readsize = 0;
+
+  while (readsize < size) {
+    if (zbr->block_active == zbr->blocks_used) {
+      if (!zlib_block_reader_fill(filedata)) {
+        printf("%s: zlib error\n", __func__);
+        return EOF;
+      }
+      if (zbr->blocks_used == 0) {
+        break;
+      }
+    }
+
+    ZlibBlock *block = &zbr->blocks[zbr->block_active];
+    const uint copy_len = MIN2(size - readsize, block->out_len - zbr->block_offset);
+    memcpy(POINTER_OFFSET(buffer, readsize), block->out + zbr->block_offset, copy_len);
+    readsize += copy_len;
+    zbr->block_offset += copy_len;
+
+    if (zbr->block_offset == block->out_len) {
+      zbr->block_active += 1;
+      zbr->block_offset = 0;
+    }
+  }
+
+  filedata->file_offset += readsize;
+
+  return (int)readsize;
+}
+
 /* Memory reading. */
 
 static int fd_read_from_memory(FileData *filedata, void *buffer, uint size)
@@ -1291,6 +1821,9 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  bool use_zlib_blocks = false;
+  const char *mmap_data = NULL;
+  size_t mmap_size = 0;
 
   char header[7];
 
@@ -1310,8 +1843,26 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   /* Regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    read_fn = fd_read_data_from_file;
-    seek_fn = fd_seek_data_from_file;
+#ifdef USE_BLEND_FILE_MMAP
+    mmap_data = blo_file_mmap(file, &mmap_size);
+    if (mmap_data != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_from_mmap;
+    }
+    else
+#endif
+    {
+      read_fn = fd_read_data_from_file;
+      seek_fn = fd_seek_data_from_file;
+    }
+  }
+
+  /* Block-framed gzip file, decompressed in parallel. */
+  if ((read_fn == NULL) && (header[0] == 0x1f && header[1] == 0x8b) &&
+      zlib_block_file_check(file)) {
+    /* 'seek_fn' is too slow for gzip, don't set it. */
+    read_fn = fd_read_zlib_blocks_from_file;
+    use_zlib_blocks = true;
   }
 
   /* Gzip file. */
@@ -1345,6 +1896,11 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  if (use_zlib_blocks) {
+    fd->zlib_blocks = zlib_block_reader_create();
+  }
+  fd->mmap_data = mmap_data;
+  fd->mmap_size = mmap_size;
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1409,20 +1965,31 @@ static int fd_read_gzip_from_memory(FileData *filedata, void *buffer, uint size)
   filedata->strm.next_out = (Bytef *)buffer;
   filedata->strm.avail_out = size;
 
-  // Inflate another chunk.
-  err = inflate(&filedata->strm, Z_SYNC_FLUSH);
+  while (filedata->strm.avail_out > 0) {
+    // Inflate another chunk.
+    err = inflate(&filedata->strm, Z_SYNC_FLUSH);
 
-  if (err == Z_STREAM_END) {
-    return 0;
-  }
-  else if (err != Z_OK) {
-    printf("fd_read_gzip_from_memory: zlib error\n");
-    return 0;
+    if (err == Z_STREAM_END) {
+      /* Compressed files are a series of gzip members (see #BLO_ZLIB_BLOCK_SIZE),
+       * continue with the next member until the input is exhausted. */
+      if (filedata->strm.avail_in == 0 || inflateReset(&filedata->strm) != Z_OK) {
+        break;
+      }
+    }
+    else if (err == Z_BUF_ERROR) {
+      /* Truncated input, return what could be read. */
+      break;
+    }
+    else if (err != Z_OK) {
+      printf("fd_read_gzip_from_memory: zlib error\n");
+      return 0;
+    }
   }
 
-  filedata->file_offset += size;
+  const uint readsize = size - filedata->strm.avail_out;
+  filedata->file_offset += readsize;
 
-  return (size);
+  return (int)readsize;
 }
 
 static int fd_read_gzip_from_memory_init(FileData *fd)
@@ -1501,6 +2068,16 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->zlib_blocks != NULL) {
+      zlib_block_reader_free(fd->zlib_blocks);
+    }
+
+#ifdef USE_BLEND_FILE_MMAP
+    if (fd->mmap_data != NULL) {
+      blo_file_munmap(fd->mmap_data, fd->mmap_size);
+    }
+#endif
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -1531,6 +2108,9 @@ void blo_filedata_free(FileData *fd)
     if (fd->compflags) {
       MEM_freeN((void *)fd->compflags);
     }
+    if (fd->struct_has_pointers) {
+      MEM_freeN((void *)fd->struct_has_pointers);
+    }
 
     if (fd->datamap) {
       oldnewmap_free(fd->datamap);
@@ -2216,7 +2796,11 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+/**
+ * Read a block, setting \a r_read_error instead of changing the #FileData state on failure,
+ * so blocks of a memory mapped file (or already in memory) can be read from multiple threads.
+ */
+static void *read_struct_ex(FileData *fd, BHead *bh, const char *blockname, bool *r_read_error)
 {
   void *temp = NULL;
 
@@ -2231,7 +2815,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
         bh = blo_bhead_read_full(fd, bh);
         if (UNLIKELY(bh == NULL)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
+          *r_read_error = true;
           return NULL;
         }
       }
@@ -2242,10 +2826,12 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
+        /* Not reconstructed directly from a memory mapped file,
+         * a read error would leave the reconstruction half way. */
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
           bh = blo_bhead_read_full(fd, bh);
           if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_read_error = true;
             return NULL;
           }
         }
@@ -2264,7 +2850,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
           if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_read_error = true;
             MEM_freeN(temp);
             temp = NULL;
           }
@@ -2284,6 +2870,16 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+  bool read_error = false;
+  void *temp = read_struct_ex(fd, bh, blockname, &read_error);
+  if (UNLIKELY(read_error)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+  return temp;
+}
+
 typedef void (*link_list_cb)(FileData *fd, void *data);
 
 static void link_list_ex(FileData *fd, ListBase *lb, link_list_cb callback) /* only direct data */
@@ -9107,22 +9703,215 @@ static const char *dataname(short id_code)
   return "Data from Lib Block";
 }
 
-static BHead *read_data_into_oldnewmap(FileData *fd, BHead *bhead, const char *allocname)
+#ifdef USE_DATAMAP_READ_PARALLEL
+typedef struct DataMapBlock {
+  BHead *bhead;
+  void *data;
+  /** Reading failed, only merged into #FileData.flags once all blocks are read. */
+  bool read_error;
+} DataMapBlock;
+
+typedef struct DataMapRead {
+  FileData *fd;
+  const char *allocname;
+  /** Old address to #DataMapBlock, for blocks which haven't been reached yet. */
+  GHash *blocks_unreached;
+  /** Range of the old addresses in #DataMapRead.blocks_unreached. */
+  uintptr_t old_min, old_max;
+  /** Reached blocks to read in parallel. */
+  DataMapBlock **blocks_parallel;
+  int blocks_parallel_len;
+  /** Read blocks which may point to other blocks. */
+  DataMapBlock **blocks_scan;
+  int blocks_scan_len;
+} DataMapRead;
+
+/**
+ * Reading data which isn't in memory yet seeks & reads from the file,
+ * unless the file is memory mapped.
+ */
+static bool datamap_block_read_is_threadsafe(const FileData *fd, BHead *bhead)
+{
+#  ifdef USE_BHEAD_READ_ON_DEMAND
+  return (fd->mmap_data != NULL) || BHEADN_FROM_BHEAD(bhead)->has_data;
+#  else
+  UNUSED_VARS(fd, bhead);
+  return true;
+#  endif
+}
+
+static bool datamap_block_has_pointers(const FileData *fd, const BHead *bhead)
+{
+  /* Raw data (written without a struct) may be an array of pointers. */
+  return (bhead->SDNAnr == 0) || fd->struct_has_pointers[bhead->SDNAnr];
+}
+
+static void datamap_block_read(DataMapRead *dmr, DataMapBlock *block)
+{
+  block->data = read_struct_ex(dmr->fd, block->bhead, dmr->allocname, &block->read_error);
+}
+
+static void datamap_block_reached(DataMapRead *dmr, DataMapBlock *block)
+{
+  if ((block->bhead->len >= DATAMAP_READ_PARALLEL_MIN_SIZE) &&
+      datamap_block_read_is_threadsafe(dmr->fd, block->bhead)) {
+    dmr->blocks_parallel[dmr->blocks_parallel_len++] = block;
+    return;
+  }
+  datamap_block_read(dmr, block);
+  if (block->data && dmr->blocks_unreached &&
+      datamap_block_has_pointers(dmr->fd, block->bhead)) {
+    dmr->blocks_scan[dmr->blocks_scan_len++] = block;
+  }
+}
+
+static void datamap_scan(DataMapRead *dmr, const void *data)
+{
+  const uintptr_t *words = data;
+  const size_t words_len = MEM_allocN_len(data) / sizeof(*words);
+  for (size_t i = 0; i < words_len; i++) {
+    const uintptr_t word = words[i];
+    /* Most words aren't pointers, avoid the hash lookup for them. */
+    if (word < dmr->old_min || word > dmr->old_max) {
+      continue;
+    }
+    DataMapBlock *block = BLI_ghash_popkey(dmr->blocks_unreached, (void *)word, NULL);
+    if (block) {
+      datamap_block_reached(dmr, block);
+    }
+  }
+}
+
+static void datamap_read_parallel_cb(void *__restrict userdata,
+                                     const int index,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DataMapRead *dmr = userdata;
+  datamap_block_read(dmr, dmr->blocks_parallel[index]);
+}
+
+/**
+ * Read the \a blocks reachable from \a owner, or all of them when pointers can't be followed.
+ * Blocks which aren't reached keep their data NULL.
+ */
+static void datamap_read_blocks(FileData *fd,
+                                DataMapBlock *blocks,
+                                const int blocks_len,
+                                const char *allocname,
+                                const void *owner)
+{
+  DataMapRead dmr = {
+      .fd = fd,
+      .allocname = allocname,
+      .blocks_parallel = MEM_malloc_arrayN(blocks_len, sizeof(DataMapBlock *), __func__),
+      .blocks_scan = MEM_malloc_arrayN(blocks_len, sizeof(DataMapBlock *), __func__),
+  };
+
+  if (owner && (fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_POINTSIZE_DIFFERS)) == 0) {
+    dmr.blocks_unreached = BLI_ghash_ptr_new_ex(__func__, (uint)blocks_len);
+    dmr.old_min = UINTPTR_MAX;
+    for (int i = 0; i < blocks_len; i++) {
+      const uintptr_t old = (uintptr_t)blocks[i].bhead->old;
+      BLI_ghash_insert(dmr.blocks_unreached, (void *)old, &blocks[i]);
+      dmr.old_min = MIN2(dmr.old_min, old);
+      dmr.old_max = MAX2(dmr.old_max, old);
+    }
+    datamap_scan(&dmr, owner);
+  }
+  else {
+    for (int i = 0; i < blocks_len; i++) {
+      datamap_block_reached(&dmr, &blocks[i]);
+    }
+  }
+
+  while (true) {
+    while (dmr.blocks_scan_len != 0) {
+      datamap_scan(&dmr, dmr.blocks_scan[--dmr.blocks_scan_len]->data);
+    }
+    if (dmr.blocks_parallel_len == 0) {
+      break;
+    }
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (dmr.blocks_parallel_len > 1);
+    settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0, dmr.blocks_parallel_len, &dmr, datamap_read_parallel_cb, &settings);
+
+    for (int i = 0; i < dmr.blocks_parallel_len; i++) {
+      DataMapBlock *block = dmr.blocks_parallel[i];
+      if (block->data && dmr.blocks_unreached && datamap_block_has_pointers(fd, block->bhead)) {
+        dmr.blocks_scan[dmr.blocks_scan_len++] = block;
+      }
+    }
+    dmr.blocks_parallel_len = 0;
+  }
+
+  if (dmr.blocks_unreached) {
+    BLI_ghash_free(dmr.blocks_unreached, NULL, NULL);
+  }
+  MEM_freeN(dmr.blocks_parallel);
+  MEM_freeN(dmr.blocks_scan);
+}
+#endif /* USE_DATAMAP_READ_PARALLEL */
+
+/**
+ * Read the data blocks following \a bhead into #FileData.datamap.
+ *
+ * \param owner: The data read from \a bhead, whose pointers lead to the data blocks.
+ */
+static BHead *read_data_into_oldnewmap(FileData *fd,
+                                       BHead *bhead,
+                                       const char *allocname,
+                                       const void *owner)
 {
   bhead = blo_bhead_next(fd, bhead);
 
+#ifdef USE_DATAMAP_READ_PARALLEL
+  BHead *bhead_first = bhead;
+  int blocks_len = 0;
+  while (bhead && bhead->code == DATA) {
+    blocks_len++;
+    bhead = blo_bhead_next(fd, bhead);
+  }
+  if (blocks_len == 0) {
+    return bhead;
+  }
+
+  DataMapBlock *blocks = MEM_calloc_arrayN(blocks_len, sizeof(*blocks), __func__);
+  BHead *bhead_iter = bhead_first;
+  for (int i = 0; i < blocks_len; i++) {
+    blocks[i].bhead = bhead_iter;
+    bhead_iter = blo_bhead_next(fd, bhead_iter);
+  }
+
+  datamap_read_blocks(fd, blocks, blocks_len, allocname, owner);
+
+  /* Merge on the main thread, in file order. */
+  for (int i = 0; i < blocks_len; i++) {
+    if (UNLIKELY(blocks[i].read_error)) {
+      fd->flags &= ~FD_FLAGS_FILE_OK;
+    }
+    if (blocks[i].data) {
+      oldnewmap_insert(fd->datamap, blocks[i].bhead->old, blocks[i].data, 0);
+    }
+  }
+  MEM_freeN(blocks);
+#else
+  UNUSED_VARS(owner);
   while (bhead && bhead->code == DATA) {
     void *data;
-#if 0
+#  if 0
     /* XXX DUMB DEBUGGING OPTION TO GIVE NAMES for guarded malloc errors */
     short *sp = fd->filesdna->structs[bhead->SDNAnr];
     char *tmp = malloc(100);
     allocname = fd->filesdna->types[sp[0]];
     strcpy(tmp, allocname);
     data = read_struct(fd, bhead, tmp);
-#else
+#  else
     data = read_struct(fd, bhead, allocname);
-#endif
+#  endif
 
     if (data) {
       oldnewmap_insert(fd->datamap, bhead->old, data, 0);
@@ -9130,6 +9919,7 @@ static BHead *read_data_into_oldnewmap(FileData *fd, BHead *bhead, const char *a
 
     bhead = blo_bhead_next(fd, bhead);
   }
+#endif
 
   return bhead;
 }
@@ -9277,7 +10067,7 @@ static BHead *read_libblock(FileData *fd,
   allocname = dataname(GS(id->name));
 
   /* read all data into fd->datamap */
-  bhead = read_data_into_oldnewmap(fd, bhead, allocname);
+  bhead = read_data_into_oldnewmap(fd, bhead, allocname, id);
 
   /* init pointers direct data */
   direct_link_id(fd, id);
@@ -9677,7 +10467,7 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
   user->subversionfile = bfd->main->subversionfile;
 
   /* read all data into fd->datamap */
-  bhead = read_data_into_oldnewmap(fd, bhead, "user def");
+  bhead = read_data_into_oldnewmap(fd, bhead, "user def", user);
 
   link_list(fd, &user->themes);
   link_list(fd, &user->user_keymaps);
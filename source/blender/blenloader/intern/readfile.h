@@ -83,6 +83,11 @@ typedef struct FileData {
   gzFile gzfiledes;
   /** Gzip stream for memory decompression. */
   z_stream strm;
+  /** Parallel reading of block-framed gzip files (see #BLO_ZLIB_BLOCK_SIZE). */
+  struct ZlibBlockReader *zlib_blocks;
+  /** Memory mapped file (uncompressed files only). */
+  const char *mmap_data;
+  size_t mmap_size;
 
   /** Now only in use for library appending. */
   char relabase[FILE_MAX];
@@ -92,6 +97,8 @@ typedef struct FileData {
   const struct SDNA *memsdna;
   /** Array of #eSDNA_StructCompare. */
   const char *compflags;
+  /** Per struct of #FileData.filesdna, whether it holds pointers (directly or nested). */
+  const bool *struct_has_pointers;
 
   int fileversion;
   /** Used to retrieve ID names from (bhead+1). */
@@ -126,6 +133,26 @@ typedef struct FileData {
 
 #define SIZEOFBLENDERHEADER 12
 
+/**
+ * Compressed blend files are written as a sequence of independent gzip members,
+ * so they can be compressed & decompressed in parallel.
+ *
+ * Each member stores at most #BLO_ZLIB_BLOCK_SIZE bytes of uncompressed data and
+ * has a gzip "extra" field holding the size of the whole member (header included),
+ * this allows the reader to locate members without having to inflate them first.
+ *
+ * Since multiple concatenated gzip members are a valid gzip stream,
+ * the files remain readable by `gzread` (and older Blender versions).
+ */
+#define BLO_ZLIB_BLOCK_SIZE (1 << 20)
+/** 10 byte gzip header, 2 byte XLEN, 4 byte sub-field header, 4 byte member size. */
+#define BLO_ZLIB_BLOCK_HEADER_SIZE 20
+/** CRC32 and ISIZE. */
+#define BLO_ZLIB_BLOCK_FOOTER_SIZE 8
+/** Sub-field identifier used in the gzip extra field. */
+#define BLO_ZLIB_BLOCK_SI1 'B'
+#define BLO_ZLIB_BLOCK_SI2 'L'
+
 /***/
 struct Main;
 void blo_join_main(ListBase *mainlist);
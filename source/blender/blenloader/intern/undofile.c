@@ -41,6 +41,9 @@
 #include "DNA_listBase.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_threads.h"
 
 #include "BLO_undofile.h"
 #include "BLO_readfile.h"
@@ -52,43 +55,156 @@
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/* -------------------------------------------------------------------- */
+/** \name Chunk Storage
+ *
+ * Chunk buffers are stored once per unique content and shared (reference counted)
+ * by all #MemFile's using them, regardless of the undo step or position within the file.
+ * This way inserting data doesn't cause all data after it to be stored again.
+ *
+ * #MemFileChunk.buf points to the data directly following a #MemFileChunkData.
+ * \{ */
+
+typedef struct MemFileChunkKey {
+  const char *buf;
+  uint size;
+  uint hash;
+} MemFileChunkKey;
+
+typedef struct MemFileChunkData {
+  /** Must be first, used as the key in #MemFileChunkStore.chunks. */
+  MemFileChunkKey key;
+  /** Number of #MemFileChunk's using this data. */
+  uint users;
+  /* Buffer data follows. */
+} MemFileChunkData;
+
+static struct MemFileChunkStore {
+  /** Set of #MemFileChunkData (lazily allocated). */
+  GSet *chunks;
+  /** Undo data may be written and freed from different threads. */
+  ThreadMutex lock;
+  MemFileChunkStats stats;
+} g_chunk_store = {
+    .chunks = NULL,
+    .lock = BLI_MUTEX_INITIALIZER,
+};
+
+#define MEMFILE_CHUNK_DATA_FROM_BUF(buf) \
+  ((MemFileChunkData *)POINTER_OFFSET(buf, -(int)sizeof(MemFileChunkData)))
+
+static uint memfile_chunk_key_hash(const void *key_v)
+{
+  const MemFileChunkKey *key = key_v;
+  return key->hash;
+}
+
+static bool memfile_chunk_key_cmp(const void *key_a_v, const void *key_b_v)
+{
+  const MemFileChunkKey *key_a = key_a_v;
+  const MemFileChunkKey *key_b = key_b_v;
+  return !((key_a->hash == key_b->hash) && (key_a->size == key_b->size) &&
+           ((key_a->buf == key_b->buf) || (memcmp(key_a->buf, key_b->buf, key_a->size) == 0)));
+}
+
+/** Add a user to \a chunk_data, must hold #MemFileChunkStore.lock. */
+static void memfile_chunk_data_user_add(MemFileChunkData *chunk_data)
+{
+  chunk_data->users += 1;
+  g_chunk_store.stats.size_total += chunk_data->key.size;
+}
+
+/**
+ * \return The stored buffer matching \a buf, adding it to the store when it doesn't exist.
+ */
+static const char *memfile_chunk_data_ensure(const char *buf, uint size, bool *r_is_new)
+{
+  MemFileChunkKey key = {
+      .buf = buf,
+      .size = size,
+      .hash = BLI_hash_mm2((const uchar *)buf, size, 0),
+  };
+
+  BLI_mutex_lock(&g_chunk_store.lock);
+
+  if (g_chunk_store.chunks == NULL) {
+    g_chunk_store.chunks = BLI_gset_new(memfile_chunk_key_hash, memfile_chunk_key_cmp, __func__);
+  }
+
+  MemFileChunkData *chunk_data = BLI_gset_lookup(g_chunk_store.chunks, &key);
+  *r_is_new = (chunk_data == NULL);
+  if (chunk_data == NULL) {
+    chunk_data = MEM_mallocN(sizeof(*chunk_data) + size, "Chunk buffer");
+    char *buf_new = (char *)(chunk_data + 1);
+    memcpy(buf_new, buf, size);
+    chunk_data->key = key;
+    chunk_data->key.buf = buf_new;
+    chunk_data->users = 0;
+    BLI_gset_insert(g_chunk_store.chunks, chunk_data);
+
+    g_chunk_store.stats.size_unique += size;
+    g_chunk_store.stats.chunks_unique += 1;
+  }
+  memfile_chunk_data_user_add(chunk_data);
+
+  BLI_mutex_unlock(&g_chunk_store.lock);
+
+  return chunk_data->key.buf;
+}
+
+/** Remove a user from the data of \a chunk, must hold #MemFileChunkStore.lock. */
+static void memfile_chunk_data_user_remove(MemFileChunk *chunk)
+{
+  MemFileChunkData *chunk_data = MEMFILE_CHUNK_DATA_FROM_BUF(chunk->buf);
+  BLI_assert(chunk_data->users > 0);
+
+  g_chunk_store.stats.size_total -= chunk_data->key.size;
+  chunk_data->users -= 1;
+  if (chunk_data->users == 0) {
+    g_chunk_store.stats.size_unique -= chunk_data->key.size;
+    g_chunk_store.stats.chunks_unique -= 1;
+    BLI_gset_remove(g_chunk_store.chunks, chunk_data, NULL);
+    MEM_freeN(chunk_data);
+
+    /* Don't keep the set around when there is no undo data. */
+    if (BLI_gset_len(g_chunk_store.chunks) == 0) {
+      BLI_gset_free(g_chunk_store.chunks, NULL);
+      g_chunk_store.chunks = NULL;
+    }
+  }
+}
+
+/**
+ * Statistics for the undo data of all #MemFile's.
+ */
+void BLO_memfile_chunk_stats(MemFileChunkStats *r_stats)
+{
+  BLI_mutex_lock(&g_chunk_store.lock);
+  *r_stats = g_chunk_store.stats;
+  BLI_mutex_unlock(&g_chunk_store.lock);
+}
+
+/** \} */
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
+  BLI_mutex_lock(&g_chunk_store.lock);
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    memfile_chunk_data_user_remove(chunk);
     MEM_freeN(chunk);
   }
+  BLI_mutex_unlock(&g_chunk_store.lock);
   memfile->size = 0;
 }
 
 /* to keep list of memfiles consistent, 'first' is always first in list */
 /* result is that 'first' is being freed */
-void BLO_memfile_merge(MemFile *first, MemFile *second)
+void BLO_memfile_merge(MemFile *first, MemFile *UNUSED(second))
 {
-  MemFileChunk *fc, *sc;
-
-  fc = first->chunks.first;
-  sc = second->chunks.first;
-  while (fc || sc) {
-    if (fc && sc) {
-      if (sc->is_identical) {
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-    }
-    if (fc) {
-      fc = fc->next;
-    }
-    if (sc) {
-      sc = sc->next;
-    }
-  }
-
+  /* Chunk data is reference counted, there is no ownership to transfer to 'second'. */
   BLO_memfile_free(first);
 }
 
@@ -100,24 +216,33 @@ void memfile_chunk_add(MemFile *memfile, const char *buf, uint size, MemFileChun
   curchunk->is_identical = false;
   BLI_addtail(&memfile->chunks, curchunk);
 
-  /* we compare compchunk with buf */
+  /* we compare compchunk with buf, the common case of unchanged data at the same
+   * position in the file, which avoids hashing the data. */
   if (*compchunk_step != NULL) {
     MemFileChunk *compchunk = *compchunk_step;
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
+
+        BLI_mutex_lock(&g_chunk_store.lock);
+        memfile_chunk_data_user_add(MEMFILE_CHUNK_DATA_FROM_BUF(curchunk->buf));
+        BLI_mutex_unlock(&g_chunk_store.lock);
       }
     }
     *compchunk_step = compchunk->next;
   }
 
-  /* not equal... */
+  /* not equal at this position, share with any other chunk with the same contents. */
   if (curchunk->buf == NULL) {
-    char *buf_new = MEM_mallocN(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+    bool is_new;
+    curchunk->buf = memfile_chunk_data_ensure(buf, size, &is_new);
+    if (is_new) {
+      memfile->size += size;
+    }
+    else {
+      curchunk->is_identical = true;
+    }
   }
 }
 
@@ -142,11 +267,30 @@ struct Main *BLO_memfile_main_get(struct MemFile *memfile,
 }
 
 /**
- * Saves .blend using undo buffer.
- *
- * \return success.
+ * Create a copy of \a memfile sharing all its chunk data,
+ * this is cheap and can be used to keep the undo data of a step after the step is freed
+ * (to save it from another thread for e.g.).
  */
-bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
+void BLO_memfile_copy_shared(MemFile *memfile_dst, const MemFile *memfile_src)
+{
+  BLI_listbase_clear(&memfile_dst->chunks);
+  /* No new memory is stored. */
+  memfile_dst->size = 0;
+
+  BLI_mutex_lock(&g_chunk_store.lock);
+  LISTBASE_FOREACH (const MemFileChunk *, chunk_src, &memfile_src->chunks) {
+    MemFileChunk *chunk_dst = MEM_dupallocN(chunk_src);
+    chunk_dst->is_identical = true;
+    memfile_chunk_data_user_add(MEMFILE_CHUNK_DATA_FROM_BUF(chunk_dst->buf));
+    BLI_addtail(&memfile_dst->chunks, chunk_dst);
+  }
+  BLI_mutex_unlock(&g_chunk_store.lock);
+}
+
+static bool memfile_write_file_handle(struct MemFile *memfile,
+                                      const char *filename,
+                                      const short *stop,
+                                      float *progress)
 {
   MemFileChunk *chunk;
   int file, oflags;
@@ -177,19 +321,71 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
     return false;
   }
 
-  for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
+  const uint chunks_len = (progress != NULL) ? (uint)BLI_listbase_count(&memfile->chunks) : 0;
+  uint chunk_index = 0;
+
+  for (chunk = memfile->chunks.first; chunk; chunk = chunk->next, chunk_index++) {
+    if (stop != NULL && *stop) {
+      break;
+    }
     if ((size_t)write(file, chunk->buf, chunk->size) != chunk->size) {
       break;
     }
+    if (progress != NULL) {
+      *progress = (float)(chunk_index + 1) / (float)chunks_len;
+    }
   }
 
   close(file);
 
   if (chunk) {
-    fprintf(stderr,
-            "Unable to save '%s': %s\n",
-            filename,
-            errno ? strerror(errno) : "Unknown error writing file");
+    if ((stop == NULL) || (*stop == 0)) {
+      fprintf(stderr,
+              "Unable to save '%s': %s\n",
+              filename,
+              errno ? strerror(errno) : "Unknown error writing file");
+    }
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Saves .blend using undo buffer.
+ *
+ * \return success.
+ */
+bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
+{
+  return memfile_write_file_handle(memfile, filename, NULL, NULL);
+}
+
+/**
+ * Saves .blend using undo buffer, writing to a temporary file which replaces \a filename
+ * once it's complete, so an existing file is never left partially written.
+ *
+ * Can be used from a thread (see #BLO_memfile_copy_shared).
+ *
+ * \param stop: Optional, cancel writing when set.
+ * \param progress: Optional, set to the fraction of data written.
+ * \return success.
+ */
+bool BLO_memfile_write_file_ex(struct MemFile *memfile,
+                               const char *filename,
+                               const short *stop,
+                               float *progress)
+{
+  char tempname[FILE_MAX + 1];
+  BLI_snprintf(tempname, sizeof(tempname), "%s@", filename);
+
+  if (!memfile_write_file_handle(memfile, tempname, stop, progress)) {
+    BLI_delete(tempname, false, false);
+    return false;
+  }
+
+  if (BLI_rename(tempname, filename) != 0) {
+    fprintf(stderr, "Unable to save '%s': cannot replace existing file\n", filename);
+    BLI_delete(tempname, false, false);
     return false;
   }
   return true;
@@ -142,7 +142,10 @@
 #include "MEM_guardedalloc.h"  // MEM_freeN
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_action.h"
 #include "BKE_blender_version.h"
@@ -195,6 +198,7 @@
 typedef enum {
   WW_WRAP_NONE = 1,
   WW_WRAP_ZLIB,
+  WW_WRAP_MEMFILE,
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
@@ -210,7 +214,8 @@ struct WriteWrap {
   /* internal */
   union {
     int file_handle;
-    gzFile gz_handle;
+    struct ZlibBlockWriter *zlib_block_writer;
+    MemFile *memfile;
   } _user_data;
 };
 
@@ -241,32 +246,219 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+/* zlib (block-framed, see #BLO_ZLIB_BLOCK_SIZE) */
 
-static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+typedef struct ZlibBlock {
+  /** Uncompressed data, #BLO_ZLIB_BLOCK_SIZE bytes. */
+  char *in;
+  uint in_len;
+  /** Complete gzip member (header, deflate stream & footer). */
+  char *out;
+  uint out_len;
+  uint out_alloc_len;
+  bool error;
+} ZlibBlock;
+
+typedef struct ZlibBlockWriter {
+  int file_handle;
+  /** Blocks compressed in parallel before being written out in order. */
+  ZlibBlock *blocks;
+  int blocks_len;
+  /** The block currently being filled. */
+  int block_active;
+  bool error;
+} ZlibBlockWriter;
+
+static void zlib_block_put_uint32(char *buf, uint value)
+{
+  buf[0] = (char)(value & 0xff);
+  buf[1] = (char)((value >> 8) & 0xff);
+  buf[2] = (char)((value >> 16) & 0xff);
+  buf[3] = (char)((value >> 24) & 0xff);
+}
+
+static void zlib_block_compress_cb(void *__restrict userdata,
+                                   const int index,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  gzFile file;
+  ZlibBlock *block = &((ZlibBlock *)userdata)[index];
+  z_stream strm = {NULL};
 
-  file = BLI_gzopen(filepath, "wb1");
+  block->error = true;
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
-    return true;
+  /* Raw deflate, the gzip header and footer are written by hand. */
+  if (deflateInit2(&strm, 1, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return;
   }
-  else {
+
+  strm.next_in = (Bytef *)block->in;
+  strm.avail_in = block->in_len;
+  strm.next_out = (Bytef *)block->out + BLO_ZLIB_BLOCK_HEADER_SIZE;
+  strm.avail_out = block->out_alloc_len - (BLO_ZLIB_BLOCK_HEADER_SIZE +
+                                           BLO_ZLIB_BLOCK_FOOTER_SIZE);
+
+  const int ret = deflate(&strm, Z_FINISH);
+  const uint deflate_len = (uint)strm.total_out;
+  deflateEnd(&strm);
+
+  if (ret != Z_STREAM_END) {
+    return;
+  }
+
+  char *header = block->out;
+  block->out_len = BLO_ZLIB_BLOCK_HEADER_SIZE + deflate_len + BLO_ZLIB_BLOCK_FOOTER_SIZE;
+
+  /* ID1, ID2, CM (deflate), FLG (FEXTRA). */
+  header[0] = (char)0x1f;
+  header[1] = (char)0x8b;
+  header[2] = 8;
+  header[3] = 4;
+  /* MTIME (unset), XFL (fastest), OS (unknown). */
+  zlib_block_put_uint32(&header[4], 0);
+  header[8] = 4;
+  header[9] = (char)255;
+  /* XLEN, then a single sub-field storing the member size. */
+  header[10] = 8;
+  header[11] = 0;
+  header[12] = BLO_ZLIB_BLOCK_SI1;
+  header[13] = BLO_ZLIB_BLOCK_SI2;
+  header[14] = 4;
+  header[15] = 0;
+  zlib_block_put_uint32(&header[16], block->out_len);
+
+  char *footer = block->out + BLO_ZLIB_BLOCK_HEADER_SIZE + deflate_len;
+  zlib_block_put_uint32(&footer[0], (uint)crc32(0, (const Bytef *)block->in, block->in_len));
+  zlib_block_put_uint32(&footer[4], block->in_len);
+
+  block->error = false;
+}
+
+/**
+ * Compress all pending blocks in parallel, then write them to the file in order.
+ */
+static void zlib_block_writer_flush(ZlibBlockWriter *zbw)
+{
+  int blocks_len = zbw->block_active;
+  if ((blocks_len < zbw->blocks_len) && (zbw->blocks[blocks_len].in_len != 0)) {
+    blocks_len += 1;
+  }
+  if (blocks_len == 0) {
+    return;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, blocks_len, zbw->blocks, zlib_block_compress_cb, &settings);
+
+  for (int i = 0; i < blocks_len; i++) {
+    ZlibBlock *block = &zbw->blocks[i];
+    if (block->error ||
+        ((size_t)write(zbw->file_handle, block->out, block->out_len) != block->out_len)) {
+      zbw->error = true;
+    }
+    block->in_len = 0;
+    block->out_len = 0;
+  }
+  zbw->block_active = 0;
+}
+
+#define ZLIB_BLOCK_WRITER(ww) (ww)->_user_data.zlib_block_writer
+
+static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+{
+  int file;
+
+  file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+  if (file == -1) {
     return false;
   }
+
+  ZlibBlockWriter *zbw = MEM_callocN(sizeof(*zbw), __func__);
+  zbw->file_handle = file;
+  /* Enough blocks to keep all threads busy, two per thread to even out
+   * differences in the time taken by each block. */
+  zbw->blocks_len = max_ii(1, BLI_system_thread_count() * 2);
+  zbw->blocks = MEM_callocN(sizeof(*zbw->blocks) * zbw->blocks_len, __func__);
+
+  const uint out_alloc_len = (uint)compressBound(BLO_ZLIB_BLOCK_SIZE) +
+                             BLO_ZLIB_BLOCK_HEADER_SIZE + BLO_ZLIB_BLOCK_FOOTER_SIZE;
+  for (int i = 0; i < zbw->blocks_len; i++) {
+    ZlibBlock *block = &zbw->blocks[i];
+    block->in = MEM_mallocN(BLO_ZLIB_BLOCK_SIZE, __func__);
+    block->out = MEM_mallocN(out_alloc_len, __func__);
+    block->out_alloc_len = out_alloc_len;
+  }
+
+  ZLIB_BLOCK_WRITER(ww) = zbw;
+  return true;
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  ZlibBlockWriter *zbw = ZLIB_BLOCK_WRITER(ww);
+
+  zlib_block_writer_flush(zbw);
+
+  bool ok = !zbw->error;
+  if (close(zbw->file_handle) == -1) {
+    ok = false;
+  }
+
+  for (int i = 0; i < zbw->blocks_len; i++) {
+    MEM_freeN(zbw->blocks[i].in);
+    MEM_freeN(zbw->blocks[i].out);
+  }
+  MEM_freeN(zbw->blocks);
+  MEM_freeN(zbw);
+  ZLIB_BLOCK_WRITER(ww) = NULL;
+
+  return ok;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  ZlibBlockWriter *zbw = ZLIB_BLOCK_WRITER(ww);
+  size_t buf_remain = buf_len;
+
+  while (buf_remain != 0) {
+    ZlibBlock *block = &zbw->blocks[zbw->block_active];
+    const uint copy_len = (uint)MIN2(buf_remain, (size_t)(BLO_ZLIB_BLOCK_SIZE - block->in_len));
+    memcpy(block->in + block->in_len, buf, copy_len);
+    block->in_len += copy_len;
+    buf += copy_len;
+    buf_remain -= copy_len;
+
+    if (block->in_len == BLO_ZLIB_BLOCK_SIZE) {
+      zbw->block_active += 1;
+      if (zbw->block_active == zbw->blocks_len) {
+        zlib_block_writer_flush(zbw);
+      }
+    }
+  }
+
+  return zbw->error ? 0 : buf_len;
 }
-#undef FILE_HANDLE
+#undef ZLIB_BLOCK_WRITER
+
+/* memfile (file contents kept in memory, written to disk later) */
+#define MEMFILE(ww) (ww)->_user_data.memfile
+
+static bool ww_open_memfile(WriteWrap *UNUSED(ww), const char *UNUSED(filepath))
+{
+  return true;
+}
+static bool ww_close_memfile(WriteWrap *UNUSED(ww))
+{
+  return true;
+}
+static size_t ww_write_memfile(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+  MemFileChunk *compare_chunk = NULL;
+  memfile_chunk_add(MEMFILE(ww), buf, (uint)buf_len, &compare_chunk);
+  return buf_len;
+}
+#undef MEMFILE
 
 /* --- end compression types --- */
 
@@ -282,6 +474,13 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->use_buf = false;
       break;
     }
+    case WW_WRAP_MEMFILE: {
+      r_ww->open = ww_open_memfile;
+      r_ww->close = ww_close_memfile;
+      r_ww->write = ww_write_memfile;
+      r_ww->use_buf = true;
+      break;
+    }
     default: {
       r_ww->open = ww_open_none;
       r_ww->close = ww_close_none;
@@ -4151,4 +4350,26 @@ bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int w
   return (err == 0);
 }
 
+/**
+ * Write a regular (non undo) uncompressed blend file into \a r_memfile instead of to disk,
+ * so it can be written out later with #BLO_memfile_write_file, e.g. from a background job.
+ * Unlike #BLO_write_file_mem, the contents are the same as for #BLO_write_file.
+ *
+ * \return Success.
+ */
+bool BLO_write_file_to_memfile(Main *mainvar, MemFile *r_memfile, int write_flags)
+{
+  WriteWrap ww;
+  ww_handle_init(WW_WRAP_MEMFILE, &ww);
+  ww._user_data.memfile = r_memfile;
+
+  write_flags &= ~(G_FILE_COMPRESS | G_FILE_HISTORY | G_FILE_RELATIVE_REMAP);
+
+  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, NULL);
+
+  ww.close(&ww);
+
+  return (err == 0);
+}
+
 /** \} */
@@ -837,6 +837,68 @@ finally:
 
 #ifdef USE_BVH
 
+struct ISectOverlapData {
+  BMLoop *(*looptris)[3];
+  float eps;
+};
+
+/**
+ * Check if all points of \a t_cos_a are further than \a eps from the plane of \a t_cos_b,
+ * on the same side.
+ */
+static bool tri_tri_plane_is_separated(const float *t_cos_a[3],
+                                       const float *t_cos_b[3],
+                                       const float eps)
+{
+  float plane[4];
+
+  /* Degenerate triangles can't be ruled out. */
+  if (normal_tri_v3(plane, UNPACK3(t_cos_b)) == 0.0f) {
+    return false;
+  }
+  plane[3] = -dot_v3v3(plane, t_cos_b[0]);
+
+  const float side[3] = {
+      plane_point_side_v3(plane, t_cos_a[0]),
+      plane_point_side_v3(plane, t_cos_a[1]),
+      plane_point_side_v3(plane, t_cos_a[2]),
+  };
+
+  return ((side[0] > eps) && (side[1] > eps) && (side[2] > eps)) ||
+         ((side[0] < -eps) && (side[1] < -eps) && (side[2] < -eps));
+}
+
+/**
+ * Filter for the BVH overlap, rejecting triangle pairs #bm_isect_tri_tri would skip
+ * without making any changes.
+ *
+ * This runs threaded while traversing the trees, leaving only the pairs which may need
+ * cutting for the single threaded pass that edits the mesh.
+ */
+static bool bm_isect_tri_tri_overlap_cb(void *userdata,
+                                        int index_a,
+                                        int index_b,
+                                        int UNUSED(thread))
+{
+  const struct ISectOverlapData *data = userdata;
+  BMLoop **a = data->looptris[index_a];
+  BMLoop **b = data->looptris[index_b];
+  BMVert *fv_a[3] = {UNPACK3_EX(, a, ->v)};
+  BMVert *fv_b[3] = {UNPACK3_EX(, b, ->v)};
+
+  /* Same early exit as #bm_isect_tri_tri. */
+  if (ELEM(fv_a[0], UNPACK3(fv_b)) || ELEM(fv_a[1], UNPACK3(fv_b)) ||
+      ELEM(fv_a[2], UNPACK3(fv_b))) {
+    return false;
+  }
+
+  const float *f_a_cos[3] = {UNPACK3_EX(, fv_a, ->co)};
+  const float *f_b_cos[3] = {UNPACK3_EX(, fv_b, ->co)};
+
+  return !(tri_tri_plane_is_separated(f_a_cos, f_b_cos, data->eps) ||
+           tri_tri_plane_is_separated(f_b_cos, f_a_cos, data->eps));
+}
+
 struct RaycastData {
   const float **looptris;
   BLI_Buffer *z_buffer;
@@ -1082,7 +1144,16 @@ bool BM_mesh_intersect(BMesh *bm,
     tree_b = tree_a;
   }
 
-  overlap = BLI_bvhtree_overlap(tree_b, tree_a, &tree_overlap_tot, NULL, NULL);
+  {
+    /* Any intersection is detected within 'eps_margin' of both triangles,
+     * double it so rounding can't reject a pair that would be cut. */
+    struct ISectOverlapData overlap_data = {
+        .looptris = looptris,
+        .eps = s.epsilon.eps_margin * 2.0f,
+    };
+    overlap = BLI_bvhtree_overlap(
+        tree_b, tree_a, &tree_overlap_tot, bm_isect_tri_tri_overlap_cb, &overlap_data);
+  }
 
   if (overlap) {
     uint i;
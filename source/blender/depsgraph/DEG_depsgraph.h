@@ -95,6 +95,11 @@ Depsgraph *DEG_graph_new(struct Main *bmain,
 /* Free Depsgraph itself and all its data */
 void DEG_graph_free(Depsgraph *graph);
 
+/* Free evaluated copies of all datablocks, keeping the nodes and relations.
+ * The next evaluation of the graph copies all datablocks again, which allows to
+ * re-use the graph without rebuilding it while not holding on to evaluated data. */
+void DEG_graph_free_evaluated_data(Depsgraph *graph);
+
 /* Node Types Registry ---------------------------- */
 
 /* Register all node types */
@@ -151,6 +156,17 @@ void DEG_ids_check_recalc(struct Main *bmain,
  */
 void DEG_evaluate_on_framechange(struct Main *bmain, Depsgraph *graph, float ctime);
 
+/* Evaluate multiple independent graphs of the same scene at different frames concurrently.
+ * Graphs are to be built already and are not allowed to be active. Used by exporters to evaluate
+ * frames ahead, so there is no frame change handlers invoked and no recalc flags of original
+ * datablocks modified.
+ * < ctimes: (frames) frame to evaluate every graph on
+ */
+void DEG_evaluate_on_framechange_multiple(struct Main *bmain,
+                                          Depsgraph **graphs,
+                                          const float *ctimes,
+                                          int num_graphs);
+
 /* Data changed recalculation entry point.
  * < context_type: context to perform evaluation for
  */
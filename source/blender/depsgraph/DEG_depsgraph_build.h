@@ -93,6 +93,14 @@ void DEG_graph_relations_update(struct Depsgraph *graph,
 /* Tag all relations in the database for update.*/
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of the given ID for update.
+ *
+ * Same as DEG_relations_tag_update(), but allows dependency graphs to only rebuild nodes and
+ * relations around the given ID instead of rebuilding everything. Only use it when nothing but
+ * the ID itself changed (its modifiers, constraints, pointers to other IDs); adding, removing or
+ * relinking IDs requires a full update. */
+void DEG_relations_tag_update_id(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /* Handle for components to define their dependencies from callbacks.
@@ -63,6 +63,15 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* Record a timeline of evaluated operations (start and end time, thread, ID and component) of
+ * all following evaluations, until DEG_debug_trace_end() is called. Starting discards previously
+ * recorded events. */
+void DEG_debug_trace_begin(struct Depsgraph *graph);
+void DEG_debug_trace_end(struct Depsgraph *graph);
+/* Write recorded timeline in the Chrome trace event format, which can be viewed with
+ * chrome://tracing or Perfetto. Returns false if nothing was recorded. */
+bool DEG_debug_trace_write(const struct Depsgraph *graph, FILE *stream);
+
 /* ************************************************ */
 
 /* Compare two dependency graphs. */
@@ -74,6 +83,12 @@ bool DEG_debug_graph_relations_validate(struct Depsgraph *graph,
                                         struct Scene *scene,
                                         struct ViewLayer *view_layer);
 
+/* Compare operations, relations, evaluation flags and custom data masks of the graph against a
+ * reference graph built from scratch, differences are printed. IDs which are only in the graph
+ * (not used anymore) are ignored. */
+bool DEG_debug_graph_relations_compare(const struct Depsgraph *graph,
+                                       const struct Depsgraph *reference_graph);
+
 /* Perform consistency check on the graph. */
 bool DEG_debug_consistency_check(struct Depsgraph *graph);
 
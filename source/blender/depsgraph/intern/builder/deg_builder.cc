@@ -210,6 +210,9 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
   for (IDNode *id_node : graph->id_nodes) {
     ID *id_orig = id_node->id_orig;
     id_node->finalize_build(graph);
+    /* Pointers of the copied datablock might need to be remapped after relations update, so never
+     * do partial copy-on-write update of the re-tagged IDs. */
+    id_node->tag_cow_update_component(NodeType::COPY_ON_WRITE);
     int flag = 0;
     /* Tag rebuild if special evaluation flags changed. */
     if (id_node->eval_flags != id_node->previous_eval_flags) {
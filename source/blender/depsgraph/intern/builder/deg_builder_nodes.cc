@@ -352,6 +352,101 @@ void DepsgraphNodeBuilder::begin_build()
   BLI_gset_clear(graph_->entry_tags, NULL);
 }
 
+void DepsgraphNodeBuilder::begin_build_incremental(const set<ID *> &ids)
+{
+  /* Keep state of all IDs, so that re-adding operations to them does not reset it. */
+  id_info_hash_ = BLI_ghash_ptr_new("Depsgraph id hash");
+  for (IDNode *id_node : graph_->id_nodes) {
+    ID *id = id_node->id_orig;
+    const bool is_rebuilt = ids.find(id) != ids.end();
+    IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
+    id_info->id_cow = NULL;
+    id_info->previously_visible_components_mask = id_node->visible_components_mask;
+    id_info->previous_eval_flags = id_node->eval_flags;
+    id_info->previous_customdata_masks = id_node->customdata_masks;
+    BLI_ghash_insert(id_info_hash_, id, id_info);
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    if (is_rebuilt) {
+      /* Requested by the relations builder again. */
+      id_node->eval_flags = 0;
+      id_node->customdata_masks = DEGCustomDataMeshMasks();
+    }
+    else {
+      built_map_.tagBuild(id);
+    }
+  }
+
+  /* Forget about operations which are about to be freed. */
+  set<OperationNode *> removed_operations;
+  for (ID *id : ids) {
+    IDNode *id_node = graph_->find_id_node(id);
+    BLI_assert(id_node != NULL);
+    GHASH_FOREACH_BEGIN (ComponentNode *, comp_node, id_node->components) {
+      for (OperationNode *op_node : comp_node->operations) {
+        removed_operations.insert(op_node);
+      }
+    }
+    GHASH_FOREACH_END();
+  }
+  for (OperationNode *op_node : removed_operations) {
+    if (BLI_gset_haskey(graph_->entry_tags, op_node)) {
+      ComponentNode *comp_node = op_node->owner;
+      SavedEntryTag entry_tag;
+      entry_tag.id_orig = comp_node->owner->id_orig;
+      entry_tag.component_type = comp_node->type;
+      entry_tag.opcode = op_node->opcode;
+      entry_tag.name = op_node->name;
+      entry_tag.name_tag = op_node->name_tag;
+      saved_entry_tags_.push_back(entry_tag);
+      BLI_gset_remove(graph_->entry_tags, op_node, NULL);
+    }
+  }
+  Depsgraph::OperationNodes operations;
+  operations.reserve(graph_->operations.size());
+  for (OperationNode *op_node : graph_->operations) {
+    if (removed_operations.find(op_node) == removed_operations.end()) {
+      operations.push_back(op_node);
+    }
+  }
+  graph_->operations.swap(operations);
+
+  for (ID *id : ids) {
+    graph_->find_id_node(id)->clear_components();
+  }
+}
+
+void DepsgraphNodeBuilder::build_view_layer_incremental(Scene *scene,
+                                                        ViewLayer *view_layer,
+                                                        const set<ID *> &ids)
+{
+  view_layer_index_ = 0;
+  scene_ = scene;
+  view_layer_ = view_layer;
+  /* Base indices must match the ones of a full build, see build_view_layer(). */
+  set<ID *> ids_with_base;
+  int base_index = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+    if (need_pull_base_into_graph(base)) {
+      if (ids.find(&base->object->id) != ids.end()) {
+        build_object(base_index, base->object, DEG_ID_LINKED_DIRECTLY, true);
+        ids_with_base.insert(&base->object->id);
+      }
+      base_index++;
+    }
+  }
+  /* Objects without base, keep their previous state. */
+  for (ID *id : ids) {
+    if (ids_with_base.find(id) != ids_with_base.end()) {
+      continue;
+    }
+    BLI_assert(GS(id->name) == ID_OB);
+    IDNode *id_node = find_id_node(id);
+    build_object(-1, (Object *)id, id_node->linked_state, id_node->is_directly_visible);
+  }
+}
+
 void DepsgraphNodeBuilder::end_build()
 {
   for (const SavedEntryTag &entry_tag : saved_entry_tags_) {
@@ -96,6 +96,15 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void begin_build();
   virtual void end_build();
 
+  /* Incremental update: only nodes of the given IDs are rebuilt, nodes of all other IDs in the
+   * graph are kept as-is. Use instead of begin_build(). */
+  virtual void begin_build_incremental(const set<ID *> &ids);
+  /* Build nodes of the given objects, which are either in the view layer or indirectly
+   * used by other objects. */
+  virtual void build_view_layer_incremental(Scene *scene,
+                                            ViewLayer *view_layer,
+                                            const set<ID *> &ids);
+
   IDNode *add_id_node(ID *id);
   IDNode *find_id_node(ID *id);
   TimeSourceNode *add_time_source();
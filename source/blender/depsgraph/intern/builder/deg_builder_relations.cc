@@ -210,7 +210,10 @@ static bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(NULL), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(NULL),
+      rna_node_query_(graph, this),
+      is_incremental_build_(false)
 {
 }
 
@@ -316,6 +319,9 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       int flags)
 {
   if (timesrc && node_to) {
+    if (is_incremental_build_) {
+      flags |= RELATION_CHECK_BEFORE_ADD;
+    }
     return graph_->add_new_relation(timesrc, node_to, description, flags);
   }
   else {
@@ -337,6 +343,9 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            int flags)
 {
   if (node_from && node_to) {
+    if (is_incremental_build_) {
+      flags |= RELATION_CHECK_BEFORE_ADD;
+    }
     return graph_->add_new_relation(node_from, node_to, description, flags);
   }
   else {
@@ -444,6 +453,37 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_build_incremental(const set<ID *> &ids)
+{
+  is_incremental_build_ = true;
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (ids.find(id_node->id_orig) == ids.end()) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+}
+
+void DepsgraphRelationBuilder::build_view_layer_incremental(Scene *scene,
+                                                            ViewLayer *view_layer,
+                                                            const set<ID *> &ids)
+{
+  if (ids.find(&scene->id) != ids.end()) {
+    /* Takes care of all bases of the view layer as well. */
+    build_view_layer(scene, view_layer, DEG_ID_LINKED_DIRECTLY);
+  }
+  else {
+    scene_ = scene;
+    LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+      if (need_pull_base_into_graph(base) && ids.find(&base->object->id) != ids.end()) {
+        build_object(base, base->object);
+      }
+    }
+  }
+  for (ID *id : ids) {
+    build_id(id);
+  }
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == NULL) {
@@ -159,6 +159,13 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   void begin_build();
 
+  /* Incremental update: relations are only built for the given IDs, all other IDs are
+   * considered built already. Since relations of the given IDs to non-rebuilt IDs might still
+   * exist, relations are checked for existence before being added. Use instead of
+   * begin_build(). */
+  void begin_build_incremental(const set<ID *> &ids);
+  void build_view_layer_incremental(Scene *scene, ViewLayer *view_layer, const set<ID *> &ids);
+
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
                          const KeyTo &key_to,
@@ -352,6 +359,9 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
+
+  /* Set by begin_build_incremental(). */
+  bool is_incremental_build_;
 };
 
 struct DepsNodeHandle {
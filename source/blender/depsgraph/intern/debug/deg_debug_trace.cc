@@ -0,0 +1,185 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2019 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/debug/deg_debug_trace.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "PIL_time.h"
+
+#include "BLI_utildefines.h"
+
+#include "DEG_depsgraph_debug.h"
+
+#include "intern/depsgraph.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace DEG {
+
+DepsgraphTrace::DepsgraphTrace()
+    : start_time(PIL_check_seconds_timer()),
+      num_threads(0),
+      evaluation_start_time(0.0),
+      stage_name(NULL),
+      stage_start_time(0.0)
+{
+}
+
+void DepsgraphTrace::evaluation_begin(int num_threads)
+{
+  this->num_threads = max(this->num_threads, num_threads);
+  thread_operations.resize(this->num_threads);
+  evaluation_start_time = PIL_check_seconds_timer();
+}
+
+void DepsgraphTrace::evaluation_end(const Depsgraph *graph)
+{
+  const double end_time = PIL_check_seconds_timer();
+  for (int thread_id = 0; thread_id < num_threads; thread_id++) {
+    for (const OperationEvent &op_event : thread_operations[thread_id]) {
+      const OperationNode *op_node = op_event.op_node;
+      const ComponentNode *comp_node = op_node->owner;
+      Event event;
+      event.name = op_node->full_identifier();
+      event.category = nodeTypeAsString(comp_node->type);
+      event.id_name = comp_node->owner->name;
+      event.thread_id = thread_id;
+      event.start_time = op_event.start_time;
+      event.end_time = op_event.end_time;
+      events.push_back(event);
+    }
+    thread_operations[thread_id].clear();
+  }
+  Event event;
+  event.name = graph->debug_name.empty() ? "Evaluation" : "Evaluation " + graph->debug_name;
+  event.category = "Depsgraph";
+  event.thread_id = 0;
+  event.start_time = evaluation_start_time;
+  event.end_time = end_time;
+  events.push_back(event);
+}
+
+void DepsgraphTrace::stage_begin(const char *name)
+{
+  stage_name = name;
+  stage_start_time = PIL_check_seconds_timer();
+}
+
+void DepsgraphTrace::stage_end()
+{
+  Event event;
+  event.name = stage_name;
+  event.category = "Depsgraph";
+  event.thread_id = 0;
+  event.start_time = stage_start_time;
+  event.end_time = PIL_check_seconds_timer();
+  events.push_back(event);
+}
+
+namespace {
+
+/* Escape string for use in JSON. */
+string trace_escape(const string &str)
+{
+  string result;
+  result.reserve(str.size());
+  for (const char ch : str) {
+    if (ch == '"' || ch == '\\') {
+      result += '\\';
+      result += ch;
+    }
+    else if ((unsigned char)ch < 0x20) {
+      char buffer[8];
+      snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned char)ch);
+      result += buffer;
+    }
+    else {
+      result += ch;
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+void DepsgraphTrace::write(FILE *f) const
+{
+  /* Times are in microseconds. */
+  fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  for (int thread_id = 0; thread_id < num_threads; thread_id++) {
+    fprintf(f,
+            "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+            "\"args\": {\"name\": \"%s %d\"}},\n",
+            thread_id,
+            (thread_id == 0) ? "Evaluating Thread" : "Worker Thread",
+            thread_id);
+  }
+  bool is_first = true;
+  for (const Event &event : events) {
+    fprintf(f,
+            "%s{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+            "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"id\": \"%s\"}}",
+            is_first ? "" : ",\n",
+            trace_escape(event.name).c_str(),
+            event.category,
+            event.thread_id,
+            (event.start_time - start_time) * 1e6,
+            (event.end_time - event.start_time) * 1e6,
+            trace_escape(event.id_name).c_str());
+    is_first = false;
+  }
+  fprintf(f, "\n]}\n");
+}
+
+}  // namespace DEG
+
+void DEG_debug_trace_begin(Depsgraph *depsgraph)
+{
+  DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(depsgraph);
+  BLI_assert(!deg_graph->debug_is_evaluating);
+  if (deg_graph->trace == NULL) {
+    deg_graph->trace = OBJECT_GUARDED_NEW(DEG::DepsgraphTrace);
+  }
+  else {
+    *deg_graph->trace = DEG::DepsgraphTrace();
+  }
+  deg_graph->is_trace_recording = true;
+}
+
+void DEG_debug_trace_end(Depsgraph *depsgraph)
+{
+  DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(depsgraph);
+  deg_graph->is_trace_recording = false;
+}
+
+bool DEG_debug_trace_write(const Depsgraph *depsgraph, FILE *f)
+{
+  const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(depsgraph);
+  if (deg_graph->trace == NULL) {
+    return false;
+  }
+  deg_graph->trace->write(f);
+  return true;
+}
@@ -0,0 +1,86 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2019 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Timeline of evaluated operations, for exporting in the Chrome trace event format.
+ */
+
+#pragma once
+
+#include "intern/depsgraph_type.h"
+
+namespace DEG {
+
+struct Depsgraph;
+struct OperationNode;
+
+struct DepsgraphTrace {
+  /* Operation evaluated during the current evaluation. Only pointer to the node is stored, so
+   * recording does not slow down evaluation; names are copied once evaluation is finished. */
+  struct OperationEvent {
+    const OperationNode *op_node;
+    double start_time;
+    double end_time;
+  };
+
+  struct Event {
+    string name;
+    /* Static string. */
+    const char *category;
+    string id_name;
+    int thread_id;
+    double start_time;
+    double end_time;
+  };
+
+  DepsgraphTrace();
+
+  /* Called from the thread which evaluates the graph, before any operation is scheduled. */
+  void evaluation_begin(int num_threads);
+  void evaluation_end(const Depsgraph *graph);
+  void stage_begin(const char *name);
+  void stage_end();
+
+  /* Thread-safe, as long as every thread uses its own thread ID. */
+  void add_operation(int thread_id,
+                     const OperationNode *op_node,
+                     double start_time,
+                     double end_time)
+  {
+    OperationEvent event = {op_node, start_time, end_time};
+    thread_operations[thread_id].push_back(event);
+  }
+
+  /* Write all recorded events as Chrome trace JSON. */
+  void write(FILE *f) const;
+
+  /* Time when recording started, events are written relative to it. */
+  double start_time;
+  int num_threads;
+  vector<vector<OperationEvent>> thread_operations;
+  vector<Event> events;
+
+  double evaluation_start_time;
+  const char *stage_name;
+  double stage_start_time;
+};
+
+}  // namespace DEG
@@ -46,8 +46,10 @@ extern "C" {
 
 #include "intern/depsgraph_update.h"
 #include "intern/depsgraph_physics.h"
+#include "intern/depsgraph_tag.h"
 #include "intern/depsgraph_registry.h"
 
+#include "intern/debug/deg_debug_trace.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 
 #include "intern/node/deg_node.h"
@@ -68,6 +70,7 @@ template<typename T> static void remove_from_vector(vector<T> *vector, const T &
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(NULL),
       need_update(true),
+      need_update_all_relations(true),
       need_update_time(false),
       bmain(bmain),
       scene(scene),
@@ -77,6 +80,8 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
       scene_cow(NULL),
       is_active(false),
       debug_is_evaluating(false),
+      trace(NULL),
+      is_trace_recording(false),
       is_render_pipeline_depsgraph(false)
 {
   BLI_spin_init(&lock);
@@ -96,6 +101,7 @@ Depsgraph::~Depsgraph()
   if (time_source != NULL) {
     OBJECT_GUARDED_DELETE(time_source, TimeSourceNode);
   }
+  OBJECT_GUARDED_DELETE(trace, DepsgraphTrace);
   BLI_spin_end(&lock);
 }
 
@@ -172,10 +178,38 @@ void Depsgraph::clear_id_nodes()
   /* Clear containers. */
   BLI_ghash_clear(id_hash, NULL, NULL);
   id_nodes.clear();
+  /* Clear scheduling order, it points to the freed operations. */
+  critical_path_operations.clear();
+  critical_path_outlinks.clear();
   /* Clear physics relation caches. */
   clear_physics_relations(this);
 }
 
+void Depsgraph::free_evaluated_data_conditional(
+    const std::function<bool(ID_Type id_type)> &filter)
+{
+  for (IDNode *id_node : id_nodes) {
+    if (id_node->id_cow == NULL || id_node->id_cow == id_node->id_orig) {
+      continue;
+    }
+    if (!deg_copy_on_write_is_expanded(id_node->id_cow)) {
+      continue;
+    }
+    const ID_Type id_type = GS(id_node->id_cow->name);
+    if (filter(id_type)) {
+      deg_free_copy_on_write_datablock(id_node->id_cow);
+    }
+  }
+}
+
+void Depsgraph::free_evaluated_data()
+{
+  /* Same order as in clear_id_nodes(): freeing objects accesses their particle settings. */
+  free_evaluated_data_conditional([](ID_Type id_type) { return id_type == ID_SCE; });
+  free_evaluated_data_conditional([](ID_Type id_type) { return id_type != ID_PA; });
+  free_evaluated_data_conditional([](ID_Type id_type) { return id_type == ID_PA; });
+}
+
 /* Add new relation between two nodes */
 Relation *Depsgraph::add_new_relation(Node *from, Node *to, const char *description, int flags)
 {
@@ -334,6 +368,25 @@ void DEG_graph_free(Depsgraph *graph)
   OBJECT_GUARDED_DELETE(deg_depsgraph, Depsgraph);
 }
 
+void DEG_graph_free_evaluated_data(Depsgraph *graph)
+{
+  DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
+  BLI_assert(!deg_graph->debug_is_evaluating);
+  deg_graph->free_evaluated_data();
+  for (DEG::IDNode *id_node : deg_graph->id_nodes) {
+    if (id_node->id_cow == id_node->id_orig) {
+      continue;
+    }
+    /* Same tags as for an ID which is added to the graph for the first time. */
+    int flag = ID_RECALC_COPY_ON_WRITE;
+    if (GS(id_node->id_orig->name) == ID_OB) {
+      flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
+    }
+    DEG::graph_id_tag_update(
+        deg_graph->bmain, deg_graph, id_node->id_orig, flag, DEG::DEG_UPDATE_SOURCE_RELATIONS);
+  }
+}
+
 bool DEG_is_active(const struct Depsgraph *depsgraph)
 {
   if (depsgraph == NULL) {
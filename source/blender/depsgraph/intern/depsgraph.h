@@ -50,6 +50,7 @@ struct ViewLayer;
 
 namespace DEG {
 
+struct DepsgraphTrace;
 struct IDNode;
 struct Node;
 struct OperationNode;
@@ -111,6 +112,10 @@ struct Depsgraph {
   void clear_id_nodes();
   void clear_id_nodes_conditional(const std::function<bool(ID_Type id_type)> &filter);
 
+  /* Free evaluated copies of all IDs, keeping the nodes and relations. */
+  void free_evaluated_data();
+  void free_evaluated_data_conditional(const std::function<bool(ID_Type id_type)> &filter);
+
   /* Add new relationship between two nodes. */
   Relation *add_new_relation(Node *from, Node *to, const char *description, int flags = 0);
 
@@ -147,6 +152,11 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* IDs which relations were tagged for update with DEG_relations_tag_update_id(), allows
+   * incremental update of the relations. Not used when #need_update_all_relations is set. */
+  set<ID *> id_relations_update;
+  bool need_update_all_relations;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
 
@@ -168,6 +178,13 @@ struct Depsgraph {
   /* All operation nodes, sorted in order of single-thread traversal order. */
   OperationNodes operations;
 
+  /* Order in which operations are scheduled when evaluating on multiple threads, most critical
+   * first, see deg_eval.cc. Children of every operation are stored in #critical_path_outlinks,
+   * starting at #OperationNode.critical_path_outlinks_index. Cleared when relations are built,
+   * calculated again by the next evaluation. */
+  OperationNodes critical_path_operations;
+  vector<Relation *> critical_path_outlinks;
+
   /* Spin lock for threading-critical operations.
    * Mainly used by graph evaluation. */
   SpinLock lock;
@@ -200,6 +217,11 @@ struct Depsgraph {
 
   bool debug_is_evaluating;
 
+  /* Timeline of evaluated operations, see DEG_debug_trace_begin(). Kept after recording has
+   * ended, so it can be written out. */
+  DepsgraphTrace *trace;
+  bool is_trace_recording;
+
   /* Is set to truth for dependency graph which are used for post-processing (compositor and
    * sequencer).
    * Such dependency graph needs all view layers (so render pipeline can access names), but it
@@ -34,9 +34,13 @@
 
 extern "C" {
 #include "DNA_cachefile_types.h"
+#include "DNA_modifier_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
 
+#include "BKE_collision.h"
+#include "BKE_effect.h"
+#include "BKE_library_query.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
 } /* extern "C" */
@@ -220,8 +224,13 @@ static void graph_build_finalize_common(DEG::Depsgraph *deg_graph, Main *bmain)
     abort();
   }
 #endif
+  /* Scheduling order is calculated again from the new relations on the next evaluation. */
+  deg_graph->critical_path_operations.clear();
+  deg_graph->critical_path_outlinks.clear();
   /* Relations are up to date. */
   deg_graph->need_update = false;
+  deg_graph->need_update_all_relations = false;
+  deg_graph->id_relations_update.clear();
 }
 
 /* Build depsgraph for the given scene layer, and dump results in given graph container. */
@@ -465,12 +474,289 @@ void DEG_graph_build_from_ids(Depsgraph *graph,
   }
 }
 
+/* Incremental relations update.
+ *
+ * When relations of only a few objects changed (for example, a modifier or constraint was added
+ * or removed) only nodes of those objects are rebuilt, relations are rebuilt for them and their
+ * direct neighbours. Everything else is kept from the previous build.
+ *
+ * Some setups have relations which are not local to the object and its neighbours (proxies,
+ * physics and rigid body simulations, set scenes), those fall back to a full rebuild. So do
+ * updates where the rebuilt IDs stop referencing an ID which is not directly linked into the
+ * graph, since that ID might not be used by anything anymore.
+ *
+ * Use `--debug-depsgraph-validate` to compare the result against a full rebuild. */
+
+namespace DEG {
+namespace {
+
+bool physics_relations_use_object(const Depsgraph *deg_graph, const Object *object)
+{
+  for (int i = 0; i < DEG_PHYSICS_RELATIONS_NUM; i++) {
+    if (deg_graph->physics_relations[i] == NULL) {
+      continue;
+    }
+    GHASH_FOREACH_BEGIN (ListBase *, relations, deg_graph->physics_relations[i]) {
+      if (i == DEG_PHYSICS_EFFECTOR) {
+        LISTBASE_FOREACH (EffectorRelation *, relation, relations) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+      else {
+        LISTBASE_FOREACH (CollisionRelation *, relation, relations) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+    }
+    GHASH_FOREACH_END();
+  }
+  return false;
+}
+
+bool object_supports_incremental_update(const Depsgraph *deg_graph, const Object *object)
+{
+  if (object->proxy != NULL || object->proxy_from != NULL || object->proxy_group != NULL) {
+    return false;
+  }
+  if (object->rigidbody_object != NULL || object->rigidbody_constraint != NULL) {
+    return false;
+  }
+  /* Effectors and colliders are gathered into collection-wide relations. */
+  if (object->pd != NULL || !BLI_listbase_is_empty(&object->particlesystem)) {
+    return false;
+  }
+  LISTBASE_FOREACH (ModifierData *, md, &object->modifiers) {
+    if (ELEM(md->type,
+             eModifierType_Collision,
+             eModifierType_Fluidsim,
+             eModifierType_Smoke,
+             eModifierType_DynamicPaint)) {
+      return false;
+    }
+  }
+  return !physics_relations_use_object(deg_graph, object);
+}
+
+bool graph_supports_incremental_update(const Depsgraph *deg_graph, const set<ID *> &ids)
+{
+  if (deg_graph->need_update_all_relations || ids.empty() || deg_graph->id_nodes.empty() ||
+      deg_graph->is_render_pipeline_depsgraph || deg_graph->scene->set != NULL) {
+    return false;
+  }
+  for (ID *id : ids) {
+    if (GS(id->name) != ID_OB || deg_graph->find_id_node(id) == NULL) {
+      return false;
+    }
+    if (!object_supports_incremental_update(deg_graph, (Object *)id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ID *node_owner_id(const Node *node)
+{
+  switch (node->get_class()) {
+    case NodeClass::OPERATION:
+      return static_cast<const OperationNode *>(node)->owner->owner->id_orig;
+    case NodeClass::COMPONENT:
+      return static_cast<const ComponentNode *>(node)->owner->id_orig;
+    case NodeClass::GENERIC:
+      break;
+  }
+  return NULL;
+}
+
+void node_collect_neighbour_ids(const Node *node, const set<ID *> &ids, set<ID *> &r_neighbours)
+{
+  for (const Relation *rel : node->inlinks) {
+    ID *id = node_owner_id(rel->from);
+    if (id != NULL && ids.find(id) == ids.end()) {
+      r_neighbours.insert(id);
+    }
+  }
+  for (const Relation *rel : node->outlinks) {
+    ID *id = node_owner_id(rel->to);
+    if (id != NULL && ids.find(id) == ids.end()) {
+      r_neighbours.insert(id);
+    }
+  }
+}
+
+/* IDs which have relations from or to operations of the given IDs. */
+set<ID *> graph_collect_neighbour_ids(const Depsgraph *deg_graph, const set<ID *> &ids)
+{
+  set<ID *> neighbours;
+  for (ID *id : ids) {
+    const IDNode *id_node = deg_graph->find_id_node(id);
+    GHASH_FOREACH_BEGIN (const ComponentNode *, comp_node, id_node->components) {
+      node_collect_neighbour_ids(comp_node, ids, neighbours);
+      for (const OperationNode *op_node : comp_node->operations) {
+        node_collect_neighbour_ids(op_node, ids, neighbours);
+      }
+    }
+    GHASH_FOREACH_END();
+  }
+  return neighbours;
+}
+
+int foreach_libblock_collect_callback(void *user_data,
+                                      ID * /*id_self*/,
+                                      ID **id_p,
+                                      int /*cb_flag*/)
+{
+  set<ID *> *used_ids = reinterpret_cast<set<ID *> *>(user_data);
+  if (*id_p != NULL) {
+    used_ids->insert(*id_p);
+  }
+  return IDWALK_RET_NOP;
+}
+
+/* Garbage collecting unused nodes needs the full reachability information, so an update which
+ * could drop IDs from the graph is left to the full rebuild (which keeps the evaluated copies of
+ * the IDs). Decided before the graph is touched: neighbours stay in a full build when they are
+ * linked directly, or still used by the rebuilt IDs or by neighbours which stay. */
+bool graph_neighbours_stay_used(const Depsgraph *deg_graph,
+                                Main *bmain,
+                                const set<ID *> &ids,
+                                const set<ID *> &neighbour_ids)
+{
+  set<ID *> pending_ids;
+  vector<ID *> used_queue(ids.begin(), ids.end());
+  for (ID *id : neighbour_ids) {
+    const IDNode *id_node = deg_graph->find_id_node(id);
+    if (id_node->linked_state == DEG_ID_LINKED_DIRECTLY) {
+      used_queue.push_back(id);
+    }
+    else {
+      pending_ids.insert(id);
+    }
+  }
+  while (!pending_ids.empty() && !used_queue.empty()) {
+    ID *id = used_queue.back();
+    used_queue.pop_back();
+    set<ID *> used_ids;
+    BKE_library_foreach_ID_link(
+        bmain, id, foreach_libblock_collect_callback, &used_ids, IDWALK_READONLY);
+    for (ID *used_id : used_ids) {
+      if (pending_ids.erase(used_id) != 0) {
+        used_queue.push_back(used_id);
+      }
+    }
+  }
+  return pending_ids.empty();
+}
+
+/* Returns false if the graph needs to be fully rebuilt instead. */
+bool graph_build_incremental(Depsgraph *deg_graph,
+                             Main *bmain,
+                             Scene *scene,
+                             ViewLayer *view_layer)
+{
+  const set<ID *> ids = deg_graph->id_relations_update;
+  if (!graph_supports_incremental_update(deg_graph, ids)) {
+    return false;
+  }
+  /* Collect neighbours before their relations to the rebuilt IDs are freed. */
+  const set<ID *> neighbour_ids = graph_collect_neighbour_ids(deg_graph, ids);
+  if (!graph_neighbours_stay_used(deg_graph, bmain, ids, neighbour_ids)) {
+    DEG_GLOBAL_DEBUG_PRINTF(BUILD, "Incremental relations update could remove references.\n");
+    return false;
+  }
+  /* Evaluation flags and custom data masks of neighbour objects are requested by relations of the
+   * IDs around them, which includes the rebuilt IDs. Rebuild relations of all those IDs, so the
+   * requests are gathered again from scratch. */
+  set<ID *> neighbour_object_ids;
+  for (ID *id : neighbour_ids) {
+    if (GS(id->name) == ID_OB) {
+      neighbour_object_ids.insert(id);
+    }
+  }
+  const set<ID *> neighbour_user_ids = graph_collect_neighbour_ids(deg_graph,
+                                                                   neighbour_object_ids);
+  set<ID *> previous_ids;
+  for (IDNode *id_node : deg_graph->id_nodes) {
+    previous_ids.insert(id_node->id_orig);
+  }
+  DepsgraphBuilderCache builder_cache;
+  /* Rebuild nodes of the tagged IDs, plus IDs which they start to use. */
+  DepsgraphNodeBuilder node_builder(bmain, deg_graph, &builder_cache);
+  node_builder.begin_build_incremental(ids);
+  for (ID *id : neighbour_object_ids) {
+    IDNode *id_node = deg_graph->find_id_node(id);
+    id_node->eval_flags = 0;
+    id_node->customdata_masks = DEGCustomDataMeshMasks();
+  }
+  node_builder.build_view_layer_incremental(scene, view_layer, ids);
+  node_builder.end_build();
+  set<ID *> new_ids;
+  for (IDNode *id_node : deg_graph->id_nodes) {
+    if (previous_ids.find(id_node->id_orig) == previous_ids.end()) {
+      new_ids.insert(id_node->id_orig);
+    }
+  }
+  /* Rebuild relations of the rebuilt IDs and all the IDs which had relations to them. */
+  set<ID *> relation_ids = ids;
+  relation_ids.insert(neighbour_ids.begin(), neighbour_ids.end());
+  relation_ids.insert(neighbour_user_ids.begin(), neighbour_user_ids.end());
+  relation_ids.insert(new_ids.begin(), new_ids.end());
+  DepsgraphRelationBuilder relation_builder(bmain, deg_graph, &builder_cache);
+  relation_builder.begin_build_incremental(relation_ids);
+  relation_builder.build_view_layer_incremental(scene, view_layer, relation_ids);
+  for (IDNode *id_node : deg_graph->id_nodes) {
+    if (ids.find(id_node->id_orig) != ids.end() ||
+        new_ids.find(id_node->id_orig) != new_ids.end()) {
+      relation_builder.build_copy_on_write_relations(id_node);
+    }
+  }
+  /* Visibility and cycles are detected from scratch, since relations they were based on could
+   * be gone. */
+  for (IDNode *id_node : deg_graph->id_nodes) {
+    GHASH_FOREACH_BEGIN (ComponentNode *, comp_node, id_node->components) {
+      comp_node->affects_directly_visible = false;
+    }
+    GHASH_FOREACH_END();
+  }
+  for (OperationNode *op_node : deg_graph->operations) {
+    for (Relation *rel : op_node->inlinks) {
+      rel->flag &= ~RELATION_FLAG_CYCLIC;
+    }
+  }
+  DEG_GLOBAL_DEBUG_PRINTF(BUILD,
+                          "Incremental relations update of %d IDs, %d neighbours, %d new IDs.\n",
+                          (int)ids.size(),
+                          (int)neighbour_ids.size(),
+                          (int)new_ids.size());
+  return true;
+}
+
+void graph_build_validate(Depsgraph *deg_graph, Main *bmain, Scene *scene, ViewLayer *view_layer)
+{
+  Depsgraph *reference_graph = OBJECT_GUARDED_NEW(
+      Depsgraph, bmain, scene, view_layer, deg_graph->mode);
+  DEG_graph_build_from_view_layer(
+      reinterpret_cast<::Depsgraph *>(reference_graph), bmain, scene, view_layer);
+  if (!DEG_debug_graph_relations_compare(reinterpret_cast<::Depsgraph *>(deg_graph),
+                                         reinterpret_cast<::Depsgraph *>(reference_graph))) {
+    fprintf(stderr, "ERROR! Incremental relations update differs from a full rebuild.\n");
+  }
+  OBJECT_GUARDED_DELETE(reference_graph, Depsgraph);
+}
+
+}  // namespace
+}  // namespace DEG
+
 /* Tag graph relations for update. */
 void DEG_graph_tag_relations_update(Depsgraph *graph)
 {
   DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
   DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
   deg_graph->need_update = true;
+  deg_graph->need_update_all_relations = true;
   /* NOTE: When relations are updated, it's quite possible that
    * we've got new bases in the scene. This means, we need to
    * re-create flat array of bases in view layer.
@@ -491,7 +777,21 @@ void DEG_graph_relations_update(Depsgraph *graph, Main *bmain, Scene *scene, Vie
     /* Graph is up to date, nothing to do. */
     return;
   }
-  DEG_graph_build_from_view_layer(graph, bmain, scene, view_layer);
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = PIL_check_seconds_timer();
+  }
+  if (!DEG::graph_build_incremental(deg_graph, bmain, scene, view_layer)) {
+    DEG_graph_build_from_view_layer(graph, bmain, scene, view_layer);
+    return;
+  }
+  graph_build_finalize_common(deg_graph, bmain);
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph relations updated in %f seconds.\n", PIL_check_seconds_timer() - start_time);
+  }
+  if (G.debug & G_DEBUG_DEPSGRAPH_VALIDATE) {
+    DEG::graph_build_validate(deg_graph, bmain, scene, view_layer);
+  }
 }
 
 /* Tag all relations for update. */
@@ -502,3 +802,17 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+/* Tag relations of a single ID for update. */
+void DEG_relations_tag_update_id(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (DEG::Depsgraph *deg_graph : DEG::get_all_registered_graphs(bmain)) {
+    if (!deg_graph->need_update_all_relations && deg_graph->find_id_node(id) == NULL) {
+      /* Relations between IDs of this graph did not change. */
+      continue;
+    }
+    deg_graph->need_update = true;
+    deg_graph->id_relations_update.insert(id);
+  }
+}
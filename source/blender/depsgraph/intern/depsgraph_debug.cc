@@ -42,6 +42,7 @@ extern "C" {
 #include "intern/debug/deg_debug.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
 #include "intern/node/deg_node_time.h"
 
 void DEG_debug_flags_set(Depsgraph *depsgraph, int flags)
@@ -103,6 +104,144 @@ bool DEG_debug_graph_relations_validate(Depsgraph *graph,
   return valid;
 }
 
+namespace DEG {
+namespace {
+
+string debug_node_key(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return node->identifier();
+  }
+  const OperationNode *op_node = static_cast<const OperationNode *>(node);
+  return string(nodeTypeAsString(op_node->owner->type)) + " " +
+         op_node->full_identifier() + "[" + to_string(op_node->name_tag) + "]";
+}
+
+string debug_relation_key(const Relation *rel)
+{
+  return debug_node_key(rel->from) + " -> " + debug_node_key(rel->to) + " (" + rel->name + ")";
+}
+
+/* Collect keys of all operations and relations of IDs which are accepted by the filter. */
+template<typename FilterFunc>
+void debug_graph_collect_keys(const Depsgraph *deg_graph,
+                              FilterFunc filter,
+                              set<string> &r_operations,
+                              set<string> &r_relations)
+{
+  for (const OperationNode *op_node : deg_graph->operations) {
+    if (!filter(op_node)) {
+      continue;
+    }
+    r_operations.insert(debug_node_key(op_node));
+    for (const Relation *rel : op_node->inlinks) {
+      if (rel->from->type == NodeType::OPERATION &&
+          !filter(static_cast<const OperationNode *>(rel->from))) {
+        continue;
+      }
+      r_relations.insert(debug_relation_key(rel));
+    }
+  }
+}
+
+int debug_print_keys_difference(const set<string> &keys,
+                                const set<string> &reference_keys,
+                                const char *message)
+{
+  int num_differences = 0;
+  for (const string &key : keys) {
+    if (reference_keys.find(key) == reference_keys.end()) {
+      fprintf(stderr, "%s: %s\n", message, key.c_str());
+      num_differences++;
+    }
+  }
+  return num_differences;
+}
+
+/* Compare the evaluation state which relations request on the IDs of both graphs. */
+int debug_print_id_state_difference(const Depsgraph *deg_graph,
+                                    const Depsgraph *deg_reference_graph)
+{
+  int num_differences = 0;
+  for (const IDNode *reference_id_node : deg_reference_graph->id_nodes) {
+    const IDNode *id_node = deg_graph->find_id_node(reference_id_node->id_orig);
+    if (id_node == NULL) {
+      /* Reported as missing operations. */
+      continue;
+    }
+    if (id_node->eval_flags != reference_id_node->eval_flags) {
+      fprintf(stderr,
+              "Different evaluation flags: %s (0x%x, expected 0x%x)\n",
+              id_node->id_orig->name,
+              id_node->eval_flags,
+              reference_id_node->eval_flags);
+      num_differences++;
+    }
+    const DEGCustomDataMeshMasks &masks = id_node->customdata_masks;
+    const DEGCustomDataMeshMasks &reference_masks = reference_id_node->customdata_masks;
+    if (masks != reference_masks) {
+      fprintf(stderr,
+              "Different custom data masks: %s "
+              "(vert 0x%llx, edge 0x%llx, face 0x%llx, loop 0x%llx, poly 0x%llx, "
+              "expected vert 0x%llx, edge 0x%llx, face 0x%llx, loop 0x%llx, poly 0x%llx)\n",
+              id_node->id_orig->name,
+              (unsigned long long)masks.vert_mask,
+              (unsigned long long)masks.edge_mask,
+              (unsigned long long)masks.face_mask,
+              (unsigned long long)masks.loop_mask,
+              (unsigned long long)masks.poly_mask,
+              (unsigned long long)reference_masks.vert_mask,
+              (unsigned long long)reference_masks.edge_mask,
+              (unsigned long long)reference_masks.face_mask,
+              (unsigned long long)reference_masks.loop_mask,
+              (unsigned long long)reference_masks.poly_mask);
+      num_differences++;
+    }
+  }
+  return num_differences;
+}
+
+}  // namespace
+}  // namespace DEG
+
+bool DEG_debug_graph_relations_compare(const Depsgraph *graph, const Depsgraph *reference_graph)
+{
+  const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+  const DEG::Depsgraph *deg_reference_graph = reinterpret_cast<const DEG::Depsgraph *>(
+      reference_graph);
+  /* IDs which are not used anymore are allowed to stay in the graph, they are only reported. */
+  int num_unused_ids = 0;
+  for (const DEG::IDNode *id_node : deg_graph->id_nodes) {
+    if (deg_reference_graph->find_id_node(id_node->id_orig) == NULL) {
+      num_unused_ids++;
+    }
+  }
+  auto is_used_id_operation = [deg_reference_graph](const DEG::OperationNode *op_node) {
+    return deg_reference_graph->find_id_node(op_node->owner->owner->id_orig) != NULL;
+  };
+  auto is_any_operation = [](const DEG::OperationNode * /*op_node*/) { return true; };
+  DEG::set<DEG::string> operations, relations;
+  DEG::set<DEG::string> reference_operations, reference_relations;
+  DEG::debug_graph_collect_keys(deg_graph, is_used_id_operation, operations, relations);
+  DEG::debug_graph_collect_keys(
+      deg_reference_graph, is_any_operation, reference_operations, reference_relations);
+  int num_differences = 0;
+  num_differences += DEG::debug_print_keys_difference(
+      reference_operations, operations, "Missing operation");
+  num_differences += DEG::debug_print_keys_difference(
+      operations, reference_operations, "Unexpected operation");
+  num_differences += DEG::debug_print_keys_difference(
+      reference_relations, relations, "Missing relation");
+  num_differences += DEG::debug_print_keys_difference(
+      relations, reference_relations, "Unexpected relation");
+  num_differences += DEG::debug_print_id_state_difference(deg_graph, deg_reference_graph);
+  if (num_unused_ids != 0) {
+    printf("Depsgraph has %d unused IDs which will be removed on the next full rebuild.\n",
+           num_unused_ids);
+  }
+  return num_differences == 0;
+}
+
 bool DEG_debug_consistency_check(Depsgraph *graph)
 {
   const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
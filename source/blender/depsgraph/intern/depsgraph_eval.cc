@@ -28,6 +28,7 @@
 #include "BLI_listbase.h"
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
 
 extern "C" {
 #include "BKE_scene.h"
@@ -84,6 +85,50 @@ void DEG_evaluate_on_framechange(Main *bmain, Depsgraph *graph, float ctime)
   deg_graph->need_update_time = false;
 }
 
+namespace {
+
+struct FrameChangeMultipleData {
+  Main *bmain;
+  Depsgraph **graphs;
+  const float *ctimes;
+};
+
+void deg_evaluate_on_framechange_multiple_func(void *__restrict data_v,
+                                               const int i,
+                                               const TaskParallelTLS *__restrict /*tls*/)
+{
+  FrameChangeMultipleData *data = (FrameChangeMultipleData *)data_v;
+  Depsgraph *graph = data->graphs[i];
+  DEG_evaluate_on_framechange(data->bmain, graph, data->ctimes[i]);
+  DEG_ids_clear_recalc(data->bmain, graph);
+}
+
+}  // namespace
+
+void DEG_evaluate_on_framechange_multiple(Main *bmain,
+                                          Depsgraph **graphs,
+                                          const float *ctimes,
+                                          int num_graphs)
+{
+#ifndef NDEBUG
+  for (int i = 0; i < num_graphs; i++) {
+    BLI_assert(!reinterpret_cast<DEG::Depsgraph *>(graphs[i])->is_active);
+  }
+#endif
+  FrameChangeMultipleData data;
+  data.bmain = bmain;
+  data.graphs = graphs;
+  data.ctimes = ctimes;
+  /* Every graph is evaluated with its own task pool, which uses all threads already. Having
+   * multiple graphs evaluated at once keeps threads busy when graphs are dominated by a long
+   * chain of dependent operations. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, num_graphs, &data, deg_evaluate_on_framechange_multiple_func, &settings);
+}
+
 bool DEG_needs_eval(Depsgraph *graph)
 {
   DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
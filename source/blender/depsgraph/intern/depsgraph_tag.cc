@@ -265,10 +265,22 @@ void depsgraph_update_editors_tag(Main *bmain, Depsgraph *graph, ID *id)
   deg_editors_id_update(&update_ctx, id);
 }
 
-void depsgraph_id_tag_copy_on_write(Depsgraph *graph, IDNode *id_node, eUpdateSource update_source)
+/* Tag copy-on-write update of the ID, caused by an update of the given component. */
+void depsgraph_id_tag_copy_on_write(Depsgraph *graph,
+                                    IDNode *id_node,
+                                    NodeType component_type,
+                                    eUpdateSource update_source)
 {
   ComponentNode *cow_comp = id_node->find_component(NodeType::COPY_ON_WRITE);
-  cow_comp->tag_update(graph, update_source);
+  OperationNode *cow_op = cow_comp->get_entry_operation();
+  if (component_type == NodeType::COPY_ON_WRITE || cow_op == NULL) {
+    cow_comp->tag_update(graph, update_source);
+    return;
+  }
+  /* Tag the operation directly, so that the copy-on-write evaluation knows it only needs to
+   * update parts of the datablock affected by the component. */
+  id_node->tag_cow_update_component(component_type);
+  cow_op->tag_update(graph, update_source);
 }
 
 void depsgraph_tag_component(Depsgraph *graph,
@@ -283,7 +295,7 @@ void depsgraph_tag_component(Depsgraph *graph,
    * here. */
   if (component_node == NULL) {
     if (component_type == NodeType::ANIMATION) {
-      depsgraph_id_tag_copy_on_write(graph, id_node, update_source);
+      depsgraph_id_tag_copy_on_write(graph, id_node, component_type, update_source);
     }
     return;
   }
@@ -298,7 +310,7 @@ void depsgraph_tag_component(Depsgraph *graph,
   }
   /* If component depends on copy-on-write, tag it as well. */
   if (component_node->need_tag_cow_before_update()) {
-    depsgraph_id_tag_copy_on_write(graph, id_node, update_source);
+    depsgraph_id_tag_copy_on_write(graph, id_node, component_type, update_source);
   }
 }
 
@@ -31,6 +31,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_task.h"
 #include "BLI_ghash.h"
+#include "BLI_stack.h"
 
 #include "BKE_global.h"
 
@@ -42,6 +43,7 @@
 
 #include "atomic_ops.h"
 
+#include "intern/debug/deg_debug_trace.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/eval/deg_eval_flush.h"
 #include "intern/eval/deg_eval_stats.h"
@@ -66,9 +68,22 @@ static void schedule_children(TaskPool *pool,
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
+  /* Schedule operations on the critical path first, based on timing of previous evaluations.
+   * Only makes difference when evaluating on multiple threads. */
+  bool do_critical_path_scheduling;
+  /* Time every operation, for the statistics or to calculate the critical path. */
+  bool do_timing;
+  /* Pool is suspended while the initially ready operations are scheduled. */
+  bool is_pool_suspended;
+  /* Timeline recorder, NULL unless trace recording is enabled. */
+  DepsgraphTrace *trace;
   bool is_cow_stage;
 };
 
+/* Rough overhead of scheduling an operation, in seconds. Used as the cost of operations which
+ * were not timed yet, so the longest chain of operations is picked first. */
+static const double operation_schedule_overhead = 1e-6;
+
 static void deg_task_run_func(TaskPool *pool, void *taskdata, int thread_id)
 {
   void *userdata_v = BLI_task_pool_userdata(pool);
@@ -77,10 +92,14 @@ static void deg_task_run_func(TaskPool *pool, void *taskdata, int thread_id)
   /* Sanity checks. */
   BLI_assert(!node->is_noop() && "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
-  if (state->do_stats) {
+  if (state->do_timing) {
     const double start_time = PIL_check_seconds_timer();
     node->evaluate((::Depsgraph *)state->graph);
-    node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    const double end_time = PIL_check_seconds_timer();
+    node->stats.current_time += end_time - start_time;
+    if (state->trace != NULL) {
+      state->trace->add_operation(thread_id, node, start_time, end_time);
+    }
   }
   else {
     node->evaluate((::Depsgraph *)state->graph);
@@ -154,18 +173,121 @@ static void calculate_pending_parents(Depsgraph *graph)
   BLI_task_parallel_range(0, num_operations, &data, calculate_pending_func, &settings);
 }
 
+static bool check_operation_node_pending(OperationNode *op_node)
+{
+  return (op_node->flag & DEPSOP_FLAG_NEEDS_UPDATE) && check_operation_node_visible(op_node);
+}
+
+static bool check_relation_pending(Relation *rel)
+{
+  return rel->from->type == NodeType::OPERATION && rel->to->type == NodeType::OPERATION &&
+         (rel->flag & RELATION_FLAG_CYCLIC) == 0;
+}
+
+static bool compare_relations_critical_path(const Relation *a, const Relation *b)
+{
+  return ((OperationNode *)a->to)->critical_path_time >
+         ((OperationNode *)b->to)->critical_path_time;
+}
+
+static bool compare_operations_critical_path(const OperationNode *a, const OperationNode *b)
+{
+  return a->critical_path_time > b->critical_path_time;
+}
+
+/* Calculate critical path time of all operations from their average evaluation time, by
+ * traversing the graph from the last operations to be evaluated towards the first ones. The
+ * scheduling order of operations and of children of every operation is stored in the graph, so
+ * it is only calculated once after relations are built. */
+static void calculate_critical_path(Depsgraph *graph)
+{
+  BLI_Stack *stack = BLI_stack_new(sizeof(OperationNode *), "DEG critical path stack");
+  /* Count children, custom flags are not used by evaluation otherwise. */
+  for (OperationNode *op_node : graph->operations) {
+    op_node->critical_path_time = 0.0;
+    op_node->custom_flags = 0;
+    for (Relation *rel : op_node->outlinks) {
+      if (check_relation_pending(rel)) {
+        op_node->custom_flags++;
+      }
+    }
+    if (op_node->custom_flags == 0) {
+      BLI_stack_push(stack, &op_node);
+    }
+  }
+  while (!BLI_stack_is_empty(stack)) {
+    OperationNode *op_node;
+    BLI_stack_pop(stack, &op_node);
+    /* All children are done, so critical path time holds the longest chain of them. */
+    if (!op_node->is_noop()) {
+      op_node->critical_path_time += op_node->stats.average_time + operation_schedule_overhead;
+    }
+    for (Relation *rel : op_node->inlinks) {
+      if (!check_relation_pending(rel)) {
+        continue;
+      }
+      OperationNode *op_from = (OperationNode *)rel->from;
+      op_from->critical_path_time = max(op_from->critical_path_time,
+                                        op_node->critical_path_time);
+      BLI_assert(op_from->custom_flags > 0);
+      if (--op_from->custom_flags == 0) {
+        BLI_stack_push(stack, &op_from);
+      }
+    }
+  }
+  BLI_stack_free(stack);
+  /* Store children of every operation most critical first, keeping relations untouched. */
+  graph->critical_path_outlinks.clear();
+  for (OperationNode *op_node : graph->operations) {
+    op_node->critical_path_outlinks_index = graph->critical_path_outlinks.size();
+    graph->critical_path_outlinks.insert(
+        graph->critical_path_outlinks.end(), op_node->outlinks.begin(), op_node->outlinks.end());
+    std::sort(graph->critical_path_outlinks.begin() + op_node->critical_path_outlinks_index,
+              graph->critical_path_outlinks.end(),
+              compare_relations_critical_path);
+  }
+  graph->critical_path_operations = graph->operations;
+  std::stable_sort(graph->critical_path_operations.begin(),
+                   graph->critical_path_operations.end(),
+                   compare_operations_critical_path);
+}
+
 static void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
-  const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
-    if (do_stats) {
+    if (state->do_timing) {
       node->stats.reset_current();
     }
   }
 }
 
+/* Call a function for every item, sorted most critical first, in the order they are to be
+ * pushed to the task pool. Thread deques are LIFO for the owning thread and FIFO for other
+ * threads: the most critical item is pushed last, so it is picked up next by the same thread,
+ * and the next most critical ones first, so they are stolen first. Suspended pools queue tasks in
+ * the reverse order of pushing, so the order is reversed for them. */
+template<typename T, typename Func>
+static void foreach_in_schedule_order(T *items, int num_items, bool is_pool_suspended, Func func)
+{
+  if (num_items == 0) {
+    return;
+  }
+  if (is_pool_suspended) {
+    func(items[0]);
+    for (int i = num_items - 1; i > 0; i--) {
+      func(items[i]);
+    }
+  }
+  else {
+    for (int i = 1; i < num_items; i++) {
+      func(items[i]);
+    }
+    func(items[0]);
+  }
+}
+
 /* Schedule a node if it needs evaluation.
  *   dec_parents: Decrement pending parents count, true when child nodes are
  *                scheduled after a task has been completed.
@@ -220,9 +342,41 @@ static void schedule_node(
 
 static void schedule_graph(TaskPool *pool, Depsgraph *graph)
 {
-  for (OperationNode *node : graph->operations) {
-    schedule_node(pool, graph, node, false, 0);
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_userdata(pool);
+  if (!state->do_critical_path_scheduling) {
+    for (OperationNode *node : graph->operations) {
+      schedule_node(pool, graph, node, false, 0);
+    }
+    return;
+  }
+  vector<OperationNode *> ready_nodes;
+  for (OperationNode *node : graph->critical_path_operations) {
+    if (node->num_links_pending != 0 || node->scheduled || !check_operation_node_pending(node)) {
+      continue;
+    }
+    /* During the COW stage only COW nodes are scheduled. */
+    if (state->is_cow_stage && node->owner->type != NodeType::COPY_ON_WRITE) {
+      continue;
+    }
+    ready_nodes.push_back(node);
   }
+  state->is_pool_suspended = true;
+  foreach_in_schedule_order(
+      ready_nodes.data(), ready_nodes.size(), true, [pool, graph](OperationNode *node) {
+        schedule_node(pool, graph, node, false, 0);
+      });
+  state->is_pool_suspended = false;
+}
+
+static void schedule_child(TaskPool *pool, Depsgraph *graph, Relation *rel, const int thread_id)
+{
+  OperationNode *child = (OperationNode *)rel->to;
+  BLI_assert(child->type == NodeType::OPERATION);
+  if (child->scheduled) {
+    /* Happens when having cyclic dependencies. */
+    return;
+  }
+  schedule_node(pool, graph, child, (rel->flag & RELATION_FLAG_CYCLIC) == 0, thread_id);
 }
 
 static void schedule_children(TaskPool *pool,
@@ -230,15 +384,19 @@ static void schedule_children(TaskPool *pool,
                               OperationNode *node,
                               const int thread_id)
 {
-  for (Relation *rel : node->outlinks) {
-    OperationNode *child = (OperationNode *)rel->to;
-    BLI_assert(child->type == NodeType::OPERATION);
-    if (child->scheduled) {
-      /* Happens when having cyclic dependencies. */
-      continue;
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_userdata(pool);
+  if (!state->do_critical_path_scheduling || node->outlinks.size() < 2) {
+    for (Relation *rel : node->outlinks) {
+      schedule_child(pool, graph, rel, thread_id);
     }
-    schedule_node(pool, graph, child, (rel->flag & RELATION_FLAG_CYCLIC) == 0, thread_id);
+    return;
   }
+  foreach_in_schedule_order(&graph->critical_path_outlinks[node->critical_path_outlinks_index],
+                            node->outlinks.size(),
+                            state->is_pool_suspended,
+                            [pool, graph, thread_id](Relation *rel) {
+                              schedule_child(pool, graph, rel, thread_id);
+                            });
 }
 
 static void depsgraph_ensure_view_layer(Depsgraph *graph)
@@ -287,25 +445,54 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
     task_scheduler = BLI_task_scheduler_get();
     need_free_scheduler = false;
   }
+  state.do_critical_path_scheduling = BLI_task_scheduler_num_threads(task_scheduler) > 1;
+  state.trace = graph->is_trace_recording ? graph->trace : NULL;
+  state.is_pool_suspended = false;
+  /* Operations are only timed for the critical path on the first evaluation after relations are
+   * built, later evaluations reuse the order calculated from those timings. */
+  bool do_critical_path_update = false;
+  if (state.do_critical_path_scheduling && graph->critical_path_operations.empty()) {
+    calculate_critical_path(graph);
+    do_critical_path_update = true;
+  }
+  state.do_timing = state.do_stats || do_critical_path_update || state.trace != NULL;
+  if (state.trace != NULL) {
+    state.trace->evaluation_begin(BLI_task_scheduler_num_threads(task_scheduler));
+  }
   TaskPool *task_pool = BLI_task_pool_create_suspended(task_scheduler, &state);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
   /* Do actual evaluation now. */
   /* First, process all Copy-On-Write nodes. */
   state.is_cow_stage = true;
+  if (state.trace != NULL) {
+    state.trace->stage_begin("Copy-on-Write");
+  }
   schedule_graph(task_pool, graph);
   BLI_task_pool_work_wait_and_reset(task_pool);
+  if (state.trace != NULL) {
+    state.trace->stage_end();
+  }
   /* After that, process all other nodes. */
   state.is_cow_stage = false;
   schedule_graph(task_pool, graph);
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
+  if (state.trace != NULL) {
+    state.trace->evaluation_end(graph);
+  }
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
   }
+  if (state.do_timing) {
+    deg_eval_stats_update_average(graph);
+  }
+  if (do_critical_path_update) {
+    calculate_critical_path(graph);
+  }
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
   if (need_free_scheduler) {
@@ -37,6 +37,9 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_listbase.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_rotation.h"
+#include "BLI_math_vector.h"
 #include "BLI_threads.h"
 #include "BLI_string.h"
 
@@ -83,6 +86,7 @@ extern "C" {
 #include "BKE_action.h"
 #include "BKE_animsys.h"
 #include "BKE_armature.h"
+#include "BKE_constraint.h"
 #include "BKE_editmesh.h"
 #include "BKE_library_query.h"
 #include "BKE_modifier.h"
@@ -96,7 +100,9 @@ extern "C" {
 #include "intern/builder/deg_builder.h"
 #include "intern/builder/deg_builder_nodes.h"
 #include "intern/node/deg_node.h"
+#include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
 
 namespace DEG {
 
@@ -1462,6 +1468,162 @@ void RuntimeBackup::restore_to_id(ID *id)
   }
 }
 
+/* Partial copy-on-write update.
+ *
+ * When copy-on-write is tagged for update by components which are known to only use a small
+ * part of the datablock, only this part is copied from the original datablock, without freeing
+ * and re-creating the whole copy (which includes such heavy data as modifiers and runtime). */
+
+void constraints_remap_id_callback(bConstraint * /*con*/,
+                                   ID **id_p,
+                                   bool /*is_reference*/,
+                                   void *user_data)
+{
+  if (*id_p == NULL || !check_datablocks_copy_on_writable(*id_p)) {
+    return;
+  }
+  const Depsgraph *depsgraph = (const Depsgraph *)user_data;
+  *id_p = depsgraph->get_cow_id(*id_p);
+}
+
+bool object_supports_partial_update(const Object *object_orig, IDComponentsMask components_mask)
+{
+  const IDComponentsMask transform_mask = (1ULL << static_cast<int>(NodeType::TRANSFORM));
+  if ((components_mask & ~transform_mask) != 0) {
+    return false;
+  }
+  /* Rigid body simulation keeps its own copy of the transform. */
+  if (object_orig->rigidbody_object != NULL || object_orig->rigidbody_constraint != NULL) {
+    return false;
+  }
+  return true;
+}
+
+void object_update_transform(const Depsgraph *depsgraph,
+                             const Object *object_orig,
+                             Object *object_cow)
+{
+  /* Properties which only tag transform for update are not limited to the transform channels
+   * (parent vertices, instancing scale, display type...), so copy the plain settings of the
+   * object. Pointers, lists, material slots and runtime data of the copy stay as they are, as
+   * well as matrices and base flags which are evaluated. */
+  object_cow->partype = object_orig->partype;
+  object_cow->par1 = object_orig->par1;
+  object_cow->par2 = object_orig->par2;
+  object_cow->par3 = object_orig->par3;
+  STRNCPY(object_cow->parsubstr, object_orig->parsubstr);
+  object_cow->avs = object_orig->avs;
+  object_cow->mode = object_orig->mode;
+  object_cow->restore_mode = object_orig->restore_mode;
+  /* Transform channels. */
+  copy_v3_v3(object_cow->loc, object_orig->loc);
+  copy_v3_v3(object_cow->dloc, object_orig->dloc);
+  copy_v3_v3(object_cow->scale, object_orig->scale);
+  copy_v3_v3(object_cow->dscale, object_orig->dscale);
+  copy_v3_v3(object_cow->rot, object_orig->rot);
+  copy_v3_v3(object_cow->drot, object_orig->drot);
+  copy_qt_qt(object_cow->quat, object_orig->quat);
+  copy_qt_qt(object_cow->dquat, object_orig->dquat);
+  copy_v3_v3(object_cow->rotAxis, object_orig->rotAxis);
+  copy_v3_v3(object_cow->drotAxis, object_orig->drotAxis);
+  object_cow->rotAngle = object_orig->rotAngle;
+  object_cow->drotAngle = object_orig->drotAngle;
+  object_cow->rotmode = object_orig->rotmode;
+  copy_m4_m4(object_cow->parentinv, object_orig->parentinv);
+  /* Flags and display settings. */
+  object_cow->flag = object_orig->flag;
+  object_cow->transflag = object_orig->transflag;
+  object_cow->protectflag = object_orig->protectflag;
+  object_cow->trackflag = object_orig->trackflag;
+  object_cow->upflag = object_orig->upflag;
+  object_cow->nlaflag = object_orig->nlaflag;
+  object_cow->duplicator_visibility_flag = object_orig->duplicator_visibility_flag;
+  object_cow->col_group = object_orig->col_group;
+  object_cow->col_mask = object_orig->col_mask;
+  object_cow->boundtype = object_orig->boundtype;
+  object_cow->collision_boundtype = object_orig->collision_boundtype;
+  object_cow->dtx = object_orig->dtx;
+  object_cow->dt = object_orig->dt;
+  object_cow->empty_drawtype = object_orig->empty_drawtype;
+  object_cow->empty_drawsize = object_orig->empty_drawsize;
+  object_cow->instance_faces_scale = object_orig->instance_faces_scale;
+  object_cow->index = object_orig->index;
+  object_cow->actdef = object_orig->actdef;
+  object_cow->actfmap = object_orig->actfmap;
+  copy_v4_v4(object_cow->color, object_orig->color);
+  object_cow->softflag = object_orig->softflag;
+  object_cow->restrictflag = object_orig->restrictflag;
+  object_cow->shapeflag = object_orig->shapeflag;
+  object_cow->shapenr = object_orig->shapenr;
+  copy_v2_v2(object_cow->ima_ofs, object_orig->ima_ofs);
+  object_cow->empty_image_visibility_flag = object_orig->empty_image_visibility_flag;
+  object_cow->empty_image_depth = object_orig->empty_image_depth;
+  object_cow->empty_image_flag = object_orig->empty_image_flag;
+  /* Constraints are evaluated as a part of transform. They are small, so copy them as-is. */
+  BKE_constraints_free_ex(&object_cow->constraints, false);
+  BKE_constraints_copy_ex(&object_cow->constraints,
+                          &object_orig->constraints,
+                          LIB_ID_CREATE_NO_MAIN | LIB_ID_CREATE_NO_USER_REFCOUNT,
+                          false);
+  BKE_constraints_id_loop(
+      &object_cow->constraints, constraints_remap_id_callback, (void *)depsgraph);
+}
+
+/* Check whether copy-on-write operation was only tagged for update by the given components, and
+ * not by an update flushed from other copy-on-write operations. */
+IDComponentsMask get_partial_update_components_mask(const IDNode *id_node)
+{
+  const IDComponentsMask components_mask = id_node->cow_update_components_mask;
+  const IDComponentsMask cow_mask = (1ULL << static_cast<int>(NodeType::COPY_ON_WRITE));
+  if (components_mask == 0 || (components_mask & cow_mask) != 0) {
+    return 0;
+  }
+  ComponentNode *cow_comp = id_node->find_component(NodeType::COPY_ON_WRITE);
+  OperationNode *cow_op = cow_comp->get_entry_operation();
+  if (cow_op == NULL) {
+    return 0;
+  }
+  for (Relation *rel : cow_op->inlinks) {
+    OperationNode *op_from = (OperationNode *)rel->from;
+    if (op_from->flag & DEPSOP_FLAG_NEEDS_UPDATE) {
+      return 0;
+    }
+  }
+  return components_mask;
+}
+
+bool deg_update_copy_on_write_datablock_partial(const Depsgraph *depsgraph,
+                                                const IDNode *id_node)
+{
+  const ID *id_orig = id_node->id_orig;
+  ID *id_cow = id_node->id_cow;
+  if (!deg_copy_on_write_is_expanded(id_cow)) {
+    return false;
+  }
+  const IDComponentsMask components_mask = get_partial_update_components_mask(id_node);
+  if (components_mask == 0) {
+    return false;
+  }
+  const ID_Type id_type = GS(id_orig->name);
+  switch (id_type) {
+    case ID_OB: {
+      const Object *object_orig = (const Object *)id_orig;
+      if (!object_supports_partial_update(object_orig, components_mask)) {
+        return false;
+      }
+      DEG_COW_PRINT("Updating transform of %s: id_orig=%p id_cow=%p\n",
+                    id_orig->name,
+                    id_orig,
+                    id_cow);
+      object_update_transform(depsgraph, object_orig, (Object *)id_cow);
+      return true;
+    }
+    default:
+      break;
+  }
+  return false;
+}
+
 }  // namespace
 
 ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode *id_node)
@@ -1472,6 +1634,9 @@ ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode
   if (!deg_copy_on_write_is_needed(id_orig)) {
     return id_cow;
   }
+  if (deg_update_copy_on_write_datablock_partial(depsgraph, id_node)) {
+    return id_cow;
+  }
   RuntimeBackup backup;
   backup.init_from_id(id_cow);
   deg_free_copy_on_write_datablock(id_cow);
@@ -419,6 +419,9 @@ void deg_graph_clear_tags(Depsgraph *graph)
   }
   /* Clear any entry tags which haven't been flushed. */
   BLI_gset_clear(graph->entry_tags, NULL);
+  for (IDNode *id_node : graph->id_nodes) {
+    id_node->cow_update_components_mask = 0;
+  }
 }
 
 }  // namespace DEG
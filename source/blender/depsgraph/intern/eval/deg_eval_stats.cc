@@ -56,4 +56,23 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+void deg_eval_stats_update_average(Depsgraph *graph)
+{
+  /* Weight of the current evaluation, the average follows changes in the scene (like a modifier
+   * being enabled) within a few frames. */
+  const double weight = 0.25;
+  for (OperationNode *op_node : graph->operations) {
+    if (!op_node->scheduled || op_node->is_noop()) {
+      continue;
+    }
+    Node::Stats &stats = op_node->stats;
+    if (stats.average_time == 0.0) {
+      stats.average_time = stats.current_time;
+    }
+    else {
+      stats.average_time += (stats.current_time - stats.average_time) * weight;
+    }
+  }
+}
+
 }  // namespace DEG
@@ -30,4 +30,7 @@ struct Depsgraph;
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Update average evaluation time of operations which were evaluated. */
+void deg_eval_stats_update_average(Depsgraph *graph);
+
 }  // namespace DEG
@@ -156,6 +156,8 @@ struct Node {
     void reset_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Running average of the evaluation time, used to estimate cost of operations. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
@@ -203,8 +203,15 @@ OperationNode *ComponentNode::add_operation(const DepsEvalOperationCb &op,
     op_node = (OperationNode *)factory->create_node(this->owner->id_orig, "", name);
 
     /* register opnode in this component's operation set */
-    OperationIDKey *key = OBJECT_GUARDED_NEW(OperationIDKey, opcode, name, name_tag);
-    BLI_ghash_insert(operations_map, key, op_node);
+    if (operations_map != NULL) {
+      OperationIDKey *key = OBJECT_GUARDED_NEW(OperationIDKey, opcode, name, name_tag);
+      BLI_ghash_insert(operations_map, key, op_node);
+    }
+    else {
+      /* Component was finalized already, happens during incremental update when operations
+       * are added to an ID which is not being rebuilt. */
+      operations.push_back(op_node);
+    }
 
     /* set backlink */
     op_node->owner = this;
@@ -314,6 +321,10 @@ OperationNode *ComponentNode::get_exit_operation()
 
 void ComponentNode::finalize_build(Depsgraph * /*graph*/)
 {
+  if (operations_map == NULL) {
+    /* Already finalized, ID was not rebuilt by an incremental update. */
+    return;
+  }
   operations.reserve(BLI_ghash_len(operations_map));
   GHASH_FOREACH_BEGIN (OperationNode *, op_node, operations_map) {
     operations.push_back(op_node);
@@ -341,6 +352,14 @@ void BoneComponentNode::init(const ID *id, const char *subdata)
   this->pchan = BKE_pose_channel_find_name(object->pose, subdata);
 }
 
+/* Copy-on-Write Component ================================ */
+
+void CopyOnWriteComponentNode::tag_update(Depsgraph *graph, eUpdateSource source)
+{
+  owner->tag_cow_update_component(NodeType::COPY_ON_WRITE);
+  ComponentNode::tag_update(graph, source);
+}
+
 /* Register all components. =============================== */
 
 DEG_COMPONENT_NODE_DEFINE(Animation, ANIMATION, ID_RECALC_ANIMATION);
@@ -170,7 +170,6 @@ struct ComponentNode : public Node {
 DEG_COMPONENT_NODE_DECLARE_GENERIC(Animation);
 DEG_COMPONENT_NODE_DECLARE_NO_COW_TAG_ON_UPDATE(BatchCache);
 DEG_COMPONENT_NODE_DECLARE_GENERIC(Cache);
-DEG_COMPONENT_NODE_DECLARE_GENERIC(CopyOnWrite);
 DEG_COMPONENT_NODE_DECLARE_GENERIC(Geometry);
 DEG_COMPONENT_NODE_DECLARE_GENERIC(LayerCollections);
 DEG_COMPONENT_NODE_DECLARE_GENERIC(Parameters);
@@ -190,6 +189,15 @@ DEG_COMPONENT_NODE_DECLARE_GENERIC(Audio);
 DEG_COMPONENT_NODE_DECLARE_GENERIC(Armature);
 DEG_COMPONENT_NODE_DECLARE_GENERIC(GenericDatablock);
 
+/* Copy-on-Write Component */
+struct CopyOnWriteComponentNode : public ComponentNode {
+  /* Tagging the component itself requests full copy of the datablock. Updates which only need
+   * part of the datablock copied tag the operation (see #depsgraph_id_tag_copy_on_write). */
+  virtual void tag_update(Depsgraph *graph, eUpdateSource source) override;
+
+  DEG_COMPONENT_NODE_DECLARE;
+};
+
 /* Bone Component */
 struct BoneComponentNode : public ComponentNode {
   void init(const ID *id, const char *subdata);
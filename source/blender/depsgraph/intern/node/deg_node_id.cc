@@ -40,9 +40,11 @@ extern "C" {
 
 #include "DEG_depsgraph.h"
 
+#include "intern/depsgraph.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/node/deg_node_factory.h"
 #include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_operation.h"
 #include "intern/node/deg_node_time.h"
 
 namespace DEG {
@@ -117,6 +119,8 @@ void IDNode::init(const ID *id, const char *UNUSED(subdata))
   visible_components_mask = 0;
   previously_visible_components_mask = 0;
 
+  cow_update_components_mask = 0;
+
   components = BLI_ghash_new(
       id_deps_node_hash_key, id_deps_node_hash_key_cmp, "Depsgraph id components hash");
 }
@@ -152,6 +156,40 @@ IDNode::~IDNode()
   destroy();
 }
 
+static void id_deps_node_unlink_relations(Node *node)
+{
+  /* Copy, since unlinking modifies the vectors. */
+  const Node::Relations relations_in = node->inlinks;
+  const Node::Relations relations_out = node->outlinks;
+  for (Relation *rel : relations_in) {
+    rel->unlink();
+    OBJECT_GUARDED_DELETE(rel, Relation);
+  }
+  for (Relation *rel : relations_out) {
+    rel->unlink();
+    OBJECT_GUARDED_DELETE(rel, Relation);
+  }
+}
+
+void IDNode::clear_components()
+{
+  GHASH_FOREACH_BEGIN (ComponentNode *, comp_node, components) {
+    id_deps_node_unlink_relations(comp_node);
+    for (OperationNode *op_node : comp_node->operations) {
+      id_deps_node_unlink_relations(op_node);
+    }
+    if (comp_node->operations_map != NULL) {
+      GHASH_FOREACH_BEGIN (OperationNode *, op_node, comp_node->operations_map) {
+        id_deps_node_unlink_relations(op_node);
+      }
+      GHASH_FOREACH_END();
+    }
+  }
+  GHASH_FOREACH_END();
+  BLI_ghash_clear(components, id_deps_node_hash_key_free, id_deps_node_hash_value_free);
+  visible_components_mask = 0;
+}
+
 void IDNode::destroy()
 {
   if (id_orig == NULL) {
@@ -240,4 +278,11 @@ IDComponentsMask IDNode::get_visible_components_mask() const
   return result;
 }
 
+void IDNode::tag_cow_update_component(NodeType component_type)
+{
+  const int component_type_as_int = static_cast<int>(component_type);
+  BLI_assert(component_type_as_int < 64);
+  cow_update_components_mask |= (1ULL << component_type_as_int);
+}
+
 }  // namespace DEG
@@ -65,6 +65,9 @@ struct IDNode : public Node {
 
   ComponentNode *find_component(NodeType type, const char *name = "") const;
   ComponentNode *add_component(NodeType type, const char *name = "");
+  /* Free all components, their operations and all relations from and to them.
+   * Copy-on-write datablock is kept, so the ID can be built again. */
+  void clear_components();
 
   virtual void tag_update(Depsgraph *graph, eUpdateSource source) override;
 
@@ -72,6 +75,9 @@ struct IDNode : public Node {
 
   IDComponentsMask get_visible_components_mask() const;
 
+  /* Remember that copy-on-write update of the datablock was requested by the given component. */
+  void tag_cow_update_component(NodeType component_type);
+
   /* ID Block referenced. */
   ID *id_orig;
   ID *id_cow;
@@ -107,6 +113,11 @@ struct IDNode : public Node {
   IDComponentsMask visible_components_mask;
   IDComponentsMask previously_visible_components_mask;
 
+  /* Components which requested copy-on-write update of this ID since the last evaluation, allows
+   * to only update parts of the copied datablock. COPY_ON_WRITE component means the whole
+   * datablock is to be copied. */
+  IDComponentsMask cow_update_components_mask;
+
   DEG_DEPSNODE_DECLARE;
 };
 
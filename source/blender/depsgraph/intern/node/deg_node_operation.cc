@@ -196,7 +196,8 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0)
+OperationNode::OperationNode()
+    : critical_path_time(0.0), critical_path_outlinks_index(0), name_tag(-1), flag(0)
 {
 }
 
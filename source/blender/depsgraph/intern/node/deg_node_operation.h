@@ -251,6 +251,11 @@ struct OperationNode : public Node {
   /* How many inlinks are we still waiting on before we can be evaluated. */
   uint32_t num_links_pending;
   bool scheduled;
+  /* Estimated time needed to evaluate the longest chain of operations which starts at this one.
+   * Operations on the critical path are scheduled first. */
+  double critical_path_time;
+  /* Index of the first child in #Depsgraph.critical_path_outlinks. */
+  int critical_path_outlinks_index;
 
   /* Identifier for the operation being performed. */
   OperationCode opcode;
@@ -133,6 +133,7 @@ static int wm_alembic_export_exec(bContext *C, wmOperator *op)
       .use_subdiv_schema = RNA_boolean_get(op->ptr, "subdiv_schema"),
       .export_hair = RNA_boolean_get(op->ptr, "export_hair"),
       .export_particles = RNA_boolean_get(op->ptr, "export_particles"),
+      .parallel_frames = RNA_boolean_get(op->ptr, "parallel_frames"),
       .compression_type = RNA_enum_get(op->ptr, "compression_type"),
       .packuv = RNA_boolean_get(op->ptr, "packuv"),
       .triangulate = RNA_boolean_get(op->ptr, "triangulate"),
@@ -214,6 +215,9 @@ static void ui_alembic_export_settings(uiLayout *layout, PointerRNA *imfptr)
   row = uiLayoutRow(box, false);
   uiItemR(row, imfptr, "flatten", 0, NULL, ICON_NONE);
 
+  row = uiLayoutRow(box, false);
+  uiItemR(row, imfptr, "parallel_frames", 0, NULL, ICON_NONE);
+
   /* Object Data */
   box = uiLayoutBox(layout);
   row = uiLayoutRow(box, false);
@@ -475,6 +479,13 @@ void WM_OT_alembic_export(wmOperatorType *ot)
   RNA_def_boolean(
       ot->srna, "export_particles", 1, "Export Particles", "Exports non-hair particle systems");
 
+  RNA_def_boolean(ot->srna,
+                  "parallel_frames",
+                  false,
+                  "Evaluate Frames in Parallel",
+                  "Evaluate multiple frames at once, using more memory. Frame change handlers "
+                  "are not called, scenes with simulations are always evaluated frame by frame");
+
   RNA_def_boolean(
       ot->srna,
       "as_background_job",
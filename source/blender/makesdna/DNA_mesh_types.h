@@ -101,6 +101,21 @@ typedef struct Mesh_Runtime {
   /** Non-manifold boundary data for Shrinkwrap Target Project. */
   struct ShrinkwrapBoundaryData *shrinkwrap_data;
 
+  /** Vertex adjacency, see #BKE_mesh_runtime_vert_adjacency_ensure. */
+  struct MeshVertAdjacency *vert_adjacency;
+
+  /**
+   * Meshes with the same non-zero key only differ by their vertex positions (and normals).
+   * Used by the modifier stack to re-evaluate constructive modifiers without rebuilding their
+   * topology, see #ModifierTypeInfo.applyModifierDeform. Cleared on copy.
+   */
+  int topology_key;
+  /**
+   * Changed whenever the topology arrays may have been reallocated, see
+   * #BKE_mesh_runtime_topology_changed. Copies referencing the topology keep the generation.
+   */
+  int topology_generation;
+
   /** Set by modifier stack if only deformed from original. */
   char deformed_only;
   /**
@@ -788,8 +788,11 @@ typedef struct BooleanModifierData {
   ModifierData modifier;
 
   struct Object *object;
+  /** Operands used when #operand_type is #eBooleanModifierOperandType_Collection. */
+  struct Collection *collection;
   char operation;
-  char _pad[2];
+  char operand_type;
+  char _pad[1];
   char bm_flag;
   float double_threshold;
 } BooleanModifierData;
@@ -800,6 +803,12 @@ typedef enum {
   eBooleanModifierOp_Difference = 2,
 } BooleanModifierOp;
 
+/* BooleanModifierData.operand_type */
+typedef enum {
+  eBooleanModifierOperandType_Object = 0,
+  eBooleanModifierOperandType_Collection = 1,
+} BooleanModifierOperandType;
+
 /* bm_flag (only used when G_DEBUG) */
 enum {
   eBooleanModifierBMeshFlag_BMesh_Separate = (1 << 0),
@@ -1497,6 +1506,8 @@ typedef enum eRemeshModifierMode {
   MOD_REMESH_MASS_POINT = 1,
   /* keeps sharp edges */
   MOD_REMESH_SHARP_FEATURES = 2,
+  /* OpenVDB voxel level set */
+  MOD_REMESH_VOXEL = 3,
 } eRemeshModifierMode;
 
 typedef struct RemeshModifierData {
@@ -1516,6 +1527,10 @@ typedef struct RemeshModifierData {
   char flag;
   char mode;
   char _pad;
+
+  /* OpenVDB Voxel remesh properties. */
+  float voxel_size;
+  float adaptivity;
 } RemeshModifierData;
 
 /* Skin modifier */
@@ -183,6 +183,12 @@ typedef struct Object_Runtime {
   /** Runtime grease pencil evaluated data created by modifiers */
   struct bGPDframe *gpencil_evaluated_frames;
 
+  /**
+   * Results of constructive modifiers kept between evaluations of the modifier stack,
+   * see #BKE_modifier_apply_topology_cached.
+   */
+  ListBase modifier_topology_cache;
+
   unsigned short local_collections_bits;
   short _pad2[3];
 } Object_Runtime;
@@ -45,6 +45,7 @@
 
 #  include "BKE_anim.h"
 #  include "BKE_object.h"
+#  include "BKE_report.h"
 #  include "BKE_scene.h"
 
 #  include "DEG_depsgraph_build.h"
@@ -244,6 +245,31 @@ static void rna_Depsgraph_debug_stats_gnuplot(Depsgraph *depsgraph,
   fclose(f);
 }
 
+static void rna_Depsgraph_debug_trace_begin(Depsgraph *depsgraph)
+{
+  DEG_debug_trace_begin(depsgraph);
+}
+
+static void rna_Depsgraph_debug_trace_end(Depsgraph *depsgraph)
+{
+  DEG_debug_trace_end(depsgraph);
+}
+
+static void rna_Depsgraph_debug_trace_write(Depsgraph *depsgraph,
+                                            ReportList *reports,
+                                            const char *filename)
+{
+  FILE *f = fopen(filename, "w");
+  if (f == NULL) {
+    BKE_reportf(reports, RPT_ERROR, "Cannot open file '%s' for writing", filename);
+    return;
+  }
+  if (!DEG_debug_trace_write(depsgraph, f)) {
+    BKE_report(reports, RPT_WARNING, "No evaluation timeline was recorded");
+  }
+  fclose(f);
+}
+
 static void rna_Depsgraph_debug_tag_update(Depsgraph *depsgraph)
 {
   DEG_graph_tag_relations_update(depsgraph);
@@ -638,6 +664,21 @@ static void rna_def_depsgraph(BlenderRNA *brna)
                                   "File name where gnuplot script will save the result");
   RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
 
+  func = RNA_def_function(srna, "debug_trace_begin", "rna_Depsgraph_debug_trace_begin");
+  RNA_def_function_ui_description(
+      func, "Start recording a timeline of evaluated operations, discarding the previous one");
+
+  func = RNA_def_function(srna, "debug_trace_end", "rna_Depsgraph_debug_trace_end");
+  RNA_def_function_ui_description(func, "Stop recording the timeline of evaluated operations");
+
+  func = RNA_def_function(srna, "debug_trace_write", "rna_Depsgraph_debug_trace_write");
+  RNA_def_function_ui_description(
+      func, "Write the recorded timeline as Chrome trace, for chrome://tracing or Perfetto");
+  RNA_def_function_flag(func, FUNC_USE_REPORTS);
+  parm = RNA_def_string_file_path(
+      func, "filename", NULL, FILE_MAX, "File Name", "Output path for the trace JSON file");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
   func = RNA_def_function(srna, "debug_tag_update", "rna_Depsgraph_debug_tag_update");
 
   func = RNA_def_function(srna, "debug_stats", "rna_Depsgraph_debug_stats");
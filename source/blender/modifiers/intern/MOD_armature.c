@@ -254,6 +254,7 @@ ModifierTypeInfo modifierType_Armature = {
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ deformMatricesEM,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
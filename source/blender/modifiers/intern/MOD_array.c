@@ -28,6 +28,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_curve_types.h"
 #include "DNA_mesh_types.h"
@@ -146,19 +147,22 @@ static void svert_from_mvert(SortVertsElem *sv,
 }
 
 /**
- * Take as inputs two sets of verts, to be processed for detection of doubles and mapping.
+ * Take as inputs two sets of verts, to be processed for detection of doubles.
  * Each set of verts is defined by its start within mverts array and its num_verts;
- * It builds a mapping for all vertices within source,
- * to vertices within target, or -1 if no double found.
- * The int doubles_map[num_verts_source] array must have been allocated by caller.
+ * It finds the closest vertex within target for all vertices within source,
+ * or -1 if no double found, without following any existing mapping of the targets.
+ * The int r_nearest_map[source_num_verts] array (indexed from source_start)
+ * must have been allocated by caller.
+ *
+ * Only reads vertex coordinates, so disjoint source sets can be processed in parallel.
  */
-static void dm_mvert_map_doubles(int *doubles_map,
-                                 const MVert *mverts,
-                                 const int target_start,
-                                 const int target_num_verts,
-                                 const int source_start,
-                                 const int source_num_verts,
-                                 const float dist)
+static void dm_mvert_find_doubles(int *r_nearest_map,
+                                  const MVert *mverts,
+                                  const int target_start,
+                                  const int target_num_verts,
+                                  const int source_start,
+                                  const int source_num_verts,
+                                  const float dist)
 {
   const float dist3 = ((float)M_SQRT3 + 0.00005f) * dist; /* Just above sqrt(3) */
   int i_source, i_target, i_target_low_bound, target_end, source_end;
@@ -195,14 +199,9 @@ static void dm_mvert_map_doubles(int *doubles_map,
     float best_dist_sq = dist * dist;
     float sve_source_sumco;
 
-    /* If source has already been assigned to a target (in an earlier call, with other chunks) */
-    if (doubles_map[sve_source->vertex_num] != -1) {
-      continue;
-    }
-
     /* If target fully scanned already, then all remaining source vertices cannot have a double */
     if (target_scan_completed) {
-      doubles_map[sve_source->vertex_num] = -1;
+      r_nearest_map[sve_source->vertex_num - source_start] = -1;
       continue;
     }
 
@@ -217,7 +216,7 @@ static void dm_mvert_map_doubles(int *doubles_map,
     }
     /* If end of target list reached, then no more possible doubles */
     if (i_target_low_bound >= target_num_verts) {
-      doubles_map[sve_source->vertex_num] = -1;
+      r_nearest_map[sve_source->vertex_num - source_start] = -1;
       target_scan_completed = true;
       continue;
     }
@@ -237,35 +236,83 @@ static void dm_mvert_map_doubles(int *doubles_map,
         /* Potential double found */
         best_dist_sq = dist_sq;
         best_target_vertex = sve_target->vertex_num;
-
-        /* If target is already mapped, we only follow that mapping if final target remains
-         * close enough from current vert (otherwise no mapping at all).
-         * Note that if we later find another target closer than this one, then we check it.
-         * But if other potential targets are farther,
-         * then there will be no mapping at all for this source. */
-        while (best_target_vertex != -1 &&
-               !ELEM(doubles_map[best_target_vertex], -1, best_target_vertex)) {
-          if (compare_len_v3v3(mverts[sve_source->vertex_num].co,
-                               mverts[doubles_map[best_target_vertex]].co,
-                               dist)) {
-            best_target_vertex = doubles_map[best_target_vertex];
-          }
-          else {
-            best_target_vertex = -1;
-          }
-        }
       }
       i_target++;
       sve_target++;
     }
     /* End of candidate scan: if none found then no doubles */
-    doubles_map[sve_source->vertex_num] = best_target_vertex;
+    r_nearest_map[sve_source->vertex_num - source_start] = best_target_vertex;
   }
 
   MEM_freeN(sorted_verts_source);
   MEM_freeN(sorted_verts_target);
 }
 
+/**
+ * Build the mapping of all vertices within source from the closest doubles found by
+ * #dm_mvert_find_doubles. If a target is already mapped, we only follow that mapping if final
+ * target remains close enough from the source vertex (otherwise no mapping at all).
+ *
+ * Reads the mapping of targets, so sets depending on each other must be resolved in order.
+ */
+static void dm_mvert_resolve_doubles(int *doubles_map,
+                                     const MVert *mverts,
+                                     const int *nearest_map,
+                                     const int source_start,
+                                     const int source_num_verts,
+                                     const float dist)
+{
+  int i;
+  for (i = 0; i < source_num_verts; i++) {
+    const int source_vertex = source_start + i;
+    int target = nearest_map[i];
+
+    /* If source has already been assigned to a target (in an earlier call, with other chunks) */
+    if (doubles_map[source_vertex] != -1) {
+      continue;
+    }
+
+    while (target != -1 && !ELEM(doubles_map[target], -1, target)) {
+      if (compare_len_v3v3(mverts[source_vertex].co, mverts[doubles_map[target]].co, dist)) {
+        target = doubles_map[target];
+      }
+      else {
+        target = -1;
+      }
+    }
+    doubles_map[source_vertex] = target;
+  }
+}
+
+/**
+ * Take as inputs two sets of verts, to be processed for detection of doubles and mapping.
+ * Each set of verts is defined by its start within mverts array and its num_verts;
+ * It builds a mapping for all vertices within source,
+ * to vertices within target, or -1 if no double found.
+ * The int doubles_map[num_verts_source] array must have been allocated by caller.
+ */
+static void dm_mvert_map_doubles(int *doubles_map,
+                                 const MVert *mverts,
+                                 const int target_start,
+                                 const int target_num_verts,
+                                 const int source_start,
+                                 const int source_num_verts,
+                                 const float dist)
+{
+  int *nearest_map = MEM_malloc_arrayN(source_num_verts, sizeof(int), __func__);
+
+  dm_mvert_find_doubles(nearest_map,
+                        mverts,
+                        target_start,
+                        target_num_verts,
+                        source_start,
+                        source_num_verts,
+                        dist);
+  dm_mvert_resolve_doubles(doubles_map, mverts, nearest_map, source_start, source_num_verts, dist);
+
+  MEM_freeN(nearest_map);
+}
+
 static void mesh_merge_transform(Mesh *result,
                                  Mesh *cap_mesh,
                                  const float cap_offset[4][4],
@@ -348,17 +395,125 @@ static void mesh_merge_transform(Mesh *result,
   }
 }
 
+typedef struct ArrayChunkData {
+  const Mesh *mesh;
+  Mesh *result;
+  /** Cumulative offset of each copy, the first one being the original geometry. */
+  const float (*chunk_offsets)[4][4];
+  int chunk_nverts, chunk_nedges, chunk_nloops, chunk_npolys;
+  const float *uv_offset;
+  bool use_uv_offset;
+  bool use_recalc_normals;
+
+  /** Closest doubles of each copy within the previous one, when merging. */
+  int *nearest_map;
+  float merge_dist;
+} ArrayChunkData;
+
+static void array_chunk_copy_task(void *__restrict userdata,
+                                  const int iter,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArrayChunkData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  Mesh *result = data->result;
+  const int chunk_nverts = data->chunk_nverts;
+  const int chunk_nedges = data->chunk_nedges;
+  const int chunk_nloops = data->chunk_nloops;
+  const int chunk_npolys = data->chunk_npolys;
+  const int c = iter + 1;
+  const float(*current_offset)[4] = data->chunk_offsets[c];
+  MVert *mv;
+  MEdge *me;
+  MLoop *ml;
+  MPoly *mp;
+  int i;
+
+  /* copy customdata to new geometry */
+  CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
+  CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
+  CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
+  CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
+
+  mv = result->mvert + c * chunk_nverts;
+
+  /* apply offset to all new verts */
+  for (i = 0; i < chunk_nverts; i++, mv++) {
+    mul_m4_v3(current_offset, mv->co);
+
+    /* We have to correct normals too, if we do not tag them as dirty! */
+    if (!data->use_recalc_normals) {
+      float no[3];
+      normal_short_to_float_v3(no, mv->no);
+      mul_mat3_m4_v3(current_offset, no);
+      normalize_v3(no);
+      normal_float_to_short_v3(mv->no, no);
+    }
+  }
+
+  /* adjust edge vertex indices */
+  me = result->medge + c * chunk_nedges;
+  for (i = 0; i < chunk_nedges; i++, me++) {
+    me->v1 += c * chunk_nverts;
+    me->v2 += c * chunk_nverts;
+  }
+
+  mp = result->mpoly + c * chunk_npolys;
+  for (i = 0; i < chunk_npolys; i++, mp++) {
+    mp->loopstart += c * chunk_nloops;
+  }
+
+  /* adjust loop vertex and edge indices */
+  ml = result->mloop + c * chunk_nloops;
+  for (i = 0; i < chunk_nloops; i++, ml++) {
+    ml->v += c * chunk_nverts;
+    ml->e += c * chunk_nedges;
+  }
+
+  /* handle UVs */
+  if (data->use_uv_offset) {
+    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
+    const float uv_offset[2] = {
+        data->uv_offset[0] * (float)c,
+        data->uv_offset[1] * (float)c,
+    };
+    for (i = 0; i < totuv; i++) {
+      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
+      int l_index = chunk_nloops;
+      dmloopuv += c * chunk_nloops;
+      for (; l_index-- != 0; dmloopuv++) {
+        dmloopuv->uv[0] += uv_offset[0];
+        dmloopuv->uv[1] += uv_offset[1];
+      }
+    }
+  }
+}
+
+static void array_chunk_find_doubles_task(void *__restrict userdata,
+                                          const int iter,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArrayChunkData *data = userdata;
+  const int chunk_nverts = data->chunk_nverts;
+  const int c = iter + 1;
+
+  dm_mvert_find_doubles(data->nearest_map + (c - 1) * chunk_nverts,
+                        data->result->mvert,
+                        (c - 1) * chunk_nverts,
+                        chunk_nverts,
+                        c * chunk_nverts,
+                        chunk_nverts,
+                        data->merge_dist);
+}
+
 static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
                                    const ModifierEvalContext *ctx,
                                    Mesh *mesh)
 {
   const float eps = 1e-6f;
   const MVert *src_mvert;
-  MVert *mv, *mv_prev, *result_dm_verts;
+  MVert *result_dm_verts;
 
-  MEdge *me;
-  MLoop *ml;
-  MPoly *mp;
   int i, j, c, count;
   float length = amd->length;
   /* offset matrix */
@@ -367,6 +522,7 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
   bool offset_has_scale;
   float current_offset[4][4];
   float final_offset[4][4];
+  float(*chunk_offsets)[4][4];
   int *full_doubles_map = NULL;
   int tot_doubles;
 
@@ -532,113 +688,83 @@ static Mesh *arrayModifier_doArray(ArrayModifierData *amd,
   first_chunk_start = 0;
   first_chunk_nverts = chunk_nverts;
 
-  unit_m4(current_offset);
+  /* All offsets are known up front, so the copies can be built in parallel. */
+  chunk_offsets = MEM_malloc_arrayN(count, sizeof(*chunk_offsets), __func__);
+  unit_m4(chunk_offsets[0]);
   for (c = 1; c < count; c++) {
-    /* copy customdata to new geometry */
-    CustomData_copy_data(&mesh->vdata, &result->vdata, 0, c * chunk_nverts, chunk_nverts);
-    CustomData_copy_data(&mesh->edata, &result->edata, 0, c * chunk_nedges, chunk_nedges);
-    CustomData_copy_data(&mesh->ldata, &result->ldata, 0, c * chunk_nloops, chunk_nloops);
-    CustomData_copy_data(&mesh->pdata, &result->pdata, 0, c * chunk_npolys, chunk_npolys);
-
-    mv_prev = result_dm_verts;
-    mv = mv_prev + c * chunk_nverts;
-
     /* recalculate cumulative offset here */
-    mul_m4_m4m4(current_offset, current_offset, offset);
-
-    /* apply offset to all new verts */
-    for (i = 0; i < chunk_nverts; i++, mv++, mv_prev++) {
-      mul_m4_v3(current_offset, mv->co);
-
-      /* We have to correct normals too, if we do not tag them as dirty! */
-      if (!use_recalc_normals) {
-        float no[3];
-        normal_short_to_float_v3(no, mv->no);
-        mul_mat3_m4_v3(current_offset, no);
-        normalize_v3(no);
-        normal_float_to_short_v3(mv->no, no);
-      }
-    }
-
-    /* adjust edge vertex indices */
-    me = result->medge + c * chunk_nedges;
-    for (i = 0; i < chunk_nedges; i++, me++) {
-      me->v1 += c * chunk_nverts;
-      me->v2 += c * chunk_nverts;
-    }
-
-    mp = result->mpoly + c * chunk_npolys;
-    for (i = 0; i < chunk_npolys; i++, mp++) {
-      mp->loopstart += c * chunk_nloops;
-    }
-
-    /* adjust loop vertex and edge indices */
-    ml = result->mloop + c * chunk_nloops;
-    for (i = 0; i < chunk_nloops; i++, ml++) {
-      ml->v += c * chunk_nverts;
-      ml->e += c * chunk_nedges;
-    }
+    mul_m4_m4m4(chunk_offsets[c], chunk_offsets[c - 1], offset);
+  }
+  copy_m4_m4(current_offset, chunk_offsets[count - 1]);
+
+  if (count > 1) {
+    ArrayChunkData data = {
+        .mesh = mesh,
+        .result = result,
+        .chunk_offsets = (const float(*)[4][4])chunk_offsets,
+        .chunk_nverts = chunk_nverts,
+        .chunk_nedges = chunk_nedges,
+        .chunk_nloops = chunk_nloops,
+        .chunk_npolys = chunk_npolys,
+        .uv_offset = amd->uv_offset,
+        .use_uv_offset = (chunk_nloops > 0 && is_zero_v2(amd->uv_offset) == false),
+        .use_recalc_normals = use_recalc_normals,
+        .nearest_map = NULL,
+        .merge_dist = amd->merge_dist,
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = ((count - 1) * chunk_nverts > 1000);
+    BLI_task_parallel_range(0, count - 1, &data, array_chunk_copy_task, &settings);
 
     /* Handle merge between chunk n and n-1 */
-    if (use_merge && (c >= 1)) {
-      if (!offset_has_scale && (c >= 2)) {
-        /* Mapping chunk 3 to chunk 2 is a translation of mapping 2 to 1
-         * ... that is except if scaling makes the distance grow */
-        int k;
-        int this_chunk_index = c * chunk_nverts;
-        int prev_chunk_index = (c - 1) * chunk_nverts;
-        for (k = 0; k < chunk_nverts; k++, this_chunk_index++, prev_chunk_index++) {
-          int target = full_doubles_map[prev_chunk_index];
-          if (target != -1) {
-            target += chunk_nverts; /* translate mapping */
-            while (target != -1 && !ELEM(full_doubles_map[target], -1, target)) {
-              /* If target is already mapped, we only follow that mapping if final target remains
-               * close enough from current vert (otherwise no mapping at all). */
-              if (compare_len_v3v3(result_dm_verts[this_chunk_index].co,
-                                   result_dm_verts[full_doubles_map[target]].co,
-                                   amd->merge_dist)) {
-                target = full_doubles_map[target];
-              }
-              else {
-                target = -1;
-              }
-            }
-          }
-          full_doubles_map[this_chunk_index] = target;
-        }
+    if (use_merge) {
+      data.nearest_map = MEM_malloc_arrayN(
+          (count - 1) * chunk_nverts, sizeof(int), "mod array nearest map");
+
+      /* Finding doubles only reads coordinates, so all chunks can be searched in parallel,
+       * following the mapping of previous chunks is done in order afterwards. */
+      if (offset_has_scale) {
+        BLI_task_parallel_range(0, count - 1, &data, array_chunk_find_doubles_task, &settings);
       }
       else {
-        dm_mvert_map_doubles(full_doubles_map,
-                             result_dm_verts,
-                             (c - 1) * chunk_nverts,
-                             chunk_nverts,
-                             c * chunk_nverts,
-                             chunk_nverts,
-                             amd->merge_dist);
+        dm_mvert_find_doubles(data.nearest_map,
+                              result_dm_verts,
+                              0,
+                              chunk_nverts,
+                              chunk_nverts,
+                              chunk_nverts,
+                              amd->merge_dist);
       }
-    }
-  }
 
-  /* handle UVs */
-  if (chunk_nloops > 0 && is_zero_v2(amd->uv_offset) == false) {
-    const int totuv = CustomData_number_of_layers(&result->ldata, CD_MLOOPUV);
-    for (i = 0; i < totuv; i++) {
-      MLoopUV *dmloopuv = CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, i);
-      dmloopuv += chunk_nloops;
       for (c = 1; c < count; c++) {
-        const float uv_offset[2] = {
-            amd->uv_offset[0] * (float)c,
-            amd->uv_offset[1] * (float)c,
-        };
-        int l_index = chunk_nloops;
-        for (; l_index-- != 0; dmloopuv++) {
-          dmloopuv->uv[0] += uv_offset[0];
-          dmloopuv->uv[1] += uv_offset[1];
+        int *chunk_nearest_map = data.nearest_map + (c - 1) * chunk_nverts;
+        if (!offset_has_scale && (c >= 2)) {
+          /* Mapping chunk 3 to chunk 2 is a translation of mapping 2 to 1
+           * ... that is except if scaling makes the distance grow */
+          const int *prev_chunk_map = full_doubles_map + (c - 1) * chunk_nverts;
+          int k;
+          for (k = 0; k < chunk_nverts; k++) {
+            const int target = prev_chunk_map[k];
+            /* translate mapping */
+            chunk_nearest_map[k] = (target != -1) ? target + chunk_nverts : -1;
+          }
         }
+        dm_mvert_resolve_doubles(full_doubles_map,
+                                 result_dm_verts,
+                                 chunk_nearest_map,
+                                 c * chunk_nverts,
+                                 chunk_nverts,
+                                 amd->merge_dist);
       }
+
+      MEM_freeN(data.nearest_map);
     }
   }
 
+  MEM_freeN(chunk_offsets);
+
   last_chunk_start = (count - 1) * chunk_nverts;
   last_chunk_nverts = chunk_nverts;
 
@@ -807,6 +933,7 @@ ModifierTypeInfo modifierType_Array = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ applyModifier,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
@@ -244,6 +244,7 @@ ModifierTypeInfo modifierType_Bevel = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ applyModifier,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
@@ -30,17 +30,22 @@
 #include "BLI_alloca.h"
 #include "BLI_math_geom.h"
 #include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
 
+#include "DNA_collection_types.h"
+#include "DNA_layer_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
+#include "BKE_collection.h"
 #include "BKE_global.h" /* only to check G.debug */
 #include "BKE_library.h"
 #include "BKE_library_query.h"
 #include "BKE_material.h"
 #include "BKE_mesh.h"
 #include "BKE_modifier.h"
+#include "BKE_object.h"
 
 #include "MOD_util.h"
 
@@ -71,6 +76,10 @@ static bool isDisabled(const struct Scene *UNUSED(scene),
 {
   BooleanModifierData *bmd = (BooleanModifierData *)md;
 
+  if (bmd->operand_type == eBooleanModifierOperandType_Collection) {
+    return !bmd->collection;
+  }
+
   /* The object type check is only needed here in case we have a placeholder
    * object assigned (because the library containing the mesh is missing).
    *
@@ -86,10 +95,32 @@ static void foreachObjectLink(ModifierData *md, Object *ob, ObjectWalkFunc walk,
   walk(userData, ob, &bmd->object, IDWALK_CB_NOP);
 }
 
+static void foreachIDLink(ModifierData *md, Object *ob, IDWalkFunc walk, void *userData)
+{
+  BooleanModifierData *bmd = (BooleanModifierData *)md;
+
+  walk(userData, ob, (ID **)&bmd->collection, IDWALK_CB_NOP);
+
+  foreachObjectLink(md, ob, (ObjectWalkFunc)walk, userData);
+}
+
 static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphContext *ctx)
 {
   BooleanModifierData *bmd = (BooleanModifierData *)md;
-  if (bmd->object != NULL) {
+  if (bmd->operand_type == eBooleanModifierOperandType_Collection) {
+    if (bmd->collection != NULL) {
+      FOREACH_COLLECTION_OBJECT_RECURSIVE_BEGIN (bmd->collection, operand_ob) {
+        if (operand_ob->type == OB_MESH && operand_ob != ctx->object) {
+          DEG_add_object_relation(
+              ctx->node, operand_ob, DEG_OB_COMP_TRANSFORM, "Boolean Modifier");
+          DEG_add_object_relation(
+              ctx->node, operand_ob, DEG_OB_COMP_GEOMETRY, "Boolean Modifier");
+        }
+      }
+      FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
+    }
+  }
+  else if (bmd->object != NULL) {
     DEG_add_object_relation(ctx->node, bmd->object, DEG_OB_COMP_TRANSFORM, "Boolean Modifier");
     DEG_add_object_relation(ctx->node, bmd->object, DEG_OB_COMP_GEOMETRY, "Boolean Modifier");
   }
@@ -153,6 +184,225 @@ static int bm_face_isect_pair(BMFace *f, void *UNUSED(user_data))
   return BM_elem_flag_test(f, BM_FACE_TAG) ? 1 : 0;
 }
 
+/**
+ * Operand faces are the ones without #BM_FACE_TAG,
+ * used when adding operands to a mesh which already has the result of previous ones.
+ */
+static int bm_face_isect_pair_operand(BMFace *f, void *UNUSED(user_data))
+{
+  return BM_elem_flag_test(f, BM_FACE_TAG) ? 0 : 1;
+}
+
+/**
+ * Check if the bounds of \a mesh_operand transformed by \a omat touch the bounds
+ * of the mesh being modified.
+ */
+static bool boolean_operand_bounds_overlap(const float min[3],
+                                           const float max[3],
+                                           float omat[4][4],
+                                           Mesh *mesh_operand,
+                                           const float margin)
+{
+  float operand_min[3], operand_max[3];
+  BoundBox bb;
+
+  INIT_MINMAX(operand_min, operand_max);
+  BKE_mesh_minmax(mesh_operand, operand_min, operand_max);
+  BKE_boundbox_init_from_minmax(&bb, operand_min, operand_max);
+
+  INIT_MINMAX(operand_min, operand_max);
+  for (int i = 0; i < 8; i++) {
+    float co[3];
+    mul_v3_m4v3(co, omat, bb.vec[i]);
+    minmax_v3v3_v3(operand_min, operand_max, co);
+  }
+
+  return (operand_min[0] <= max[0] + margin) && (operand_max[0] >= min[0] - margin) &&
+         (operand_min[1] <= max[1] + margin) && (operand_max[1] >= min[1] - margin) &&
+         (operand_min[2] <= max[2] + margin) && (operand_max[2] >= min[2] - margin);
+}
+
+/**
+ * Add \a mesh_operand to \a bm in the space of \a ob_self,
+ * its faces are the only ones without #BM_FACE_TAG afterwards.
+ */
+static void bm_boolean_operand_add(BMesh *bm,
+                                   Object *ob_self,
+                                   Object *ob_operand,
+                                   Mesh *mesh_operand,
+                                   float omat[4][4])
+{
+  const bool is_flip = (is_negative_m4(ob_self->obmat) != is_negative_m4(ob_operand->obmat));
+  BMIter iter;
+  BMVert *eve;
+  BMFace *efa;
+
+  /* Tag existing geometry, new elements are added without the tags. */
+  BM_mesh_elem_hflag_enable_all(bm, BM_VERT, BM_ELEM_TAG, false);
+  BM_mesh_elem_hflag_enable_all(bm, BM_FACE, BM_FACE_TAG, false);
+
+  BM_mesh_bm_from_me(bm,
+                     mesh_operand,
+                     &((struct BMeshFromMeshParams){
+                         .calc_face_normal = false,
+                     }));
+
+  BM_ITER_MESH (eve, &iter, bm, BM_VERTS_OF_MESH) {
+    if (!BM_elem_flag_test(eve, BM_ELEM_TAG)) {
+      mul_m4_v3(omat, eve->co);
+    }
+  }
+
+  const short ob_src_totcol = ob_operand->totcol;
+  short *material_remap = BLI_array_alloca(material_remap, ob_src_totcol ? ob_src_totcol : 1);
+  BKE_material_remap_object_calc(ob_self, ob_operand, material_remap);
+
+  const int cd_loop_mdisp_offset = CustomData_get_offset(&bm->ldata, CD_MDISPS);
+  BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
+    if (BM_elem_flag_test(efa, BM_FACE_TAG)) {
+      continue;
+    }
+
+    /* Keep the winding pointing outwards when the transform mirrors the operand. */
+    if (UNLIKELY(is_flip)) {
+      BM_face_normal_flip_ex(bm, efa, cd_loop_mdisp_offset, true);
+    }
+    BM_face_normal_update(efa);
+
+    if (LIKELY(efa->mat_nr < ob_src_totcol)) {
+      efa->mat_nr = material_remap[efa->mat_nr];
+    }
+  }
+}
+
+/**
+ * Apply the boolean with every mesh object in #BooleanModifierData.collection.
+ *
+ * All operands are added to one BMesh which is converted back to a mesh only once.
+ * Operands are intersected one after another, a single pass with all of them would
+ * give wrong results where operands overlap each other.
+ */
+static Mesh *collection_boolean_exec(BooleanModifierData *bmd,
+                                     const ModifierEvalContext *ctx,
+                                     Mesh *mesh)
+{
+  Object *object = ctx->object;
+  BMesh *bm = NULL;
+  Mesh *result = mesh;
+  float min[3], max[3];
+  float imat[4][4];
+
+  if (mesh->totpoly == 0) {
+    switch (bmd->operation) {
+      case eBooleanModifierOp_Intersect:
+        return BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+      case eBooleanModifierOp_Difference:
+        return mesh;
+    }
+  }
+
+  INIT_MINMAX(min, max);
+  BKE_mesh_minmax(mesh, min, max);
+  invert_m4_m4(imat, object->obmat);
+
+  bool use_separate = false;
+  bool use_dissolve = true;
+  bool use_island_connect = true;
+
+  /* change for testing */
+  if (G.debug & G_DEBUG) {
+    use_separate = (bmd->bm_flag & eBooleanModifierBMeshFlag_BMesh_Separate) != 0;
+    use_dissolve = (bmd->bm_flag & eBooleanModifierBMeshFlag_BMesh_NoDissolve) == 0;
+    use_island_connect = (bmd->bm_flag & eBooleanModifierBMeshFlag_BMesh_NoConnectRegions) == 0;
+  }
+
+#ifdef DEBUG_TIME
+  TIMEIT_START(boolean_bmesh_collection);
+#endif
+
+  FOREACH_COLLECTION_OBJECT_RECURSIVE_BEGIN (bmd->collection, operand_ob) {
+    if (operand_ob->type != OB_MESH || operand_ob == object) {
+      continue;
+    }
+
+    Mesh *mesh_operand = BKE_modifier_get_evaluated_mesh_from_evaluated_object(operand_ob,
+                                                                               false);
+    if (mesh_operand == NULL) {
+      continue;
+    }
+
+    float omat[4][4];
+    mul_m4_m4m4(omat, imat, operand_ob->obmat);
+
+    /* Operands that can't touch the mesh leave a difference unchanged
+     * and make an intersection empty, there is no need to cut anything. */
+    if ((mesh_operand->totpoly == 0) ||
+        ((bmd->operation != eBooleanModifierOp_Union) &&
+         !boolean_operand_bounds_overlap(min, max, omat, mesh_operand, bmd->double_threshold))) {
+      if (bmd->operation == eBooleanModifierOp_Intersect) {
+        if (bm) {
+          BM_mesh_free(bm);
+        }
+        return BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+      }
+      continue;
+    }
+
+    if (bm == NULL) {
+      const BMAllocTemplate allocsize = BMALLOC_TEMPLATE_FROM_ME(mesh, mesh_operand);
+      bm = BM_mesh_create(&allocsize,
+                          &((struct BMeshCreateParams){
+                              .use_toolflags = false,
+                          }));
+
+      BM_mesh_bm_from_me(bm,
+                         mesh,
+                         &((struct BMeshFromMeshParams){
+                             .calc_face_normal = true,
+                         }));
+    }
+
+    bm_boolean_operand_add(bm, object, operand_ob, mesh_operand, omat);
+
+    const int looptris_tot = poly_to_tri_count(bm->totface, bm->totloop);
+    int tottri;
+    BMLoop *(*looptris)[3];
+
+    looptris = MEM_malloc_arrayN(looptris_tot, sizeof(*looptris), __func__);
+
+    BM_mesh_calc_tessellation_beauty(bm, looptris, &tottri);
+
+    BM_mesh_intersect(bm,
+                      looptris,
+                      tottri,
+                      bm_face_isect_pair_operand,
+                      NULL,
+                      false,
+                      use_separate,
+                      use_dissolve,
+                      use_island_connect,
+                      false,
+                      false,
+                      bmd->operation,
+                      bmd->double_threshold);
+
+    MEM_freeN(looptris);
+  }
+  FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
+
+  if (bm) {
+    result = BKE_mesh_from_bmesh_for_eval_nomain(bm, NULL, mesh);
+    BM_mesh_free(bm);
+    result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  }
+
+#ifdef DEBUG_TIME
+  TIMEIT_END(boolean_bmesh_collection);
+#endif
+
+  return result;
+}
+
 static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mesh *mesh)
 {
   BooleanModifierData *bmd = (BooleanModifierData *)md;
@@ -160,6 +410,13 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mes
 
   Mesh *mesh_other;
 
+  if (bmd->operand_type == eBooleanModifierOperandType_Collection) {
+    if (bmd->collection == NULL) {
+      return result;
+    }
+    return collection_boolean_exec(bmd, ctx, mesh);
+  }
+
   if (bmd->object == NULL) {
     return result;
   }
@@ -360,6 +617,7 @@ ModifierTypeInfo modifierType_Boolean = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ applyModifier,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
@@ -369,7 +627,7 @@ ModifierTypeInfo modifierType_Boolean = {
     /* dependsOnTime */ NULL,
     /* dependsOnNormals */ NULL,
     /* foreachObjectLink */ foreachObjectLink,
-    /* foreachIDLink */ NULL,
+    /* foreachIDLink */ foreachIDLink,
     /* foreachTexLink */ NULL,
     /* freeRuntimeData */ NULL,
 };
@@ -289,6 +289,7 @@ ModifierTypeInfo modifierType_Build = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ applyModifier,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
@@ -24,6 +24,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -38,6 +39,8 @@
 
 #include "DEG_depsgraph_query.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "MOD_util.h"
 
 static void initData(ModifierData *md)
@@ -97,6 +100,201 @@ static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphConte
   }
 }
 
+typedef struct CastUserdata {
+  const CastModifierData *cmd;
+  float (*vertexCos)[3];
+  const float *weights;
+  short flag, type;
+  bool use_ctrl_ob;
+  bool has_radius;
+  float center[3];
+  float mat[4][4], imat[4][4];
+  /* Sphere and cylinder. */
+  float len;
+  /* Cuboid. */
+  float bb[8][3];
+} CastUserdata;
+
+static void sphere_do_task(void *__restrict userdata,
+                           const int i,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const CastUserdata *data = userdata;
+  const CastModifierData *cmd = data->cmd;
+  const short flag = data->flag;
+  float fac = cmd->fac;
+  float facm = 1.0f - fac;
+  float vec[3], tmp_co[3];
+
+  copy_v3_v3(tmp_co, data->vertexCos[i]);
+  if (data->use_ctrl_ob) {
+    if (flag & MOD_CAST_USE_OB_TRANSFORM) {
+      mul_m4_v3(data->mat, tmp_co);
+    }
+    else {
+      sub_v3_v3(tmp_co, data->center);
+    }
+  }
+
+  copy_v3_v3(vec, tmp_co);
+
+  if (data->type == MOD_CAST_TYPE_CYLINDER) {
+    vec[2] = 0.0f;
+  }
+
+  if (data->has_radius) {
+    if (len_v3(vec) > cmd->radius) {
+      return;
+    }
+  }
+
+  if (data->weights) {
+    const float weight = data->weights[i];
+    if (weight == 0.0f) {
+      return;
+    }
+
+    fac *= weight;
+    facm = 1.0f - fac;
+  }
+
+  normalize_v3(vec);
+
+  if (flag & MOD_CAST_X) {
+    tmp_co[0] = fac * vec[0] * data->len + facm * tmp_co[0];
+  }
+  if (flag & MOD_CAST_Y) {
+    tmp_co[1] = fac * vec[1] * data->len + facm * tmp_co[1];
+  }
+  if (flag & MOD_CAST_Z) {
+    tmp_co[2] = fac * vec[2] * data->len + facm * tmp_co[2];
+  }
+
+  if (data->use_ctrl_ob) {
+    if (flag & MOD_CAST_USE_OB_TRANSFORM) {
+      mul_m4_v3(data->imat, tmp_co);
+    }
+    else {
+      add_v3_v3(tmp_co, data->center);
+    }
+  }
+
+  copy_v3_v3(data->vertexCos[i], tmp_co);
+}
+
+static void cuboid_do_task(void *__restrict userdata,
+                           const int i,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const CastUserdata *data = userdata;
+  const CastModifierData *cmd = data->cmd;
+  const short flag = data->flag;
+  float fac = cmd->fac;
+  float facm = 1.0f - fac;
+  int octant, coord;
+  float d[3], dmax, apex[3], fbb;
+  float tmp_co[3];
+
+  copy_v3_v3(tmp_co, data->vertexCos[i]);
+  if (data->use_ctrl_ob) {
+    if (flag & MOD_CAST_USE_OB_TRANSFORM) {
+      mul_m4_v3(data->mat, tmp_co);
+    }
+    else {
+      sub_v3_v3(tmp_co, data->center);
+    }
+  }
+
+  if (data->has_radius) {
+    if (fabsf(tmp_co[0]) > cmd->radius || fabsf(tmp_co[1]) > cmd->radius ||
+        fabsf(tmp_co[2]) > cmd->radius) {
+      return;
+    }
+  }
+
+  if (data->weights) {
+    const float weight = data->weights[i];
+    if (weight == 0.0f) {
+      return;
+    }
+
+    fac *= weight;
+    facm = 1.0f - fac;
+  }
+
+  /* The algo used to project the vertices to their
+   * bounding box (bb) is pretty simple:
+   * for each vertex v:
+   * 1) find in which octant v is in;
+   * 2) find which outer "wall" of that octant is closer to v;
+   * 3) calculate factor (var fbb) to project v to that wall;
+   * 4) project. */
+
+  /* find in which octant this vertex is in */
+  octant = 0;
+  if (tmp_co[0] > 0.0f) {
+    octant += 1;
+  }
+  if (tmp_co[1] > 0.0f) {
+    octant += 2;
+  }
+  if (tmp_co[2] > 0.0f) {
+    octant += 4;
+  }
+
+  /* apex is the bb's vertex at the chosen octant */
+  copy_v3_v3(apex, data->bb[octant]);
+
+  /* find which bb plane is closest to this vertex ... */
+  d[0] = tmp_co[0] / apex[0];
+  d[1] = tmp_co[1] / apex[1];
+  d[2] = tmp_co[2] / apex[2];
+
+  /* ... (the closest has the higher (closer to 1) d value) */
+  dmax = d[0];
+  coord = 0;
+  if (d[1] > dmax) {
+    dmax = d[1];
+    coord = 1;
+  }
+  if (d[2] > dmax) {
+    /* dmax = d[2]; */ /* commented, we don't need it */
+    coord = 2;
+  }
+
+  /* ok, now we know which coordinate of the vertex to use */
+
+  if (fabsf(tmp_co[coord]) < FLT_EPSILON) { /* avoid division by zero */
+    return;
+  }
+
+  /* finally, this is the factor we wanted, to project the vertex
+   * to its bounding box (bb) */
+  fbb = apex[coord] / tmp_co[coord];
+
+  /* calculate the new vertex position */
+  if (flag & MOD_CAST_X) {
+    tmp_co[0] = facm * tmp_co[0] + fac * tmp_co[0] * fbb;
+  }
+  if (flag & MOD_CAST_Y) {
+    tmp_co[1] = facm * tmp_co[1] + fac * tmp_co[1] * fbb;
+  }
+  if (flag & MOD_CAST_Z) {
+    tmp_co[2] = facm * tmp_co[2] + fac * tmp_co[2] * fbb;
+  }
+
+  if (data->use_ctrl_ob) {
+    if (flag & MOD_CAST_USE_OB_TRANSFORM) {
+      mul_m4_v3(data->imat, tmp_co);
+    }
+    else {
+      add_v3_v3(tmp_co, data->center);
+    }
+  }
+
+  copy_v3_v3(data->vertexCos[i], tmp_co);
+}
+
 static void sphere_do(CastModifierData *cmd,
                       const ModifierEvalContext *UNUSED(ctx),
                       Object *ob,
@@ -112,10 +310,7 @@ static void sphere_do(CastModifierData *cmd,
   bool has_radius = false;
   short flag, type;
   float len = 0.0f;
-  float fac = cmd->fac;
-  float facm = 1.0f - fac;
-  const float fac_orig = fac;
-  float vec[3], center[3] = {0.0f, 0.0f, 0.0f};
+  float center[3] = {0.0f, 0.0f, 0.0f};
   float mat[4][4], imat[4][4];
 
   flag = cmd->flag;
@@ -172,64 +367,29 @@ static void sphere_do(CastModifierData *cmd,
     }
   }
 
-  for (i = 0; i < numVerts; i++) {
-    float tmp_co[3];
-
-    copy_v3_v3(tmp_co, vertexCos[i]);
-    if (ctrl_ob) {
-      if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-        mul_m4_v3(mat, tmp_co);
-      }
-      else {
-        sub_v3_v3(tmp_co, center);
-      }
-    }
-
-    copy_v3_v3(vec, tmp_co);
-
-    if (type == MOD_CAST_TYPE_CYLINDER) {
-      vec[2] = 0.0f;
-    }
-
-    if (has_radius) {
-      if (len_v3(vec) > cmd->radius) {
-        continue;
-      }
-    }
-
-    if (dvert) {
-      const float weight = defvert_find_weight(&dvert[i], defgrp_index);
-      if (weight == 0.0f) {
-        continue;
-      }
-
-      fac = fac_orig * weight;
-      facm = 1.0f - fac;
-    }
-
-    normalize_v3(vec);
-
-    if (flag & MOD_CAST_X) {
-      tmp_co[0] = fac * vec[0] * len + facm * tmp_co[0];
-    }
-    if (flag & MOD_CAST_Y) {
-      tmp_co[1] = fac * vec[1] * len + facm * tmp_co[1];
-    }
-    if (flag & MOD_CAST_Z) {
-      tmp_co[2] = fac * vec[2] * len + facm * tmp_co[2];
-    }
+  float *weights = (dvert != NULL) ? MOD_get_vgroup_weights(dvert, defgrp_index, numVerts, false) :
+                                     NULL;
+  CastUserdata data = {NULL};
+  data.cmd = cmd;
+  data.vertexCos = vertexCos;
+  data.weights = weights;
+  data.flag = flag;
+  data.type = type;
+  data.use_ctrl_ob = (ctrl_ob != NULL);
+  data.has_radius = has_radius;
+  data.len = len;
+  copy_v3_v3(data.center, center);
+  if (ctrl_ob && (flag & MOD_CAST_USE_OB_TRANSFORM)) {
+    copy_m4_m4(data.mat, mat);
+    copy_m4_m4(data.imat, imat);
+  }
 
-    if (ctrl_ob) {
-      if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-        mul_m4_v3(imat, tmp_co);
-      }
-      else {
-        add_v3_v3(tmp_co, center);
-      }
-    }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numVerts > 1024);
+  BLI_task_parallel_range(0, numVerts, &data, sphere_do_task, &settings);
 
-    copy_v3_v3(vertexCos[i], tmp_co);
-  }
+  MEM_SAFE_FREE(weights);
 }
 
 static void cuboid_do(CastModifierData *cmd,
@@ -245,9 +405,6 @@ static void cuboid_do(CastModifierData *cmd,
   int i, defgrp_index;
   bool has_radius = false;
   short flag;
-  float fac = cmd->fac;
-  float facm = 1.0f - fac;
-  const float fac_orig = fac;
   float min[3], max[3], bb[8][3];
   float center[3] = {0.0f, 0.0f, 0.0f};
   float mat[4][4], imat[4][4];
@@ -341,111 +498,29 @@ static void cuboid_do(CastModifierData *cmd,
   bb[0][2] = bb[1][2] = bb[2][2] = bb[3][2] = min[2];
   bb[4][2] = bb[5][2] = bb[6][2] = bb[7][2] = max[2];
 
-  /* ready to apply the effect, one vertex at a time */
-  for (i = 0; i < numVerts; i++) {
-    int octant, coord;
-    float d[3], dmax, apex[3], fbb;
-    float tmp_co[3];
-
-    copy_v3_v3(tmp_co, vertexCos[i]);
-    if (ctrl_ob) {
-      if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-        mul_m4_v3(mat, tmp_co);
-      }
-      else {
-        sub_v3_v3(tmp_co, center);
-      }
-    }
-
-    if (has_radius) {
-      if (fabsf(tmp_co[0]) > cmd->radius || fabsf(tmp_co[1]) > cmd->radius ||
-          fabsf(tmp_co[2]) > cmd->radius) {
-        continue;
-      }
-    }
-
-    if (dvert) {
-      const float weight = defvert_find_weight(&dvert[i], defgrp_index);
-      if (weight == 0.0f) {
-        continue;
-      }
-
-      fac = fac_orig * weight;
-      facm = 1.0f - fac;
-    }
-
-    /* The algo used to project the vertices to their
-     * bounding box (bb) is pretty simple:
-     * for each vertex v:
-     * 1) find in which octant v is in;
-     * 2) find which outer "wall" of that octant is closer to v;
-     * 3) calculate factor (var fbb) to project v to that wall;
-     * 4) project. */
-
-    /* find in which octant this vertex is in */
-    octant = 0;
-    if (tmp_co[0] > 0.0f) {
-      octant += 1;
-    }
-    if (tmp_co[1] > 0.0f) {
-      octant += 2;
-    }
-    if (tmp_co[2] > 0.0f) {
-      octant += 4;
-    }
-
-    /* apex is the bb's vertex at the chosen octant */
-    copy_v3_v3(apex, bb[octant]);
-
-    /* find which bb plane is closest to this vertex ... */
-    d[0] = tmp_co[0] / apex[0];
-    d[1] = tmp_co[1] / apex[1];
-    d[2] = tmp_co[2] / apex[2];
-
-    /* ... (the closest has the higher (closer to 1) d value) */
-    dmax = d[0];
-    coord = 0;
-    if (d[1] > dmax) {
-      dmax = d[1];
-      coord = 1;
-    }
-    if (d[2] > dmax) {
-      /* dmax = d[2]; */ /* commented, we don't need it */
-      coord = 2;
-    }
-
-    /* ok, now we know which coordinate of the vertex to use */
-
-    if (fabsf(tmp_co[coord]) < FLT_EPSILON) { /* avoid division by zero */
-      continue;
-    }
-
-    /* finally, this is the factor we wanted, to project the vertex
-     * to its bounding box (bb) */
-    fbb = apex[coord] / tmp_co[coord];
-
-    /* calculate the new vertex position */
-    if (flag & MOD_CAST_X) {
-      tmp_co[0] = facm * tmp_co[0] + fac * tmp_co[0] * fbb;
-    }
-    if (flag & MOD_CAST_Y) {
-      tmp_co[1] = facm * tmp_co[1] + fac * tmp_co[1] * fbb;
-    }
-    if (flag & MOD_CAST_Z) {
-      tmp_co[2] = facm * tmp_co[2] + fac * tmp_co[2] * fbb;
-    }
+  float *weights = (dvert != NULL) ? MOD_get_vgroup_weights(dvert, defgrp_index, numVerts, false) :
+                                     NULL;
+  CastUserdata data = {NULL};
+  data.cmd = cmd;
+  data.vertexCos = vertexCos;
+  data.weights = weights;
+  data.flag = flag;
+  data.use_ctrl_ob = (ctrl_ob != NULL);
+  data.has_radius = has_radius;
+  copy_v3_v3(data.center, center);
+  if (ctrl_ob && (flag & MOD_CAST_USE_OB_TRANSFORM)) {
+    copy_m4_m4(data.mat, mat);
+    copy_m4_m4(data.imat, imat);
+  }
+  memcpy(data.bb, bb, sizeof(bb));
 
-    if (ctrl_ob) {
-      if (flag & MOD_CAST_USE_OB_TRANSFORM) {
-        mul_m4_v3(imat, tmp_co);
-      }
-      else {
-        add_v3_v3(tmp_co, center);
-      }
-    }
+  /* ready to apply the effect, one vertex at a time */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numVerts > 1024);
+  BLI_task_parallel_range(0, numVerts, &data, cuboid_do_task, &settings);
 
-    copy_v3_v3(vertexCos[i], tmp_co);
-  }
+  MEM_SAFE_FREE(weights);
 }
 
 static void deformVerts(ModifierData *md,
@@ -514,6 +589,7 @@ ModifierTypeInfo modifierType_Cast = {
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
@@ -255,6 +255,7 @@ ModifierTypeInfo modifierType_Collision = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
@@ -26,6 +26,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_scene_types.h"
 #include "DNA_meshdata_types.h"
@@ -36,6 +37,7 @@
 
 #include "BKE_deform.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
 #include "BKE_editmesh.h"
 #include "BKE_library.h"
 
@@ -53,9 +55,6 @@
 #  include "PIL_time_utildefines.h"
 #endif
 
-/* minor optimization, calculate this inline */
-#define USE_TANGENT_CALC_INLINE
-
 static void initData(ModifierData *md)
 {
   CorrectiveSmoothModifierData *csmd = (CorrectiveSmoothModifierData *)md;
@@ -169,197 +168,162 @@ static void mesh_get_boundaries(Mesh *mesh, float *smooth_weights)
 }
 
 /* -------------------------------------------------------------------- */
-/* Simple Weighted Smoothing
+/* Smoothing
  *
- * (average of surrounding verts)
- */
-static void smooth_iter__simple(CorrectiveSmoothModifierData *csmd,
-                                Mesh *mesh,
-                                float (*vertexCos)[3],
-                                uint numVerts,
-                                const float *smooth_weights,
-                                uint iterations)
-{
-  const float lambda = csmd->lambda;
-  uint i;
+ * Every vertex gathers from its neighbors, so all vertices of an iteration can be smoothed in
+ * parallel. The positions of the previous iteration are read from one buffer while the new
+ * positions are written to another one. Neighbors are stored in the same order as the edges,
+ * so the sums are accumulated in the same order as when scattering over the edges. */
 
-  const uint numEdges = (uint)mesh->totedge;
-  const MEdge *edges = mesh->medge;
-  float *vertex_edge_count_div;
+typedef struct SmoothIterData {
+  const MeshVertAdjacency *adjacency;
+  const float *smooth_weights;
+  float lambda;
 
-  struct SmoothingData_Simple {
-    float delta[3];
-  } *smooth_data = MEM_calloc_arrayN(numVerts, sizeof(*smooth_data), __func__);
+  /* Simple smoothing: (lambda * weight / neighbors) for every vertex. */
+  const float *vertex_edge_count_div;
 
-  vertex_edge_count_div = MEM_calloc_arrayN(numVerts, sizeof(float), __func__);
+  const float (*vertexCos_src)[3];
+  float (*vertexCos_dst)[3];
+} SmoothIterData;
 
-  /* calculate as floats to avoid int->float conversion in #smooth_iter */
-  for (i = 0; i < numEdges; i++) {
-    vertex_edge_count_div[edges[i].v1] += 1.0f;
-    vertex_edge_count_div[edges[i].v2] += 1.0f;
-  }
-
-  /* a little confusing, but we can include 'lambda' and smoothing weight
-   * here to avoid multiplying for every iteration */
-  if (smooth_weights == NULL) {
-    for (i = 0; i < numVerts; i++) {
-      vertex_edge_count_div[i] = lambda * (vertex_edge_count_div[i] ?
-                                               (1.0f / vertex_edge_count_div[i]) :
-                                               1.0f);
-    }
-  }
-  else {
-    for (i = 0; i < numVerts; i++) {
-      vertex_edge_count_div[i] = smooth_weights[i] * lambda *
-                                 (vertex_edge_count_div[i] ? (1.0f / vertex_edge_count_div[i]) :
-                                                             1.0f);
-    }
-  }
-
-  /* -------------------------------------------------------------------- */
-  /* Main Smoothing Loop */
-
-  while (iterations--) {
-    for (i = 0; i < numEdges; i++) {
-      struct SmoothingData_Simple *sd_v1;
-      struct SmoothingData_Simple *sd_v2;
-      float edge_dir[3];
-
-      sub_v3_v3v3(edge_dir, vertexCos[edges[i].v2], vertexCos[edges[i].v1]);
-
-      sd_v1 = &smooth_data[edges[i].v1];
-      sd_v2 = &smooth_data[edges[i].v2];
-
-      add_v3_v3(sd_v1->delta, edge_dir);
-      sub_v3_v3(sd_v2->delta, edge_dir);
-    }
-
-    for (i = 0; i < numVerts; i++) {
-      struct SmoothingData_Simple *sd = &smooth_data[i];
-      madd_v3_v3fl(vertexCos[i], sd->delta, vertex_edge_count_div[i]);
-      /* zero for the next iteration (saves memset on entire array) */
-      memset(sd, 0, sizeof(*sd));
-    }
+/* Simple Weighted Smoothing
+ *
+ * (average of surrounding verts)
+ */
+static void smooth_iter__simple_task(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SmoothIterData *data = userdata;
+  const int *neighbors = data->adjacency->vert_verts;
+  const int neighbors_end = data->adjacency->vert_verts_offset[i + 1];
+  const float(*vertexCos)[3] = data->vertexCos_src;
+  const float *co = vertexCos[i];
+  float delta[3] = {0.0f, 0.0f, 0.0f};
+  int j;
+
+  for (j = data->adjacency->vert_verts_offset[i]; j < neighbors_end; j++) {
+    float edge_dir[3];
+    sub_v3_v3v3(edge_dir, vertexCos[neighbors[j]], co);
+    add_v3_v3(delta, edge_dir);
   }
 
-  MEM_freeN(vertex_edge_count_div);
-  MEM_freeN(smooth_data);
+  madd_v3_v3v3fl(data->vertexCos_dst[i], co, delta, data->vertex_edge_count_div[i]);
 }
 
-/* -------------------------------------------------------------------- */
 /* Edge-Length Weighted Smoothing
  */
-static void smooth_iter__length_weight(CorrectiveSmoothModifierData *csmd,
-                                       Mesh *mesh,
-                                       float (*vertexCos)[3],
-                                       uint numVerts,
-                                       const float *smooth_weights,
-                                       uint iterations)
+static void smooth_iter__length_weight_task(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
 {
   const float eps = FLT_EPSILON * 10.0f;
-  const uint numEdges = (uint)mesh->totedge;
-  /* note: the way this smoothing method works, its approx half as strong as the simple-smooth,
-   * and 2.0 rarely spikes, double the value for consistent behavior. */
-  const float lambda = csmd->lambda * 2.0f;
-  const MEdge *edges = mesh->medge;
-  float *vertex_edge_count;
-  uint i;
-
-  struct SmoothingData_Weighted {
-    float delta[3];
-    float edge_length_sum;
-  } *smooth_data = MEM_calloc_arrayN(numVerts, sizeof(*smooth_data), __func__);
-
-  /* calculate as floats to avoid int->float conversion in #smooth_iter */
-  vertex_edge_count = MEM_calloc_arrayN(numVerts, sizeof(float), __func__);
-  for (i = 0; i < numEdges; i++) {
-    vertex_edge_count[edges[i].v1] += 1.0f;
-    vertex_edge_count[edges[i].v2] += 1.0f;
+  const SmoothIterData *data = userdata;
+  const int *neighbors = data->adjacency->vert_verts;
+  const int neighbors_start = data->adjacency->vert_verts_offset[i];
+  const int neighbors_end = data->adjacency->vert_verts_offset[i + 1];
+  const float(*vertexCos)[3] = data->vertexCos_src;
+  const float *co = vertexCos[i];
+  float delta[3] = {0.0f, 0.0f, 0.0f};
+  float edge_length_sum = 0.0f;
+  int j;
+
+  for (j = neighbors_start; j < neighbors_end; j++) {
+    float edge_dir[3];
+    float edge_dist;
+
+    sub_v3_v3v3(edge_dir, vertexCos[neighbors[j]], co);
+    edge_dist = len_v3(edge_dir);
+
+    /* weight by distance */
+    madd_v3_v3fl(delta, edge_dir, edge_dist);
+    edge_length_sum += edge_dist;
   }
 
-  /* -------------------------------------------------------------------- */
-  /* Main Smoothing Loop */
-
-  while (iterations--) {
-    for (i = 0; i < numEdges; i++) {
-      struct SmoothingData_Weighted *sd_v1;
-      struct SmoothingData_Weighted *sd_v2;
-      float edge_dir[3];
-      float edge_dist;
-
-      sub_v3_v3v3(edge_dir, vertexCos[edges[i].v2], vertexCos[edges[i].v1]);
-      edge_dist = len_v3(edge_dir);
-
-      /* weight by distance */
-      mul_v3_fl(edge_dir, edge_dist);
-
-      sd_v1 = &smooth_data[edges[i].v1];
-      sd_v2 = &smooth_data[edges[i].v2];
-
-      add_v3_v3(sd_v1->delta, edge_dir);
-      sub_v3_v3(sd_v2->delta, edge_dir);
-
-      sd_v1->edge_length_sum += edge_dist;
-      sd_v2->edge_length_sum += edge_dist;
-    }
-
-    if (smooth_weights == NULL) {
-      /* fast-path */
-      for (i = 0; i < numVerts; i++) {
-        struct SmoothingData_Weighted *sd = &smooth_data[i];
-        /* Divide by sum of all neighbor distances (weighted) and amount of neighbors,
-         * (mean average). */
-        const float div = sd->edge_length_sum * vertex_edge_count[i];
-        if (div > eps) {
-#if 0
-          /* first calculate the new location */
-          mul_v3_fl(sd->delta, 1.0f / div);
-          /* then interpolate */
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda);
-#else
-          /* do this in one step */
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda / div);
-#endif
-        }
-        /* zero for the next iteration (saves memset on entire array) */
-        memset(sd, 0, sizeof(*sd));
-      }
-    }
-    else {
-      for (i = 0; i < numVerts; i++) {
-        struct SmoothingData_Weighted *sd = &smooth_data[i];
-        const float div = sd->edge_length_sum * vertex_edge_count[i];
-        if (div > eps) {
-          const float lambda_w = lambda * smooth_weights[i];
-          madd_v3_v3fl(vertexCos[i], sd->delta, lambda_w / div);
-        }
-
-        memset(sd, 0, sizeof(*sd));
-      }
-    }
+  /* Divide by sum of all neighbor distances (weighted) and amount of neighbors,
+   * (mean average). */
+  const float div = edge_length_sum * (float)(neighbors_end - neighbors_start);
+  if (div > eps) {
+    const float lambda_w = data->smooth_weights ? data->lambda * data->smooth_weights[i] :
+                                                  data->lambda;
+    /* first calculate the new location and then interpolate, in one step */
+    madd_v3_v3v3fl(data->vertexCos_dst[i], co, delta, lambda_w / div);
+  }
+  else {
+    copy_v3_v3(data->vertexCos_dst[i], co);
   }
-
-  MEM_freeN(vertex_edge_count);
-  MEM_freeN(smooth_data);
 }
 
 static void smooth_iter(CorrectiveSmoothModifierData *csmd,
-                        Mesh *mesh,
+                        const MeshVertAdjacency *adjacency,
                         float (*vertexCos)[3],
                         uint numVerts,
                         const float *smooth_weights,
                         uint iterations)
 {
+  TaskParallelRangeFunc smooth_iter_task;
+  float *vertex_edge_count_div = NULL;
+  uint i;
+
+  SmoothIterData data = {
+      .adjacency = adjacency,
+      .smooth_weights = smooth_weights,
+  };
+
   switch (csmd->smooth_type) {
     case MOD_CORRECTIVESMOOTH_SMOOTH_LENGTH_WEIGHT:
-      smooth_iter__length_weight(csmd, mesh, vertexCos, numVerts, smooth_weights, iterations);
+      /* note: the way this smoothing method works, its approx half as strong as the
+       * simple-smooth, and 2.0 rarely spikes, double the value for consistent behavior. */
+      data.lambda = csmd->lambda * 2.0f;
+      smooth_iter_task = smooth_iter__length_weight_task;
       break;
 
     /* case MOD_CORRECTIVESMOOTH_SMOOTH_SIMPLE: */
     default:
-      smooth_iter__simple(csmd, mesh, vertexCos, numVerts, smooth_weights, iterations);
+      data.lambda = csmd->lambda;
+      smooth_iter_task = smooth_iter__simple_task;
+
+      /* a little confusing, but we can include 'lambda' and smoothing weight
+       * here to avoid multiplying for every iteration */
+      vertex_edge_count_div = MEM_malloc_arrayN(numVerts, sizeof(float), __func__);
+      for (i = 0; i < numVerts; i++) {
+        const int count = adjacency->vert_verts_offset[i + 1] -
+                          adjacency->vert_verts_offset[i];
+        const float count_div = count ? (1.0f / (float)count) : 1.0f;
+        vertex_edge_count_div[i] = smooth_weights ? smooth_weights[i] * data.lambda * count_div :
+                                                    data.lambda * count_div;
+      }
+      data.vertex_edge_count_div = vertex_edge_count_div;
       break;
   }
+
+  float(*vertexCos_tmp)[3] = MEM_malloc_arrayN(numVerts, sizeof(float[3]), __func__);
+  float(*vertexCos_src)[3] = vertexCos;
+  float(*vertexCos_dst)[3] = vertexCos_tmp;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  /* -------------------------------------------------------------------- */
+  /* Main Smoothing Loop */
+
+  while (iterations--) {
+    data.vertexCos_src = (const float(*)[3])vertexCos_src;
+    data.vertexCos_dst = vertexCos_dst;
+    BLI_task_parallel_range(0, (int)numVerts, &data, smooth_iter_task, &settings);
+    float(*vertexCos_swap)[3] = vertexCos_src;
+    vertexCos_src = vertexCos_dst;
+    vertexCos_dst = vertexCos_swap;
+  }
+
+  if (vertexCos_src != vertexCos) {
+    memcpy(vertexCos, vertexCos_src, sizeof(float[3]) * numVerts);
+  }
+
+  MEM_freeN(vertexCos_tmp);
+  MEM_SAFE_FREE(vertex_edge_count_div);
 }
 
 static void smooth_verts(CorrectiveSmoothModifierData *csmd,
@@ -391,7 +355,12 @@ static void smooth_verts(CorrectiveSmoothModifierData *csmd,
     }
   }
 
-  smooth_iter(csmd, mesh, vertexCos, numVerts, smooth_weights, (uint)csmd->repeat);
+  smooth_iter(csmd,
+              BKE_mesh_runtime_vert_adjacency_ensure(mesh),
+              vertexCos,
+              numVerts,
+              smooth_weights,
+              (uint)csmd->repeat);
 
   if (smooth_weights) {
     MEM_freeN(smooth_weights);
@@ -452,54 +421,68 @@ static void calc_tangent_loop_accum(const float v_dir_prev[3],
   }
 }
 
-static void calc_tangent_spaces(Mesh *mesh, float (*vertexCos)[3], float (*r_tangent_spaces)[3][3])
+typedef struct CalcTangentSpacesData {
+  const MPoly *mpoly;
+  const MLoop *mloop;
+  const MeshVertAdjacency *adjacency;
+  const float (*vertexCos)[3];
+  float (*r_tangent_spaces)[3][3];
+} CalcTangentSpacesData;
+
+static void calc_tangent_spaces_task(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  const uint mpoly_num = (uint)mesh->totpoly;
-#ifndef USE_TANGENT_CALC_INLINE
-  const uint mvert_num = (uint)dm->getNumVerts(dm);
-#endif
-  const MPoly *mpoly = mesh->mpoly;
-  const MLoop *mloop = mesh->mloop;
-  uint i;
-
-  for (i = 0; i < mpoly_num; i++) {
-    const MPoly *mp = &mpoly[i];
-    const MLoop *l_next = &mloop[mp->loopstart];
-    const MLoop *l_term = l_next + mp->totloop;
-    const MLoop *l_prev = l_term - 2;
-    const MLoop *l_curr = l_term - 1;
+  const CalcTangentSpacesData *data = userdata;
+  const MeshVertAdjacency *adjacency = data->adjacency;
+  const MLoop *mloop = data->mloop;
+  const float(*vertexCos)[3] = data->vertexCos;
+  float(*ts)[3] = data->r_tangent_spaces[i];
+  int j;
+
+  zero_m3(ts);
+
+  /* Loops are in the order of the polygons, same as when accumulating over all polygons. */
+  for (j = adjacency->vert_loops_offset[i]; j < adjacency->vert_loops_offset[i + 1]; j++) {
+    const int l_curr = adjacency->vert_loops[j];
+    const MPoly *mp = &data->mpoly[adjacency->loop_poly[l_curr]];
+    const int l_first = mp->loopstart;
+    const int l_last = mp->loopstart + mp->totloop - 1;
+    const int l_prev = (l_curr == l_first) ? l_last : l_curr - 1;
+    const int l_next = (l_curr == l_last) ? l_first : l_curr + 1;
 
     /* loop directions */
     float v_dir_prev[3], v_dir_next[3];
 
-    /* needed entering the loop */
-    sub_v3_v3v3(v_dir_prev, vertexCos[l_prev->v], vertexCos[l_curr->v]);
+    sub_v3_v3v3(v_dir_prev, vertexCos[mloop[l_prev].v], vertexCos[i]);
     normalize_v3(v_dir_prev);
 
-    for (; l_next != l_term; l_prev = l_curr, l_curr = l_next, l_next++) {
-      float(*ts)[3] = r_tangent_spaces[l_curr->v];
-
-      /* re-use the previous value */
-#if 0
-      sub_v3_v3v3(v_dir_prev, vertexCos[l_prev->v], vertexCos[l_curr->v]);
-      normalize_v3(v_dir_prev);
-#endif
-      sub_v3_v3v3(v_dir_next, vertexCos[l_curr->v], vertexCos[l_next->v]);
-      normalize_v3(v_dir_next);
-
-      calc_tangent_loop_accum(v_dir_prev, v_dir_next, ts);
+    sub_v3_v3v3(v_dir_next, vertexCos[i], vertexCos[mloop[l_next].v]);
+    normalize_v3(v_dir_next);
 
-      copy_v3_v3(v_dir_prev, v_dir_next);
-    }
+    calc_tangent_loop_accum(v_dir_prev, v_dir_next, ts);
   }
 
-  /* do inline */
-#ifndef USE_TANGENT_CALC_INLINE
-  for (i = 0; i < mvert_num; i++) {
-    float(*ts)[3] = r_tangent_spaces[i];
-    calc_tangent_ortho(ts);
-  }
-#endif
+  calc_tangent_ortho(ts);
+}
+
+static void calc_tangent_spaces(Mesh *mesh,
+                                const float (*vertexCos)[3],
+                                uint numVerts,
+                                float (*r_tangent_spaces)[3][3])
+{
+  CalcTangentSpacesData data = {
+      .mpoly = mesh->mpoly,
+      .mloop = mesh->mloop,
+      .adjacency = BKE_mesh_runtime_vert_adjacency_ensure(mesh),
+      .vertexCos = vertexCos,
+      .r_tangent_spaces = r_tangent_spaces,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, (int)numVerts, &data, calc_tangent_spaces_task, &settings);
 }
 
 static void store_cache_settings(CorrectiveSmoothModifierData *csmd)
@@ -519,6 +502,39 @@ static bool cache_settings_equal(CorrectiveSmoothModifierData *csmd)
           csmd->delta_cache.rest_source == csmd->rest_source);
 }
 
+typedef struct DeltasData {
+  const float (*tangent_spaces)[3][3];
+  const float (*rest_coords)[3];
+  const float (*smooth_vertex_coords)[3];
+  float (*deltas)[3];
+  float (*vertexCos)[3];
+} DeltasData;
+
+static void calc_deltas_task(void *__restrict userdata,
+                             const int i,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DeltasData *data = userdata;
+  float imat[3][3], delta[3];
+
+  sub_v3_v3v3(delta, data->rest_coords[i], data->smooth_vertex_coords[i]);
+  if (UNLIKELY(!invert_m3_m3(imat, data->tangent_spaces[i]))) {
+    transpose_m3_m3(imat, data->tangent_spaces[i]);
+  }
+  mul_v3_m3v3(data->deltas[i], imat, delta);
+}
+
+static void apply_deltas_task(void *__restrict userdata,
+                              const int i,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DeltasData *data = userdata;
+  float delta[3];
+
+  mul_v3_m3v3(delta, data->tangent_spaces[i], data->deltas[i]);
+  add_v3_v3(data->vertexCos[i], delta);
+}
+
 /**
  * This calculates #CorrectiveSmoothModifierData.delta_cache
  * It's not run on every update (during animation for example).
@@ -532,9 +548,8 @@ static void calc_deltas(CorrectiveSmoothModifierData *csmd,
 {
   float(*smooth_vertex_coords)[3] = MEM_dupallocN(rest_coords);
   float(*tangent_spaces)[3][3];
-  uint i;
 
-  tangent_spaces = MEM_calloc_arrayN(numVerts, sizeof(float[3][3]), __func__);
+  tangent_spaces = MEM_malloc_arrayN(numVerts, sizeof(float[3][3]), __func__);
 
   if (csmd->delta_cache.totverts != numVerts) {
     MEM_SAFE_FREE(csmd->delta_cache.deltas);
@@ -548,21 +563,20 @@ static void calc_deltas(CorrectiveSmoothModifierData *csmd,
 
   smooth_verts(csmd, mesh, dvert, defgrp_index, smooth_vertex_coords, numVerts);
 
-  calc_tangent_spaces(mesh, smooth_vertex_coords, tangent_spaces);
+  calc_tangent_spaces(
+      mesh, (const float(*)[3])smooth_vertex_coords, numVerts, tangent_spaces);
 
-  for (i = 0; i < numVerts; i++) {
-    float imat[3][3], delta[3];
+  DeltasData data = {
+      .tangent_spaces = (const float(*)[3][3])tangent_spaces,
+      .rest_coords = rest_coords,
+      .smooth_vertex_coords = (const float(*)[3])smooth_vertex_coords,
+      .deltas = csmd->delta_cache.deltas,
+  };
 
-#ifdef USE_TANGENT_CALC_INLINE
-    calc_tangent_ortho(tangent_spaces[i]);
-#endif
-
-    sub_v3_v3v3(delta, rest_coords[i], smooth_vertex_coords[i]);
-    if (UNLIKELY(!invert_m3_m3(imat, tangent_spaces[i]))) {
-      transpose_m3_m3(imat, tangent_spaces[i]);
-    }
-    mul_v3_m3v3(csmd->delta_cache.deltas[i], imat, delta);
-  }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, (int)numVerts, &data, calc_deltas_task, &settings);
 
   MEM_freeN(tangent_spaces);
   MEM_freeN(smooth_vertex_coords);
@@ -693,25 +707,23 @@ static void correctivesmooth_modifier_do(ModifierData *md,
   smooth_verts(csmd, mesh, dvert, defgrp_index, vertexCos, numVerts);
 
   {
-    uint i;
-
     float(*tangent_spaces)[3][3];
 
-    /* calloc, since values are accumulated */
-    tangent_spaces = MEM_calloc_arrayN(numVerts, sizeof(float[3][3]), __func__);
+    /* Tangent spaces are calculated from all positions before applying any delta. */
+    tangent_spaces = MEM_malloc_arrayN(numVerts, sizeof(float[3][3]), __func__);
 
-    calc_tangent_spaces(mesh, vertexCos, tangent_spaces);
+    calc_tangent_spaces(mesh, (const float(*)[3])vertexCos, numVerts, tangent_spaces);
 
-    for (i = 0; i < numVerts; i++) {
-      float delta[3];
+    DeltasData data = {
+        .tangent_spaces = (const float(*)[3][3])tangent_spaces,
+        .deltas = csmd->delta_cache.deltas,
+        .vertexCos = vertexCos,
+    };
 
-#ifdef USE_TANGENT_CALC_INLINE
-      calc_tangent_ortho(tangent_spaces[i]);
-#endif
-
-      mul_v3_m3v3(delta, tangent_spaces[i], csmd->delta_cache.deltas[i]);
-      add_v3_v3(vertexCos[i], delta);
-    }
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, (int)numVerts, &data, apply_deltas_task, &settings);
 
     MEM_freeN(tangent_spaces);
   }
@@ -776,6 +788,7 @@ ModifierTypeInfo modifierType_CorrectiveSmooth = {
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
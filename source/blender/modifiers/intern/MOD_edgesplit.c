@@ -143,6 +143,7 @@ ModifierTypeInfo modifierType_EdgeSplit = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ applyModifier,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
@@ -23,7 +23,9 @@
 
 #include "BLI_utildefines.h"
 
+#include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -125,9 +127,16 @@ static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphConte
 
 struct HookData_cb {
   float (*vertexCos)[3];
+  int verts_num;
 
   MDeformVert *dvert;
   int defgrp_index;
+  /* Weights of all vertices, when looked up beforehand. */
+  float *weights;
+
+  /* Apply to vertices with one of the original indices in the mask. */
+  const int *origindex;
+  BLI_bitmap *origindex_mask;
 
   struct CurveMapping *curfalloff;
 
@@ -211,7 +220,7 @@ static float hook_falloff(const struct HookData_cb *hd, const float len_sq)
   }
 }
 
-static void hook_co_apply(struct HookData_cb *hd, const int j)
+static void hook_co_apply(const struct HookData_cb *hd, const int j)
 {
   float *co = hd->vertexCos[j];
   float fac;
@@ -235,7 +244,10 @@ static void hook_co_apply(struct HookData_cb *hd, const int j)
   }
 
   if (fac) {
-    if (hd->dvert) {
+    if (hd->weights) {
+      fac *= hd->weights[j];
+    }
+    else if (hd->dvert) {
       fac *= defvert_find_weight(&hd->dvert[j], hd->defgrp_index);
     }
 
@@ -247,6 +259,34 @@ static void hook_co_apply(struct HookData_cb *hd, const int j)
   }
 }
 
+static void hook_co_apply_task(void *__restrict userdata,
+                               const int iter,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct HookData_cb *hd = userdata;
+  if (hd->origindex_mask != NULL) {
+    const int index = hd->origindex[iter];
+    if (index < 0 || index >= hd->verts_num || !BLI_BITMAP_TEST(hd->origindex_mask, index)) {
+      return;
+    }
+  }
+  hook_co_apply(hd, iter);
+}
+
+static void hook_co_apply_all(struct HookData_cb *hd)
+{
+  hd->weights = (hd->dvert != NULL) ?
+                    MOD_get_vgroup_weights(hd->dvert, hd->defgrp_index, hd->verts_num, false) :
+                    NULL;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (hd->verts_num > 1024);
+  BLI_task_parallel_range(0, hd->verts_num, hd, hook_co_apply_task, &settings);
+
+  MEM_SAFE_FREE(hd->weights);
+}
+
 static void deformVerts_do(HookModifierData *hmd,
                            const ModifierEvalContext *UNUSED(ctx),
                            Object *ob,
@@ -271,7 +311,11 @@ static void deformVerts_do(HookModifierData *hmd,
 
   /* Generic data needed for applying per-vertex calculations (initialize all members) */
   hd.vertexCos = vertexCos;
+  hd.verts_num = numVerts;
   MOD_get_vgroup(ob, mesh, hmd->name, &hd.dvert, &hd.defgrp_index);
+  hd.weights = NULL;
+  hd.origindex = NULL;
+  hd.origindex_mask = NULL;
 
   hd.curfalloff = hmd->curfalloff;
 
@@ -321,17 +365,16 @@ static void deformVerts_do(HookModifierData *hmd,
 
     /* if mesh is present and has original index data, use it */
     if (mesh && (origindex_ar = CustomData_get_layer(&mesh->vdata, CD_ORIGINDEX))) {
+      /* Tag the hooked indices, so every vertex only has to look up its own original index. */
+      hd.origindex = origindex_ar;
+      hd.origindex_mask = BLI_BITMAP_NEW(numVerts, __func__);
       for (i = 0, index_pt = hmd->indexar; i < hmd->totindex; i++, index_pt++) {
         if (*index_pt < numVerts) {
-          int j;
-
-          for (j = 0; j < numVerts; j++) {
-            if (origindex_ar[j] == *index_pt) {
-              hook_co_apply(&hd, j);
-            }
-          }
+          BLI_BITMAP_ENABLE(hd.origindex_mask, *index_pt);
         }
       }
+      hook_co_apply_all(&hd);
+      MEM_freeN(hd.origindex_mask);
     }
     else { /* missing mesh or ORIGINDEX */
       for (i = 0, index_pt = hmd->indexar; i < hmd->totindex; i++, index_pt++) {
@@ -342,9 +385,7 @@ static void deformVerts_do(HookModifierData *hmd,
     }
   }
   else if (hd.dvert) { /* vertex group hook */
-    for (i = 0; i < numVerts; i++) {
-      hook_co_apply(&hd, i);
-    }
+    hook_co_apply_all(&hd);
   }
 }
 
@@ -396,6 +437,7 @@ ModifierTypeInfo modifierType_Hook = {
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
@@ -579,6 +579,7 @@ ModifierTypeInfo modifierType_LaplacianSmooth = {
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ init_data,
     /* requiredDataMask */ required_data_mask,
@@ -373,6 +373,7 @@ ModifierTypeInfo modifierType_Mask = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ applyModifier,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ NULL,
     /* requiredDataMask */ requiredDataMask,
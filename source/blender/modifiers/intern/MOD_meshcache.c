@@ -59,6 +59,17 @@ static void initData(ModifierData *md)
   mcmd->up_axis = 2;
 }
 
+static void freeRuntimeData(void *runtime_data)
+{
+  MOD_meshcache_file_free((MeshCacheFile *)runtime_data);
+}
+
+static void freeData(ModifierData *md)
+{
+  freeRuntimeData(md->runtime);
+  md->runtime = NULL;
+}
+
 static bool dependsOnTime(ModifierData *md)
 {
   MeshCacheModifierData *mcmd = (MeshCacheModifierData *)md;
@@ -146,18 +157,26 @@ static void meshcache_do(MeshCacheModifierData *mcmd,
   BLI_strncpy(filepath, mcmd->filepath, sizeof(filepath));
   BLI_path_abs(filepath, ID_BLEND_PATH_FROM_GLOBAL((ID *)ob));
 
-  switch (mcmd->type) {
-    case MOD_MESHCACHE_TYPE_MDD:
-      ok = MOD_meshcache_read_mdd_times(
-          filepath, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
-      break;
-    case MOD_MESHCACHE_TYPE_PC2:
-      ok = MOD_meshcache_read_pc2_times(
-          filepath, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
-      break;
-    default:
-      ok = false;
-      break;
+  /* The file stays open between evaluations, only re-opened when it changes. */
+  MeshCacheFile **mcf_p = (MeshCacheFile **)&mcmd->modifier.runtime;
+
+  if (MOD_meshcache_file_ensure(mcf_p, filepath, &err_str) == false) {
+    ok = false;
+  }
+  else {
+    switch (mcmd->type) {
+      case MOD_MESHCACHE_TYPE_MDD:
+        ok = MOD_meshcache_read_mdd_times(
+            *mcf_p, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
+        break;
+      case MOD_MESHCACHE_TYPE_PC2:
+        ok = MOD_meshcache_read_pc2_times(
+            *mcf_p, vertexCos, numVerts, mcmd->interp, time, fps, mcmd->time_mode, &err_str);
+        break;
+      default:
+        ok = false;
+        break;
+    }
   }
 
   /* -------------------------------------------------------------------- */
@@ -302,10 +321,11 @@ ModifierTypeInfo modifierType_MeshCache = {
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
-    /* freeData */ NULL,
+    /* freeData */ freeData,
     /* isDisabled */ isDisabled,
     /* updateDepsgraph */ NULL,
     /* dependsOnTime */ dependsOnTime,
@@ -313,5 +333,5 @@ ModifierTypeInfo modifierType_MeshCache = {
     /* foreachObjectLink */ NULL,
     /* foreachIDLink */ NULL,
     /* foreachTexLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* freeRuntimeData */ freeRuntimeData,
 };
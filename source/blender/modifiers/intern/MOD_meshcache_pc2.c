@@ -20,19 +20,13 @@
 
 #include <stdio.h>
 #include <string.h>
-#include <errno.h>
 
 #include "BLI_utildefines.h"
 
-#include "BLI_fileops.h"
 #ifdef __BIG_ENDIAN__
 #  include "BLI_endian_switch.h"
 #endif
 
-#ifdef WIN32
-#  include "BLI_winstuff.h"
-#endif
-
 #include "DNA_modifier_types.h"
 
 #include "MOD_meshcache_util.h" /* own include */
@@ -46,12 +40,19 @@ typedef struct PC2Head {
   int frame_tot;
 } PC2Head; /* frames, verts */
 
-static bool meshcache_read_pc2_head(FILE *fp,
+/* PC2 files are always little-endian. */
+#ifdef __BIG_ENDIAN__
+#  define PC2_SWITCH_ENDIAN true
+#else
+#  define PC2_SWITCH_ENDIAN false
+#endif
+
+static bool meshcache_read_pc2_head(const MeshCacheFile *mcf,
                                     const int verts_tot,
                                     PC2Head *pc2_head,
                                     const char **err_str)
 {
-  if (!fread(pc2_head, sizeof(*pc2_head), 1, fp)) {
+  if (!MOD_meshcache_file_read(mcf, 0, pc2_head, sizeof(*pc2_head))) {
     *err_str = "Missing header";
     return false;
   }
@@ -75,17 +76,21 @@ static bool meshcache_read_pc2_head(FILE *fp,
     *err_str = "Invalid frame total";
     return false;
   }
-  /* intentionally dont seek back */
 
   return true;
 }
 
+static size_t meshcache_pc2_frame_offset(const PC2Head *pc2_head, const int index)
+{
+  return sizeof(*pc2_head) + (sizeof(float[3]) * (size_t)index * (size_t)pc2_head->verts_tot);
+}
+
 /**
  * Gets the index frange and factor
  *
  * currently same as for MDD
  */
-static bool meshcache_read_pc2_range(FILE *fp,
+static bool meshcache_read_pc2_range(const MeshCacheFile *mcf,
                                      const int verts_tot,
                                      const float frame,
                                      const char interp,
@@ -97,16 +102,23 @@ static bool meshcache_read_pc2_range(FILE *fp,
 
   /* first check interpolation and get the vert locations */
 
-  if (meshcache_read_pc2_head(fp, verts_tot, &pc2_head, err_str) == false) {
+  if (meshcache_read_pc2_head(mcf, verts_tot, &pc2_head, err_str) == false) {
     return false;
   }
 
   MOD_meshcache_calc_range(frame, interp, pc2_head.frame_tot, r_index_range, r_factor);
 
+  /* Read-ahead the frame following the range, so forward playback doesn't stall on I/O. */
+  if (r_index_range[1] + 1 < pc2_head.frame_tot) {
+    MOD_meshcache_file_prefetch(mcf,
+                                meshcache_pc2_frame_offset(&pc2_head, r_index_range[1] + 1),
+                                sizeof(float[3]) * (size_t)pc2_head.verts_tot);
+  }
+
   return true;
 }
 
-static bool meshcache_read_pc2_range_from_time(FILE *fp,
+static bool meshcache_read_pc2_range_from_time(const MeshCacheFile *mcf,
                                                const int verts_tot,
                                                const float time,
                                                const float fps,
@@ -116,7 +128,7 @@ static bool meshcache_read_pc2_range_from_time(FILE *fp,
   PC2Head pc2_head;
   float frame;
 
-  if (meshcache_read_pc2_head(fp, verts_tot, &pc2_head, err_str) == false) {
+  if (meshcache_read_pc2_head(mcf, verts_tot, &pc2_head, err_str) == false) {
     return false;
   }
 
@@ -133,7 +145,7 @@ static bool meshcache_read_pc2_range_from_time(FILE *fp,
   return true;
 }
 
-bool MOD_meshcache_read_pc2_index(FILE *fp,
+bool MOD_meshcache_read_pc2_index(const MeshCacheFile *mcf,
                                   float (*vertexCos)[3],
                                   const int verts_tot,
                                   const int index,
@@ -142,52 +154,24 @@ bool MOD_meshcache_read_pc2_index(FILE *fp,
 {
   PC2Head pc2_head;
 
-  if (meshcache_read_pc2_head(fp, verts_tot, &pc2_head, err_str) == false) {
+  if (meshcache_read_pc2_head(mcf, verts_tot, &pc2_head, err_str) == false) {
     return false;
   }
 
-  if (fseek(fp, sizeof(float) * 3 * index * pc2_head.verts_tot, SEEK_CUR) != 0) {
-    *err_str = "Failed to seek frame";
+  if (!MOD_meshcache_file_read_frame(mcf,
+                                     meshcache_pc2_frame_offset(&pc2_head, index),
+                                     vertexCos,
+                                     pc2_head.verts_tot,
+                                     factor,
+                                     PC2_SWITCH_ENDIAN)) {
+    *err_str = "Failed to read frame";
     return false;
   }
 
-  if (factor >= 1.0f) {
-    float *vco = *vertexCos;
-    uint i;
-    for (i = pc2_head.verts_tot; i != 0; i--, vco += 3) {
-      fread(vco, sizeof(float) * 3, 1, fp);
-
-#ifdef __BIG_ENDIAN__
-      BLI_endian_switch_float(vco + 0);
-      BLI_endian_switch_float(vco + 1);
-      BLI_endian_switch_float(vco + 2);
-#endif /* __BIG_ENDIAN__ */
-    }
-  }
-  else {
-    const float ifactor = 1.0f - factor;
-    float *vco = *vertexCos;
-    uint i;
-    for (i = pc2_head.verts_tot; i != 0; i--, vco += 3) {
-      float tvec[3];
-      fread(tvec, sizeof(float) * 3, 1, fp);
-
-#ifdef __BIG_ENDIAN__
-      BLI_endian_switch_float(tvec + 0);
-      BLI_endian_switch_float(tvec + 1);
-      BLI_endian_switch_float(tvec + 2);
-#endif /* __BIG_ENDIAN__ */
-
-      vco[0] = (vco[0] * ifactor) + (tvec[0] * factor);
-      vco[1] = (vco[1] * ifactor) + (tvec[1] * factor);
-      vco[2] = (vco[2] * ifactor) + (tvec[2] * factor);
-    }
-  }
-
   return true;
 }
 
-bool MOD_meshcache_read_pc2_frame(FILE *fp,
+bool MOD_meshcache_read_pc2_frame(const MeshCacheFile *mcf,
                                   float (*vertexCos)[3],
                                   const int verts_tot,
                                   const char interp,
@@ -197,7 +181,7 @@ bool MOD_meshcache_read_pc2_frame(FILE *fp,
   int index_range[2];
   float factor;
 
-  if (meshcache_read_pc2_range(fp,
+  if (meshcache_read_pc2_range(mcf,
                                verts_tot,
                                frame,
                                interp,
@@ -209,29 +193,19 @@ bool MOD_meshcache_read_pc2_frame(FILE *fp,
 
   if (index_range[0] == index_range[1]) {
     /* read single */
-    if ((fseek(fp, 0, SEEK_SET) == 0) &&
-        MOD_meshcache_read_pc2_index(fp, vertexCos, verts_tot, index_range[0], 1.0f, err_str)) {
-      return true;
-    }
-    else {
-      return false;
-    }
+    return MOD_meshcache_read_pc2_index(
+        mcf, vertexCos, verts_tot, index_range[0], 1.0f, err_str);
   }
   else {
     /* read both and interpolate */
-    if ((fseek(fp, 0, SEEK_SET) == 0) &&
-        MOD_meshcache_read_pc2_index(fp, vertexCos, verts_tot, index_range[0], 1.0f, err_str) &&
-        (fseek(fp, 0, SEEK_SET) == 0) &&
-        MOD_meshcache_read_pc2_index(fp, vertexCos, verts_tot, index_range[1], factor, err_str)) {
-      return true;
-    }
-    else {
-      return false;
-    }
+    return (MOD_meshcache_read_pc2_index(
+                mcf, vertexCos, verts_tot, index_range[0], 1.0f, err_str) &&
+            MOD_meshcache_read_pc2_index(
+                mcf, vertexCos, verts_tot, index_range[1], factor, err_str));
   }
 }
 
-bool MOD_meshcache_read_pc2_times(const char *filepath,
+bool MOD_meshcache_read_pc2_times(const MeshCacheFile *mcf,
                                   float (*vertexCos)[3],
                                   const int verts_tot,
                                   const char interp,
@@ -242,14 +216,6 @@ bool MOD_meshcache_read_pc2_times(const char *filepath,
 {
   float frame;
 
-  FILE *fp = BLI_fopen(filepath, "rb");
-  bool ok;
-
-  if (fp == NULL) {
-    *err_str = errno ? strerror(errno) : "Unknown error opening file";
-    return false;
-  }
-
   switch (time_mode) {
     case MOD_MESHCACHE_TIME_FRAME: {
       frame = time;
@@ -257,29 +223,23 @@ bool MOD_meshcache_read_pc2_times(const char *filepath,
     }
     case MOD_MESHCACHE_TIME_SECONDS: {
       /* we need to find the closest time */
-      if (meshcache_read_pc2_range_from_time(fp, verts_tot, time, fps, &frame, err_str) == false) {
-        fclose(fp);
+      if (meshcache_read_pc2_range_from_time(mcf, verts_tot, time, fps, &frame, err_str) ==
+          false) {
         return false;
       }
-      rewind(fp);
       break;
     }
     case MOD_MESHCACHE_TIME_FACTOR:
     default: {
       PC2Head pc2_head;
-      if (meshcache_read_pc2_head(fp, verts_tot, &pc2_head, err_str) == false) {
-        fclose(fp);
+      if (meshcache_read_pc2_head(mcf, verts_tot, &pc2_head, err_str) == false) {
         return false;
       }
 
       frame = CLAMPIS(time, 0.0f, 1.0f) * (float)pc2_head.frame_tot;
-      rewind(fp);
       break;
     }
   }
 
-  ok = MOD_meshcache_read_pc2_frame(fp, vertexCos, verts_tot, interp, frame, err_str);
-
-  fclose(fp);
-  return ok;
+  return MOD_meshcache_read_pc2_frame(mcf, vertexCos, verts_tot, interp, frame, err_str);
 }
@@ -18,12 +18,27 @@
  * \ingroup modifiers
  */
 
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
 #include "BLI_utildefines.h"
+#ifdef __linux__
+#  include <fcntl.h>
+#endif
 
+#include "BLI_endian_switch.h"
+#include "BLI_fileops.h"
 #include "BLI_math.h"
+#include "BLI_string.h"
+#ifdef WIN32
+#  include "BLI_winstuff.h"
+#endif
 
 #include "DNA_modifier_types.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "MOD_meshcache_util.h"
 
 void MOD_meshcache_calc_range(const float frame,
@@ -62,3 +77,163 @@ void MOD_meshcache_calc_range(const float frame,
     }
   }
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Cache File
+ *
+ * The cache file stays open between evaluations so playback doesn't re-open it
+ * and seek/read every vertex each frame, whole frames are read at once instead.
+ *
+ * \note The file isn't memory mapped, accessing a mapping of a file which is truncated
+ * (while it's being re-exported for example) raises SIGBUS instead of failing the read.
+ * \{ */
+
+static int64_t meshcache_stat_mtime_ns(const BLI_stat_t *st)
+{
+#if defined(__APPLE__)
+  return ((int64_t)st->st_mtimespec.tv_sec * 1000000000) + (int64_t)st->st_mtimespec.tv_nsec;
+#elif defined(WIN32)
+  return (int64_t)st->st_mtime * 1000000000;
+#else
+  return ((int64_t)st->st_mtim.tv_sec * 1000000000) + (int64_t)st->st_mtim.tv_nsec;
+#endif
+}
+
+static void meshcache_file_close(MeshCacheFile *mcf)
+{
+  if (mcf->fp != NULL) {
+    fclose(mcf->fp);
+    mcf->fp = NULL;
+  }
+  mcf->size = 0;
+}
+
+void MOD_meshcache_file_free(MeshCacheFile *mcf)
+{
+  if (mcf == NULL) {
+    return;
+  }
+  meshcache_file_close(mcf);
+  MEM_freeN(mcf);
+}
+
+/**
+ * Ensure \a mcf_p holds \a filepath opened for reading,
+ * re-opening when the path changes or the file was written to since it was opened.
+ */
+bool MOD_meshcache_file_ensure(MeshCacheFile **mcf_p, const char *filepath, const char **err_str)
+{
+  MeshCacheFile *mcf = *mcf_p;
+  BLI_stat_t st;
+
+  if (BLI_stat(filepath, &st) == -1) {
+    *err_str = errno ? strerror(errno) : "Unknown error opening file";
+    return false;
+  }
+
+  const int64_t mtime_ns = meshcache_stat_mtime_ns(&st);
+
+  if (mcf == NULL) {
+    mcf = *mcf_p = MEM_callocN(sizeof(*mcf), __func__);
+  }
+  else if ((mcf->fp != NULL) && STREQ(mcf->filepath, filepath) && (mcf->mtime_ns == mtime_ns) &&
+           (mcf->size == (size_t)st.st_size)) {
+    return true;
+  }
+
+  meshcache_file_close(mcf);
+  BLI_strncpy(mcf->filepath, filepath, sizeof(mcf->filepath));
+  mcf->mtime_ns = mtime_ns;
+
+  if (st.st_size == 0) {
+    *err_str = "Missing header";
+    return false;
+  }
+
+  mcf->fp = BLI_fopen(filepath, "rb");
+  if (mcf->fp == NULL) {
+    *err_str = errno ? strerror(errno) : "Unknown error opening file";
+    return false;
+  }
+
+  mcf->size = (size_t)st.st_size;
+  return true;
+}
+
+/**
+ * Copy \a size bytes at \a offset, fails when the range isn't inside the file.
+ */
+bool MOD_meshcache_file_read(const MeshCacheFile *mcf,
+                             const size_t offset,
+                             void *r_data,
+                             const size_t size)
+{
+  if ((offset > mcf->size) || (size > mcf->size - offset)) {
+    return false;
+  }
+  if (fseek(mcf->fp, (int64_t)offset, SEEK_SET) != 0) {
+    return false;
+  }
+  /* The file may have been truncated since it was opened. */
+  return fread(r_data, 1, size, mcf->fp) == size;
+}
+
+/**
+ * Read a whole frame of vertex locations at \a offset into \a vertexCos,
+ * blending with the existing locations when \a factor is below one.
+ */
+bool MOD_meshcache_file_read_frame(const MeshCacheFile *mcf,
+                                   const size_t offset,
+                                   float (*vertexCos)[3],
+                                   const int verts_tot,
+                                   const float factor,
+                                   const bool switch_endian)
+{
+  const size_t floats_tot = (size_t)verts_tot * 3;
+  const size_t size = sizeof(float) * floats_tot;
+  float *vco = vertexCos[0];
+
+  if (factor >= 1.0f) {
+    if (!MOD_meshcache_file_read(mcf, offset, vco, size)) {
+      return false;
+    }
+    if (switch_endian) {
+      BLI_endian_switch_float_array(vco, (int)floats_tot);
+    }
+    return true;
+  }
+
+  float *frame_co = MEM_malloc_arrayN(floats_tot, sizeof(float), __func__);
+  if (!MOD_meshcache_file_read(mcf, offset, frame_co, size)) {
+    MEM_freeN(frame_co);
+    return false;
+  }
+  if (switch_endian) {
+    BLI_endian_switch_float_array(frame_co, (int)floats_tot);
+  }
+
+  const float ifactor = 1.0f - factor;
+  for (size_t i = 0; i < floats_tot; i++) {
+    vco[i] = (vco[i] * ifactor) + (frame_co[i] * factor);
+  }
+
+  MEM_freeN(frame_co);
+  return true;
+}
+
+/**
+ * Hint that the frame at \a offset will be read soon, so it can be read-ahead.
+ */
+void MOD_meshcache_file_prefetch(const MeshCacheFile *mcf, const size_t offset, const size_t size)
+{
+#ifdef __linux__
+  if ((offset > mcf->size) || (size > mcf->size - offset)) {
+    return;
+  }
+  posix_fadvise(fileno(mcf->fp), (off_t)offset, (off_t)size, POSIX_FADV_WILLNEED);
+#else
+  UNUSED_VARS(mcf, offset, size);
+#endif
+}
+
+/** \} */
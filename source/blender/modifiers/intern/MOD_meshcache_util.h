@@ -21,20 +21,33 @@
 #ifndef __MOD_MESHCACHE_UTIL_H__
 #define __MOD_MESHCACHE_UTIL_H__
 
+/**
+ * A cache file kept open between evaluations,
+ * stored as the modifier runtime data.
+ */
+typedef struct MeshCacheFile {
+  /** Absolute path, FILE_MAX. */
+  char filepath[1024];
+  /** Used to detect the file being re-written on disk. */
+  int64_t mtime_ns;
+  size_t size;
+  FILE *fp;
+} MeshCacheFile;
+
 /* MOD_meshcache_mdd.c */
-bool MOD_meshcache_read_mdd_index(FILE *fp,
+bool MOD_meshcache_read_mdd_index(const MeshCacheFile *mcf,
                                   float (*vertexCos)[3],
                                   const int vertex_tot,
                                   const int index,
                                   const float factor,
                                   const char **err_str);
-bool MOD_meshcache_read_mdd_frame(FILE *fp,
+bool MOD_meshcache_read_mdd_frame(const MeshCacheFile *mcf,
                                   float (*vertexCos)[3],
                                   const int verts_tot,
                                   const char interp,
                                   const float frame,
                                   const char **err_str);
-bool MOD_meshcache_read_mdd_times(const char *filepath,
+bool MOD_meshcache_read_mdd_times(const MeshCacheFile *mcf,
                                   float (*vertexCos)[3],
                                   const int verts_tot,
                                   const char interp,
@@ -44,19 +57,19 @@ bool MOD_meshcache_read_mdd_times(const char *filepath,
                                   const char **err_str);
 
 /* MOD_meshcache_pc2.c */
-bool MOD_meshcache_read_pc2_index(FILE *fp,
+bool MOD_meshcache_read_pc2_index(const MeshCacheFile *mcf,
                                   float (*vertexCos)[3],
                                   const int verts_tot,
                                   const int index,
                                   const float factor,
                                   const char **err_str);
-bool MOD_meshcache_read_pc2_frame(FILE *fp,
+bool MOD_meshcache_read_pc2_frame(const MeshCacheFile *mcf,
                                   float (*vertexCos)[3],
                                   const int verts_tot,
                                   const char interp,
                                   const float frame,
                                   const char **err_str);
-bool MOD_meshcache_read_pc2_times(const char *filepath,
+bool MOD_meshcache_read_pc2_times(const MeshCacheFile *mcf,
                                   float (*vertexCos)[3],
                                   const int verts_tot,
                                   const char interp,
@@ -72,6 +85,20 @@ void MOD_meshcache_calc_range(const float frame,
                               int r_index_range[2],
                               float *r_factor);
 
+bool MOD_meshcache_file_ensure(MeshCacheFile **mcf_p, const char *filepath, const char **err_str);
+void MOD_meshcache_file_free(MeshCacheFile *mcf);
+bool MOD_meshcache_file_read(const MeshCacheFile *mcf,
+                             const size_t offset,
+                             void *r_data,
+                             const size_t size);
+bool MOD_meshcache_file_read_frame(const MeshCacheFile *mcf,
+                                   const size_t offset,
+                                   float (*vertexCos)[3],
+                                   const int verts_tot,
+                                   const float factor,
+                                   const bool switch_endian);
+void MOD_meshcache_file_prefetch(const MeshCacheFile *mcf, const size_t offset, const size_t size);
+
 #define FRAME_SNAP_EPS 0.0001f
 
 #endif /* __MOD_MESHCACHE_UTIL_H__ */
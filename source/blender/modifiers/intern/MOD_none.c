@@ -52,6 +52,7 @@ ModifierTypeInfo modifierType_None = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ NULL,
     /* requiredDataMask */ NULL,
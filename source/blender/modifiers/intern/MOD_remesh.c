@@ -34,6 +34,7 @@
 #include "MOD_modifiertypes.h"
 
 #include "BKE_mesh.h"
+#include "BKE_mesh_remesh_voxel.h"
 #include "BKE_mesh_runtime.h"
 
 #include <assert.h>
@@ -56,6 +57,19 @@ static void initData(ModifierData *md)
   rmd->flag = MOD_REMESH_FLOOD_FILL;
   rmd->mode = MOD_REMESH_SHARP_FEATURES;
   rmd->threshold = 1;
+  rmd->voxel_size = 0.1f;
+  rmd->adaptivity = 0.0f;
+}
+
+static void freeRuntimeData(void *runtime_data)
+{
+  BKE_mesh_remesh_voxel_cache_free((MeshRemeshVoxelCache *)runtime_data);
+}
+
+static void freeData(ModifierData *md)
+{
+  freeRuntimeData(md->runtime);
+  md->runtime = NULL;
 }
 
 #ifdef WITH_MOD_REMESH
@@ -133,17 +147,14 @@ static void dualcon_add_quad(void *output_v, const int vert_indices[4])
   output->curface++;
 }
 
-static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *UNUSED(ctx), Mesh *mesh)
+static Mesh *remesh_dualcon(RemeshModifierData *rmd, Mesh *mesh)
 {
-  RemeshModifierData *rmd;
   DualConOutput *output;
   DualConInput input;
   Mesh *result;
   DualConFlags flags = 0;
   DualConMode mode = 0;
 
-  rmd = (RemeshModifierData *)md;
-
   init_dualcon_mesh(&input, mesh);
 
   if (rmd->flag & MOD_REMESH_FLOOD_FILL) {
@@ -175,6 +186,51 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *UNUSED(c
   result = output->mesh;
   MEM_freeN(output);
 
+  BKE_mesh_calc_edges(result, true, false);
+  return result;
+}
+
+#endif /* WITH_MOD_REMESH */
+
+static Mesh *remesh_voxel(RemeshModifierData *rmd, Mesh *mesh)
+{
+  MeshRemeshVoxelCache **cache_p = (MeshRemeshVoxelCache **)&rmd->modifier.runtime;
+
+  if (rmd->voxel_size <= 0.0f) {
+    return NULL;
+  }
+
+  /* The level set is kept between evaluations, so that changing only the adaptivity (or
+   * evaluating an unchanged input again) doesn't voxelize the mesh again. */
+  if (*cache_p == NULL) {
+    *cache_p = BKE_mesh_remesh_voxel_cache_new();
+  }
+
+  return BKE_mesh_remesh_voxel_to_mesh_cached_nomain(
+      mesh, rmd->voxel_size, rmd->adaptivity, *cache_p);
+}
+
+static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *UNUSED(ctx), Mesh *mesh)
+{
+  RemeshModifierData *rmd = (RemeshModifierData *)md;
+  Mesh *result = NULL;
+
+  if (rmd->mode == MOD_REMESH_VOXEL) {
+    result = remesh_voxel(rmd, mesh);
+  }
+  else {
+    /* Don't hold on to the level set of a mode that is no longer used. */
+    freeData(md);
+
+#ifdef WITH_MOD_REMESH
+    result = remesh_dualcon(rmd, mesh);
+#endif
+  }
+
+  if (result == NULL) {
+    return mesh;
+  }
+
   if (rmd->flag & MOD_REMESH_SMOOTH_SHADING) {
     MPoly *mpoly = result->mpoly;
     int i, totpoly = result->totpoly;
@@ -186,22 +242,10 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *UNUSED(c
   }
 
   BKE_mesh_copy_settings(result, mesh);
-  BKE_mesh_calc_edges(result, true, false);
   result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
   return result;
 }
 
-#else /* !WITH_MOD_REMESH */
-
-static Mesh *applyModifier(ModifierData *UNUSED(md),
-                           const ModifierEvalContext *UNUSED(ctx),
-                           Mesh *mesh)
-{
-  return mesh;
-}
-
-#endif /* !WITH_MOD_REMESH */
-
 ModifierTypeInfo modifierType_Remesh = {
     /* name */ "Remesh",
     /* structName */ "RemeshModifierData",
@@ -217,15 +261,17 @@ ModifierTypeInfo modifierType_Remesh = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ applyModifier,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
-    /* freeData */ NULL,
+    /* freeData */ freeData,
     /* isDisabled */ NULL,
     /* updateDepsgraph */ NULL,
     /* dependsOnTime */ NULL,
     /* dependsOnNormals */ NULL,
     /* foreachObjectLink */ NULL,
     /* foreachIDLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* foreachTexLink */ NULL,
+    /* freeRuntimeData */ freeRuntimeData,
 };
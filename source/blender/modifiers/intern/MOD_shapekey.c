@@ -132,6 +132,7 @@ ModifierTypeInfo modifierType_ShapeKey = {
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ deformMatricesEM,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ NULL,
     /* requiredDataMask */ NULL,
@@ -24,6 +24,7 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -38,6 +39,8 @@
 
 #include "DEG_depsgraph_query.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "MOD_util.h"
 
 #include "bmesh.h"
@@ -190,6 +193,72 @@ static void simpleDeform_bend(const float factor,
   }
 }
 
+typedef struct SimpleDeformUserdata {
+  void (*simpleDeform_callback)(const float factor,
+                                const int axis,
+                                const float dcut[3],
+                                float co[3]);
+  float (*vertexCos)[3];
+  const float *weights;
+  const SpaceTransform *transf;
+  const uint *axis_map;
+  int deform_axis;
+  int lock_axis;
+  int limit_axis;
+  float smd_limit[2];
+  float smd_factor;
+} SimpleDeformUserdata;
+
+static void simple_deform_task(void *__restrict userdata,
+                               const int i,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SimpleDeformUserdata *data = userdata;
+  const float base_limit[2] = {0.0f, 0.0f};
+  const uint *axis_map = data->axis_map;
+  const int lock_axis = data->lock_axis;
+  float *vertex_co = data->vertexCos[i];
+  const float weight = data->weights ? data->weights[i] : 1.0f;
+
+  if (weight != 0.0f) {
+    float co[3], dcut[3] = {0.0f, 0.0f, 0.0f};
+
+    if (data->transf) {
+      BLI_space_transform_apply(data->transf, vertex_co);
+    }
+
+    copy_v3_v3(co, vertex_co);
+
+    /* Apply axis limits, and axis mappings */
+    if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_X) {
+      axis_limit(0, base_limit, co, dcut);
+    }
+    if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_Y) {
+      axis_limit(1, base_limit, co, dcut);
+    }
+    if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_Z) {
+      axis_limit(2, base_limit, co, dcut);
+    }
+    axis_limit(data->limit_axis, data->smd_limit, co, dcut);
+
+    /* apply the deform to a mapped copy of the vertex, and then re-map it back. */
+    float co_remap[3];
+    float dcut_remap[3];
+    copy_v3_v3_map(co_remap, co, axis_map);
+    copy_v3_v3_map(dcut_remap, dcut, axis_map);
+    data->simpleDeform_callback(
+        data->smd_factor, data->deform_axis, dcut_remap, co_remap); /* apply deform */
+    copy_v3_v3_unmap(co, co_remap, axis_map);
+
+    /* Use vertex weight has coef of linear interpolation */
+    interp_v3_v3v3(vertex_co, vertex_co, co, weight);
+
+    if (data->transf) {
+      BLI_space_transform_invert(data->transf, vertex_co);
+    }
+  }
+}
+
 /* simple deform modifier */
 static void SimpleDeformModifier_do(SimpleDeformModifierData *smd,
                                     const ModifierEvalContext *UNUSED(ctx),
@@ -198,7 +267,6 @@ static void SimpleDeformModifier_do(SimpleDeformModifierData *smd,
                                     float (*vertexCos)[3],
                                     int numVerts)
 {
-  const float base_limit[2] = {0.0f, 0.0f};
   int i;
   float smd_limit[2], smd_factor;
   SpaceTransform *transf = NULL, tmp_transf;
@@ -315,50 +383,27 @@ static void SimpleDeformModifier_do(SimpleDeformModifierData *smd,
   const uint *axis_map =
       axis_map_table[(smd->mode != MOD_SIMPLEDEFORM_MODE_BEND) ? deform_axis : 2];
 
-  for (i = 0; i < numVerts; i++) {
-    float weight = defvert_array_find_weight_safe(dvert, i, vgroup);
-
-    if (invert_vgroup) {
-      weight = 1.0f - weight;
-    }
-
-    if (weight != 0.0f) {
-      float co[3], dcut[3] = {0.0f, 0.0f, 0.0f};
-
-      if (transf) {
-        BLI_space_transform_apply(transf, vertexCos[i]);
-      }
-
-      copy_v3_v3(co, vertexCos[i]);
-
-      /* Apply axis limits, and axis mappings */
-      if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_X) {
-        axis_limit(0, base_limit, co, dcut);
-      }
-      if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_Y) {
-        axis_limit(1, base_limit, co, dcut);
-      }
-      if (lock_axis & MOD_SIMPLEDEFORM_LOCK_AXIS_Z) {
-        axis_limit(2, base_limit, co, dcut);
-      }
-      axis_limit(limit_axis, smd_limit, co, dcut);
-
-      /* apply the deform to a mapped copy of the vertex, and then re-map it back. */
-      float co_remap[3];
-      float dcut_remap[3];
-      copy_v3_v3_map(co_remap, co, axis_map);
-      copy_v3_v3_map(dcut_remap, dcut, axis_map);
-      simpleDeform_callback(smd_factor, deform_axis, dcut_remap, co_remap); /* apply deform */
-      copy_v3_v3_unmap(co, co_remap, axis_map);
-
-      /* Use vertex weight has coef of linear interpolation */
-      interp_v3_v3v3(vertexCos[i], vertexCos[i], co, weight);
-
-      if (transf) {
-        BLI_space_transform_invert(transf, vertexCos[i]);
-      }
-    }
-  }
+  float *weights = (vgroup != -1 || invert_vgroup) ?
+                       MOD_get_vgroup_weights(dvert, vgroup, numVerts, invert_vgroup) :
+                       NULL;
+  SimpleDeformUserdata data = {NULL};
+  data.simpleDeform_callback = simpleDeform_callback;
+  data.vertexCos = vertexCos;
+  data.weights = weights;
+  data.transf = transf;
+  data.axis_map = axis_map;
+  data.deform_axis = deform_axis;
+  data.lock_axis = lock_axis;
+  data.limit_axis = limit_axis;
+  copy_v2_v2(data.smd_limit, smd_limit);
+  data.smd_factor = smd_factor;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numVerts > 1024);
+  BLI_task_parallel_range(0, numVerts, &data, simple_deform_task, &settings);
+
+  MEM_SAFE_FREE(weights);
 }
 
 /* SimpleDeform */
@@ -464,6 +509,7 @@ ModifierTypeInfo modifierType_SimpleDeform = {
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
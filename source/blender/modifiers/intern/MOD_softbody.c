@@ -86,6 +86,7 @@ ModifierTypeInfo modifierType_Softbody = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ NULL,
     /* requiredDataMask */ NULL,
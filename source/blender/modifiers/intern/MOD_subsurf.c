@@ -241,6 +241,40 @@ static Mesh *applyModifier(ModifierData *md, const ModifierEvalContext *ctx, Mes
   return result;
 }
 
+static bool applyModifierDeform(ModifierData *md,
+                                const ModifierEvalContext *ctx,
+                                Mesh *mesh,
+                                Mesh *result)
+{
+#if !defined(WITH_OPENSUBDIV)
+  UNUSED_VARS(md, ctx, mesh, result);
+  return false;
+#else
+  SubsurfModifierData *smd = (SubsurfModifierData *)md;
+  SubdivSettings subdiv_settings;
+  subdiv_settings_init(&subdiv_settings, smd);
+  if (subdiv_settings.level == 0) {
+    return false;
+  }
+  SubdivToMeshSettings mesh_settings;
+  subdiv_mesh_settings_init(&mesh_settings, smd, ctx);
+  if (mesh_settings.resolution < 3) {
+    return false;
+  }
+  BKE_subdiv_settings_validate_for_mesh(&subdiv_settings, mesh);
+  SubsurfRuntimeData *runtime_data = subsurf_ensure_runtime(smd);
+  Subdiv *subdiv = subdiv_descriptor_ensure(smd, &subdiv_settings, mesh);
+  if (subdiv == NULL) {
+    return false;
+  }
+  const bool success = BKE_subdiv_to_mesh_positions(subdiv, &mesh_settings, mesh, result);
+  if (subdiv != runtime_data->subdiv) {
+    BKE_subdiv_free(subdiv);
+  }
+  return success;
+#endif
+}
+
 static void deformVerts(ModifierData *md,
                         const ModifierEvalContext *UNUSED(ctx),
                         Mesh *mesh,
@@ -286,6 +320,7 @@ ModifierTypeInfo modifierType_Subsurf = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ applyModifier,
+    /* applyModifierDeform */ applyModifierDeform,
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
@@ -131,6 +131,7 @@ ModifierTypeInfo modifierType_Triangulate = {
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ applyModifier,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,  // requiredDataMask,
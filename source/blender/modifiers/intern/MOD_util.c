@@ -28,6 +28,7 @@
 #include "BLI_bitmap.h"
 #include "BLI_math_vector.h"
 #include "BLI_math_matrix.h"
+#include "BLI_task.h"
 
 #include "DNA_image_types.h"
 #include "DNA_meshdata_types.h"
@@ -248,6 +249,59 @@ void MOD_get_vgroup(
   }
 }
 
+typedef struct VGroupWeightsData {
+  const MDeformVert *dvert;
+  int defgrp_index;
+  bool invert;
+  float *weights;
+} VGroupWeightsData;
+
+static void get_vgroup_weights_task(void *__restrict userdata,
+                                    const int iter,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const VGroupWeightsData *data = userdata;
+  const float weight = defvert_find_weight(&data->dvert[iter], data->defgrp_index);
+  data->weights[iter] = data->invert ? 1.0f - weight : weight;
+}
+
+/**
+ * Look up the weight of every vertex in a vertex group once, so per-vertex deform loops read a
+ * flat array instead of searching the #MDeformVert of each vertex.
+ *
+ * Follows #defvert_array_find_weight_safe: all weights are 1 when \a defgrp_index is -1 and
+ * 0 when the group exists but \a dvert is NULL (before inverting).
+ *
+ * \return Array of \a verts_num weights, to be freed with #MEM_freeN.
+ */
+float *MOD_get_vgroup_weights(const MDeformVert *dvert,
+                              const int defgrp_index,
+                              const int verts_num,
+                              const bool invert)
+{
+  float *weights = MEM_malloc_arrayN((size_t)verts_num, sizeof(*weights), __func__);
+
+  if (defgrp_index == -1 || dvert == NULL) {
+    const bool is_full = (defgrp_index == -1) != invert;
+    copy_vn_fl(weights, verts_num, is_full ? 1.0f : 0.0f);
+    return weights;
+  }
+
+  VGroupWeightsData data = {
+      .dvert = dvert,
+      .defgrp_index = defgrp_index,
+      .invert = invert,
+      .weights = weights,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (verts_num > 1024);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, verts_num, &data, get_vgroup_weights_task, &settings);
+
+  return weights;
+}
+
 /* only called by BKE_modifier.h/modifier.c */
 void modifier_type_init(ModifierTypeInfo *types[])
 {
@@ -55,5 +55,9 @@ void MOD_get_vgroup(struct Object *ob,
                     const char *name,
                     struct MDeformVert **dvert,
                     int *defgrp_index);
+float *MOD_get_vgroup_weights(const struct MDeformVert *dvert,
+                              const int defgrp_index,
+                              const int verts_num,
+                              const bool invert);
 
 #endif /* __MOD_UTIL_H__ */
@@ -25,12 +25,14 @@
 #include "BLI_utildefines.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
 #include "BKE_editmesh.h"
+#include "BKE_image.h"
 #include "BKE_library.h"
 #include "BKE_library_query.h"
 #include "BKE_mesh.h"
@@ -153,6 +155,110 @@ static void updateDepsgraph(ModifierData *md, const ModifierUpdateDepsgraphConte
   }
 }
 
+typedef struct WarpUserdata {
+  const WarpModifierData *wmd;
+  float (*vertexCos)[3];
+  const float *weights;
+  float (*tex_co)[3];
+  Tex *tex_target;
+  struct Scene *scene;
+  struct ImagePool *pool;
+  float mat_from[4][4];
+  float mat_from_inv[4][4];
+  float mat_unit[4][4];
+  float mat_final[4][4];
+  float falloff_radius_sq;
+  float strength;
+} WarpUserdata;
+
+static void warpModifier_do_task(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const WarpUserdata *data = userdata;
+  const WarpModifierData *wmd = data->wmd;
+  float *co = data->vertexCos[i];
+  float fac = 1.0f, weight = data->strength;
+
+  if (wmd->falloff_type == eWarp_Falloff_None ||
+      ((fac = len_squared_v3v3(co, data->mat_from[3])) < data->falloff_radius_sq &&
+       (fac = (wmd->falloff_radius - sqrtf(fac)) / wmd->falloff_radius))) {
+    /* skip if no vert group found */
+    if (data->weights) {
+      weight = data->weights[i] * data->strength;
+      if (weight <= 0.0f) {
+        return;
+      }
+    }
+
+    /* closely match PROP_SMOOTH and similar */
+    switch (wmd->falloff_type) {
+      case eWarp_Falloff_None:
+        fac = 1.0f;
+        break;
+      case eWarp_Falloff_Curve:
+        fac = BKE_curvemapping_evaluateF(wmd->curfalloff, 0, fac);
+        break;
+      case eWarp_Falloff_Sharp:
+        fac = fac * fac;
+        break;
+      case eWarp_Falloff_Smooth:
+        fac = 3.0f * fac * fac - 2.0f * fac * fac * fac;
+        break;
+      case eWarp_Falloff_Root:
+        fac = sqrtf(fac);
+        break;
+      case eWarp_Falloff_Linear:
+        /* pass */
+        break;
+      case eWarp_Falloff_Const:
+        fac = 1.0f;
+        break;
+      case eWarp_Falloff_Sphere:
+        fac = sqrtf(2 * fac - fac * fac);
+        break;
+      case eWarp_Falloff_InvSquare:
+        fac = fac * (2.0f - fac);
+        break;
+    }
+
+    fac *= weight;
+
+    if (data->tex_co) {
+      TexResult texres;
+      texres.nor = NULL;
+      BKE_texture_get_value_ex(
+          data->scene, data->tex_target, data->tex_co[i], &texres, data->pool, false);
+      fac *= texres.tin;
+    }
+
+    if (fac != 0.0f) {
+      /* into the 'from' objects space */
+      mul_m4_v3(data->mat_from_inv, co);
+
+      if (fac == 1.0f) {
+        mul_m4_v3(data->mat_final, co);
+      }
+      else {
+        if (wmd->flag & MOD_WARP_VOLUME_PRESERVE) {
+          /* interpolate the matrix for nicer locations */
+          float tmat[4][4];
+          blend_m4_m4m4(tmat, data->mat_unit, data->mat_final, fac);
+          mul_m4_v3(tmat, co);
+        }
+        else {
+          float tvec[3];
+          mul_v3_m4v3(tvec, data->mat_final, co);
+          interp_v3_v3v3(co, co, tvec, fac);
+        }
+      }
+
+      /* out of the 'from' objects space */
+      mul_m4_v3(data->mat_from, co);
+    }
+  }
+}
+
 static void warpModifier_do(WarpModifierData *wmd,
                             const ModifierEvalContext *ctx,
                             Mesh *mesh,
@@ -171,10 +277,8 @@ static void warpModifier_do(WarpModifierData *wmd,
 
   const float falloff_radius_sq = SQUARE(wmd->falloff_radius);
   float strength = wmd->strength;
-  float fac = 1.0f, weight;
-  int i;
   int defgrp_index;
-  MDeformVert *dvert, *dv = NULL;
+  MDeformVert *dvert;
 
   float(*tex_co)[3] = NULL;
 
@@ -216,7 +320,6 @@ static void warpModifier_do(WarpModifierData *wmd,
     invert_m4(mat_final);
     negate_v3_v3(mat_final[3], loc);
   }
-  weight = strength;
 
   Tex *tex_target = wmd->texture;
   if (mesh != NULL && tex_target != NULL) {
@@ -226,87 +329,36 @@ static void warpModifier_do(WarpModifierData *wmd,
     MOD_init_texture((MappingInfoModifierData *)wmd, ctx);
   }
 
-  for (i = 0; i < numVerts; i++) {
-    float *co = vertexCos[i];
-
-    if (wmd->falloff_type == eWarp_Falloff_None ||
-        ((fac = len_squared_v3v3(co, mat_from[3])) < falloff_radius_sq &&
-         (fac = (wmd->falloff_radius - sqrtf(fac)) / wmd->falloff_radius))) {
-      /* skip if no vert group found */
-      if (defgrp_index != -1) {
-        dv = &dvert[i];
-        weight = defvert_find_weight(dv, defgrp_index) * strength;
-        if (weight <= 0.0f) {
-          continue;
-        }
-      }
-
-      /* closely match PROP_SMOOTH and similar */
-      switch (wmd->falloff_type) {
-        case eWarp_Falloff_None:
-          fac = 1.0f;
-          break;
-        case eWarp_Falloff_Curve:
-          fac = BKE_curvemapping_evaluateF(wmd->curfalloff, 0, fac);
-          break;
-        case eWarp_Falloff_Sharp:
-          fac = fac * fac;
-          break;
-        case eWarp_Falloff_Smooth:
-          fac = 3.0f * fac * fac - 2.0f * fac * fac * fac;
-          break;
-        case eWarp_Falloff_Root:
-          fac = sqrtf(fac);
-          break;
-        case eWarp_Falloff_Linear:
-          /* pass */
-          break;
-        case eWarp_Falloff_Const:
-          fac = 1.0f;
-          break;
-        case eWarp_Falloff_Sphere:
-          fac = sqrtf(2 * fac - fac * fac);
-          break;
-        case eWarp_Falloff_InvSquare:
-          fac = fac * (2.0f - fac);
-          break;
-      }
-
-      fac *= weight;
-
-      if (tex_co) {
-        struct Scene *scene = DEG_get_evaluated_scene(ctx->depsgraph);
-        TexResult texres;
-        texres.nor = NULL;
-        BKE_texture_get_value(scene, tex_target, tex_co[i], &texres, false);
-        fac *= texres.tin;
-      }
+  float *weights = (defgrp_index != -1) ?
+                       MOD_get_vgroup_weights(dvert, defgrp_index, numVerts, false) :
+                       NULL;
+  WarpUserdata data = {NULL};
+  data.wmd = wmd;
+  data.vertexCos = vertexCos;
+  data.weights = weights;
+  data.tex_co = tex_co;
+  data.tex_target = tex_target;
+  data.scene = DEG_get_evaluated_scene(ctx->depsgraph);
+  copy_m4_m4(data.mat_from, mat_from);
+  copy_m4_m4(data.mat_from_inv, mat_from_inv);
+  copy_m4_m4(data.mat_unit, mat_unit);
+  copy_m4_m4(data.mat_final, mat_final);
+  data.falloff_radius_sq = falloff_radius_sq;
+  data.strength = strength;
+  if (tex_co != NULL) {
+    data.pool = BKE_image_pool_new();
+    BKE_texture_fetch_images_for_pool(tex_target, data.pool);
+  }
 
-      if (fac != 0.0f) {
-        /* into the 'from' objects space */
-        mul_m4_v3(mat_from_inv, co);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numVerts > 512);
+  BLI_task_parallel_range(0, numVerts, &data, warpModifier_do_task, &settings);
 
-        if (fac == 1.0f) {
-          mul_m4_v3(mat_final, co);
-        }
-        else {
-          if (wmd->flag & MOD_WARP_VOLUME_PRESERVE) {
-            /* interpolate the matrix for nicer locations */
-            blend_m4_m4m4(tmat, mat_unit, mat_final, fac);
-            mul_m4_v3(tmat, co);
-          }
-          else {
-            float tvec[3];
-            mul_v3_m4v3(tvec, mat_final, co);
-            interp_v3_v3v3(co, co, tvec, fac);
-          }
-        }
-
-        /* out of the 'from' objects space */
-        mul_m4_v3(mat_from, co);
-      }
-    }
+  if (data.pool != NULL) {
+    BKE_image_pool_free(data.pool);
   }
+  MEM_SAFE_FREE(weights);
 
   if (tex_co) {
     MEM_freeN(tex_co);
@@ -370,6 +422,7 @@ ModifierTypeInfo modifierType_Warp = {
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
     /* applyModifier */ NULL,
+    /* applyModifierDeform */ NULL,
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
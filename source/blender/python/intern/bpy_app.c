@@ -44,6 +44,8 @@
 #include "bpy_app_icons.h"
 #include "bpy_app_timers.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "BLI_utildefines.h"
 
 #include "BKE_appdir.h"
@@ -415,6 +417,76 @@ static int bpy_app_use_override_library_set(PyObject *UNUSED(self),
   return 0;
 }
 
+PyDoc_STRVAR(bpy_app_memory_profile_interval_doc,
+             "Int, average number of bytes between allocations sampled by the memory profiler, "
+             "zero disables profiling");
+static PyObject *bpy_app_memory_profile_interval_get(PyObject *UNUSED(self),
+                                                     void *UNUSED(closure))
+{
+  return PyLong_FromSize_t(MEM_profile_sample_interval_get());
+}
+
+static int bpy_app_memory_profile_interval_set(PyObject *UNUSED(self),
+                                               PyObject *value,
+                                               void *UNUSED(closure))
+{
+  const size_t param = PyLong_AsSize_t(value);
+
+  if (param == (size_t)-1 && PyErr_Occurred()) {
+    PyC_Err_SetString_Prefix(PyExc_TypeError,
+                             "bpy.app.memory_profile_interval can only be set to a positive "
+                             "whole number");
+    return -1;
+  }
+
+  MEM_profile_sample_interval_set(param);
+
+  return 0;
+}
+
+PyDoc_STRVAR(bpy_app_memory_profile_doc,
+             "List of (name, memory_in_use, peak_memory, blocks_in_use, total_memory) tuples "
+             "estimated by the memory profiler, sorted by memory in use (read-only)");
+PyDoc_STRVAR(bpy_app_memory_profile_call_sites_doc,
+             "List of (name, call_site_address, memory_in_use, peak_memory, blocks_in_use, "
+             "total_memory) tuples estimated by the memory profiler, sorted by memory in use "
+             "(read-only)");
+static PyObject *bpy_app_memory_profile_get(PyObject *UNUSED(self), void *closure)
+{
+  const bool by_call_site = POINTER_AS_INT(closure);
+  unsigned int stats_len;
+  MEM_ProfileStats *stats = MEM_profile_stats_get(by_call_site, &stats_len);
+  PyObject *ret = PyList_New(stats_len);
+
+  for (unsigned int i = 0; i < stats_len; i++) {
+    PyObject *item;
+    if (by_call_site) {
+      item = PyTuple_New(6);
+      PyTuple_SET_ITEMS(item,
+                        PyUnicode_FromString(stats[i].name),
+                        PyLong_FromVoidPtr((void *)stats[i].call_site),
+                        PyLong_FromSize_t(stats[i].mem_in_use),
+                        PyLong_FromSize_t(stats[i].peak_mem),
+                        PyLong_FromSize_t(stats[i].blocks_in_use),
+                        PyLong_FromSize_t(stats[i].total_mem));
+    }
+    else {
+      item = PyTuple_New(5);
+      PyTuple_SET_ITEMS(item,
+                        PyUnicode_FromString(stats[i].name),
+                        PyLong_FromSize_t(stats[i].mem_in_use),
+                        PyLong_FromSize_t(stats[i].peak_mem),
+                        PyLong_FromSize_t(stats[i].blocks_in_use),
+                        PyLong_FromSize_t(stats[i].total_mem));
+    }
+    PyList_SET_ITEM(ret, i, item);
+  }
+
+  MEM_profile_stats_free(stats);
+
+  return ret;
+}
+
 static PyGetSetDef bpy_app_getsets[] = {
     {(char *)"debug",
      bpy_app_debug_get,
@@ -526,6 +598,21 @@ static PyGetSetDef bpy_app_getsets[] = {
      (char *)bpy_app_debug_value_doc,
      NULL},
     {(char *)"tempdir", bpy_app_tempdir_get, NULL, (char *)bpy_app_tempdir_doc, NULL},
+    {(char *)"memory_profile_interval",
+     bpy_app_memory_profile_interval_get,
+     bpy_app_memory_profile_interval_set,
+     (char *)bpy_app_memory_profile_interval_doc,
+     NULL},
+    {(char *)"memory_profile",
+     bpy_app_memory_profile_get,
+     NULL,
+     (char *)bpy_app_memory_profile_doc,
+     POINTER_FROM_INT(false)},
+    {(char *)"memory_profile_call_sites",
+     bpy_app_memory_profile_get,
+     NULL,
+     (char *)bpy_app_memory_profile_call_sites_doc,
+     POINTER_FROM_INT(true)},
     {(char *)"driver_namespace",
      bpy_app_driver_dict_get,
      NULL,
@@ -196,6 +196,7 @@ void RE_engine_report(RenderEngine *engine, int type, const char *msg);
 void RE_engine_set_error_message(RenderEngine *engine, const char *msg);
 
 int RE_engine_render(struct Render *re, int do_all);
+void RE_engine_free_depsgraphs(struct Render *re);
 
 bool RE_engine_is_external(struct Render *re);
 
@@ -123,6 +123,9 @@ struct Render {
   Depsgraph *pipeline_depsgraph;
   Scene *pipeline_scene_eval;
 
+  /* Dependency graphs of the render engine, see RE_engine_free_depsgraphs(). */
+  ListBase engine_depsgraphs;
+
 #ifdef WITH_FREESTYLE
   struct Main *freestyle_bmain;
   ListBase freestyle_renders;
@@ -504,13 +504,71 @@ RenderData *RE_engine_get_render_data(Render *re)
 }
 
 /* Depsgraph */
+
+/* Dependency graph of a view layer, kept in the render while rendering an animation so that the
+ * graph is not built again for every frame. Only the nodes and relations are kept between
+ * frames, evaluated datablocks are freed once the view layer is rendered. */
+typedef struct RenderDepsgraph {
+  struct RenderDepsgraph *next, *prev;
+  ViewLayer *view_layer;
+  Depsgraph *depsgraph;
+} RenderDepsgraph;
+
+static bool engine_depsgraph_use_cache(Render *re)
+{
+  /* Only animation render is guaranteed to free the cached graphs with RE_CleanAfterRender(),
+   * before the scene or main database might get freed. */
+  return (re->flag & R_ANIMATION) != 0;
+}
+
+static RenderDepsgraph *engine_depsgraph_cache_find(Render *re, const Depsgraph *depsgraph)
+{
+  return BLI_findptr(&re->engine_depsgraphs, depsgraph, offsetof(RenderDepsgraph, depsgraph));
+}
+
+static Depsgraph *engine_depsgraph_cache_ensure(Render *re, ViewLayer *view_layer)
+{
+  RenderDepsgraph *cached = BLI_findptr(
+      &re->engine_depsgraphs, view_layer, offsetof(RenderDepsgraph, view_layer));
+  if (cached != NULL) {
+    if (DEG_get_input_scene(cached->depsgraph) == re->scene) {
+      return cached->depsgraph;
+    }
+    DEG_graph_free(cached->depsgraph);
+    BLI_freelinkN(&re->engine_depsgraphs, cached);
+  }
+
+  cached = MEM_callocN(sizeof(RenderDepsgraph), __func__);
+  cached->view_layer = view_layer;
+  cached->depsgraph = DEG_graph_new(re->main, re->scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(cached->depsgraph, "RENDER");
+  BLI_addtail(&re->engine_depsgraphs, cached);
+  return cached->depsgraph;
+}
+
+void RE_engine_free_depsgraphs(Render *re)
+{
+  RenderDepsgraph *cached;
+  for (cached = re->engine_depsgraphs.first; cached != NULL; cached = cached->next) {
+    DEG_graph_free(cached->depsgraph);
+  }
+  BLI_freelistN(&re->engine_depsgraphs);
+}
+
 static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
 {
   Main *bmain = engine->re->main;
   Scene *scene = engine->re->scene;
 
-  engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(engine->depsgraph, "RENDER");
+  if (engine_depsgraph_use_cache(engine->re)) {
+    /* Relations of the graph are updated as part of the frame change if anything tagged them
+     * for an update since the previous frame. */
+    engine->depsgraph = engine_depsgraph_cache_ensure(engine->re, view_layer);
+  }
+  else {
+    engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+    DEG_debug_name_set(engine->depsgraph, "RENDER");
+  }
 
   if (engine->re->r.scemode & R_BUTS_PREVIEW) {
     Depsgraph *depsgraph = engine->depsgraph;
@@ -526,7 +584,16 @@ static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
 
 static void engine_depsgraph_free(RenderEngine *engine)
 {
-  DEG_graph_free(engine->depsgraph);
+  if (engine->depsgraph == NULL) {
+    return;
+  }
+
+  if (engine_depsgraph_cache_find(engine->re, engine->depsgraph) != NULL) {
+    DEG_graph_free_evaluated_data(engine->depsgraph);
+  }
+  else {
+    DEG_graph_free(engine->depsgraph);
+  }
 
   engine->depsgraph = NULL;
 }
@@ -882,6 +949,5 @@ void RE_engine_free_blender_memory(RenderEngine *engine)
   if (DRW_render_check_grease_pencil(engine->depsgraph)) {
     return;
   }
-  DEG_graph_free(engine->depsgraph);
-  engine->depsgraph = NULL;
+  engine_depsgraph_free(engine);
 }
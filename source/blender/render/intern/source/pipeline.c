@@ -654,6 +654,8 @@ void RE_FreeRender(Render *re)
     RE_engine_free(re->engine);
   }
 
+  RE_engine_free_depsgraphs(re);
+
   BLI_rw_mutex_end(&re->resultmutex);
   BLI_rw_mutex_end(&re->partsmutex);
 
@@ -2793,6 +2795,7 @@ void RE_CleanAfterRender(Render *re)
   }
   re->pipeline_depsgraph = NULL;
   re->pipeline_scene_eval = NULL;
+  RE_engine_free_depsgraphs(re);
 }
 
 /* note; repeated win/disprect calc... solve that nicer, also in compo */
@@ -1493,6 +1493,33 @@ void WM_autosave_init(wmWindowManager *wm)
   }
 }
 
+/**
+ * Auto-save writes a snapshot of the file (as undo data) from a job,
+ * so saving large files doesn't block the interface.
+ */
+typedef struct WMAutoSaveJob {
+  char filepath[FILE_MAX];
+  /** Chunks are shared with undo data, see #BLO_memfile_copy_shared. */
+  MemFile memfile;
+} WMAutoSaveJob;
+
+static void wm_autosave_job_startjob(void *customdata,
+                                     short *stop,
+                                     short *UNUSED(do_update),
+                                     float *progress)
+{
+  WMAutoSaveJob *asj = customdata;
+  /* Writes to a temporary file first, an interrupted save keeps the previous auto-save. */
+  BLO_memfile_write_file_ex(&asj->memfile, asj->filepath, stop, progress);
+}
+
+static void wm_autosave_job_free(void *customdata)
+{
+  WMAutoSaveJob *asj = customdata;
+  BLO_memfile_free(&asj->memfile);
+  MEM_freeN(asj);
+}
+
 void wm_autosave_timer(const bContext *C, wmWindowManager *wm, wmTimer *UNUSED(wt))
 {
   char filepath[FILE_MAX];
@@ -1515,26 +1542,45 @@ void wm_autosave_timer(const bContext *C, wmWindowManager *wm, wmTimer *UNUSED(w
     }
   }
 
+  /* Previous auto-save is still being written, try again later. */
+  if (WM_jobs_test(wm, wm, WM_JOB_TYPE_AUTOSAVE)) {
+    wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, 10.0);
+    return;
+  }
+
   wm_autosave_location(filepath);
 
+  WMAutoSaveJob *asj = MEM_callocN(sizeof(*asj), __func__);
+  BLI_strncpy(asj->filepath, filepath, sizeof(asj->filepath));
+
   if (U.uiflag & USER_GLOBALUNDO) {
     /* fast save of last undobuffer, now with UI */
     struct MemFile *memfile = ED_undosys_stack_memfile_get_active(wm->undo_stack);
-    if (memfile) {
-      BLO_memfile_write_file(memfile, filepath);
+    if (memfile == NULL) {
+      MEM_freeN(asj);
+      wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
+      return;
     }
+    /* Shares the undo data, the undo step may be freed while saving. */
+    BLO_memfile_copy_shared(&asj->memfile, memfile);
   }
   else {
-    /*  save as regular blend file */
+    /* save as regular blend file, serialize in memory so writing to disk doesn't block. */
     Main *bmain = CTX_data_main(C);
     int fileflags = G.fileflags & ~(G_FILE_COMPRESS | G_FILE_HISTORY);
 
     ED_editors_flush_edits(bmain, false);
 
-    /* Error reporting into console */
-    BLO_write_file(bmain, filepath, fileflags, NULL, NULL);
+    BLO_write_file_to_memfile(bmain, &asj->memfile, fileflags);
   }
-  /* do timer after file write, just in case file write takes a long time */
+
+  wmJob *wm_job = WM_jobs_get(wm, NULL, wm, "Auto-Saving", WM_JOB_PROGRESS, WM_JOB_TYPE_AUTOSAVE);
+  WM_jobs_customdata_set(wm_job, asj, wm_autosave_job_free);
+  WM_jobs_timer(wm_job, 0.1, 0, 0);
+  WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, NULL, NULL, NULL);
+  WM_jobs_start(wm, wm_job);
+
+  /* The timer restarts now, writing happens in the background. */
   wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
 }
 
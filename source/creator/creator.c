@@ -255,19 +255,28 @@ int main(int argc,
   /* NOTE: Special exception for guarded allocator type switch:
    *       we need to perform switch from lock-free to fully
    *       guarded allocator before any allocation happened.
+   *       The same goes for enabling the thread cache of the lock-free allocator.
    */
   {
+    bool use_thread_cache = false;
     int i;
     for (i = 0; i < argc; i++) {
       if (STR_ELEM(argv[i], "-d", "--debug", "--debug-memory", "--debug-all")) {
         printf("Switching to fully guarded memory allocator.\n");
         MEM_use_guarded_allocator();
+        use_thread_cache = false;
         break;
       }
+      else if (STREQ(argv[i], "--alloc-thread-cache")) {
+        use_thread_cache = true;
+      }
       else if (STREQ(argv[i], "--")) {
         break;
       }
     }
+    if (use_thread_cache) {
+      MEM_use_thread_cached_allocator();
+    }
   }
 
 #ifdef BUILD_DATE
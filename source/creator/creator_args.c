@@ -527,6 +527,8 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--render-output");
   BLI_argsPrintArgDoc(ba, "--engine");
   BLI_argsPrintArgDoc(ba, "--threads");
+  BLI_argsPrintArgDoc(ba, "--numa");
+  BLI_argsPrintArgDoc(ba, "--alloc-thread-cache");
 
   printf("\n");
   printf("Format Options:\n");
@@ -588,6 +590,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--debug-cycles");
 #  endif
   BLI_argsPrintArgDoc(ba, "--debug-memory");
+  BLI_argsPrintArgDoc(ba, "--memory-profile");
   BLI_argsPrintArgDoc(ba, "--debug-jobs");
   BLI_argsPrintArgDoc(ba, "--debug-python");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph");
@@ -597,6 +600,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-no-threads");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-time");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-pretty");
+  BLI_argsPrintArgDoc(ba, "--debug-depsgraph-validate");
   BLI_argsPrintArgDoc(ba, "--debug-gpu");
   BLI_argsPrintArgDoc(ba, "--debug-gpumem");
   BLI_argsPrintArgDoc(ba, "--debug-gpu-shaders");
@@ -966,6 +970,9 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_no_threads[] =
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_pretty[] =
     "\n\t"
     "Enable colors for dependency graph debug messages.";
+static const char arg_handle_debug_mode_generic_set_doc_depsgraph_validate[] =
+    "\n\t"
+    "Compare incremental dependency graph relations updates against a full rebuild (slow).";
 static const char arg_handle_debug_mode_generic_set_doc_gpumem[] =
     "\n\t"
     "Enable GPU memory stats in status bar.";
@@ -1044,6 +1051,36 @@ static int arg_handle_debug_mode_memory_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_memory_profile_set_doc[] =
+    "<bytes>\n"
+    "\tEnable the sampling memory profiler, with an average of <bytes> between samples,\n"
+    "\tusage per allocation name is printed on exit (see also 'bpy.app.memory_profile').";
+static int arg_handle_memory_profile_set(int argc, const char **argv, void *UNUSED(data))
+{
+  const char *arg_id = "--memory-profile";
+  const int min = 1, max = INT_MAX;
+  if (argc > 1) {
+    const char *err_msg = NULL;
+    int interval;
+    if (!parse_int_strict_range(argv[1], NULL, min, max, &interval, &err_msg)) {
+      printf("\nError: %s '%s %s', expected number in [%d..%d].\n",
+             err_msg,
+             arg_id,
+             argv[1],
+             min,
+             max);
+      return 1;
+    }
+
+    MEM_profile_sample_interval_set((size_t)interval);
+    return 1;
+  }
+  else {
+    printf("\nError: you must specify a sample interval in bytes '%s'.\n", arg_id);
+    return 0;
+  }
+}
+
 static const char arg_handle_debug_value_set_doc[] =
     "<value>\n"
     "\tSet debug value of <value> on startup.";
@@ -1477,6 +1514,30 @@ static int arg_handle_threads_set(int argc, const char **argv, void *UNUSED(data
   }
 }
 
+static const char arg_handle_numa_scheduling_set_doc[] =
+    "\n\t"
+    "Bind worker threads to NUMA nodes and prefer running tasks on the node they were created on\n"
+    "\t(only has an effect on systems with multiple NUMA nodes).";
+static int arg_handle_numa_scheduling_set(int UNUSED(argc),
+                                          const char **UNUSED(argv),
+                                          void *UNUSED(data))
+{
+  BLI_system_numa_scheduling_set(true);
+  return 0;
+}
+
+static const char arg_handle_alloc_thread_cache_set_doc[] =
+    "\n\t"
+    "Cache small memory blocks per thread, faster for heavily multi-threaded workloads\n"
+    "\t(ignored when the fully guarded allocator is used).";
+static int arg_handle_alloc_thread_cache_set(int UNUSED(argc),
+                                             const char **UNUSED(argv),
+                                             void *UNUSED(data))
+{
+  /* Handled in main(), the allocator must be switched before any allocation. */
+  return 0;
+}
+
 static const char arg_handle_verbosity_set_doc[] =
     "<verbose>\n"
     "\tSet logging verbosity level for debug messages which supports it.";
@@ -2092,6 +2153,7 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_argsAdd(ba, 1, NULL, "--debug-cycles", CB(arg_handle_debug_mode_cycles), NULL);
 #  endif
   BLI_argsAdd(ba, 1, NULL, "--debug-memory", CB(arg_handle_debug_mode_memory_set), NULL);
+  BLI_argsAdd(ba, 1, NULL, "--memory-profile", CB(arg_handle_memory_profile_set), NULL);
 
   BLI_argsAdd(ba, 1, NULL, "--debug-value", CB(arg_handle_debug_value_set), NULL);
   BLI_argsAdd(ba,
@@ -2148,6 +2210,12 @@ void main_args_setup(bContext *C, bArgs *ba)
               "--debug-depsgraph-pretty",
               CB_EX(arg_handle_debug_mode_generic_set, depsgraph_pretty),
               (void *)G_DEBUG_DEPSGRAPH_PRETTY);
+  BLI_argsAdd(ba,
+              1,
+              NULL,
+              "--debug-depsgraph-validate",
+              CB_EX(arg_handle_debug_mode_generic_set, depsgraph_validate),
+              (void *)G_DEBUG_DEPSGRAPH_VALIDATE);
   BLI_argsAdd(ba,
               1,
               NULL,
@@ -2216,6 +2284,9 @@ void main_args_setup(bContext *C, bArgs *ba)
 
   BLI_argsAdd(ba, 4, "-F", "--render-format", CB(arg_handle_image_type_set), C);
   BLI_argsAdd(ba, 1, "-t", "--threads", CB(arg_handle_threads_set), NULL);
+  BLI_argsAdd(ba, 1, NULL, "--numa", CB(arg_handle_numa_scheduling_set), NULL);
+  BLI_argsAdd(
+      ba, 1, NULL, "--alloc-thread-cache", CB(arg_handle_alloc_thread_cache_set), NULL);
   BLI_argsAdd(ba, 4, "-x", "--use-extension", CB(arg_handle_extension_set), C);
 
 #  undef CB
@@ -190,3 +190,215 @@ TEST(task, ListBaseIter100k)
 {
   task_listbase_test("ListBase parallel iteration - Threaded - 100000 items", 100000, true);
 }
+
+/* *** Task pool scheduling contention, lots of tiny tasks. *** */
+
+#define NUM_RUN_CONTENTION 10
+
+static void task_pool_contention_func(TaskPool *__restrict pool, void *taskdata, int thread_id)
+{
+  const int depth = POINTER_AS_INT(taskdata);
+  uint32_t *count = (uint32_t *)BLI_task_pool_userdata(pool);
+
+  atomic_add_and_fetch_uint32(count, 1);
+
+  /* Spawn children from within the task, as depsgraph evaluation does. */
+  if (depth > 0) {
+    for (int i = 0; i < 2; i++) {
+      BLI_task_pool_push_from_thread(pool,
+                                     task_pool_contention_func,
+                                     POINTER_FROM_INT(depth - 1),
+                                     false,
+                                     TASK_PRIORITY_HIGH,
+                                     thread_id);
+    }
+  }
+}
+
+static void task_pool_contention_test(const char *id,
+                                      const int num_threads,
+                                      const int num_roots,
+                                      const int depth,
+                                      const bool use_numa)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+  BLI_system_numa_scheduling_set(use_numa);
+  TaskScheduler *scheduler = BLI_task_scheduler_create(num_threads);
+
+  /* Binary tree of tasks below each root task. */
+  const uint32_t num_tasks = (uint32_t)num_roots * ((2u << depth) - 1);
+
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_CONTENTION; i++) {
+    uint32_t count = 0;
+    const double init_time = PIL_check_seconds_timer();
+
+    TaskPool *pool = BLI_task_pool_create(scheduler, &count);
+    for (int j = 0; j < num_roots; j++) {
+      BLI_task_pool_push(
+          pool, task_pool_contention_func, POINTER_FROM_INT(depth), false, TASK_PRIORITY_HIGH);
+    }
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+
+    EXPECT_EQ(count, num_tasks);
+  }
+
+  printf("\t%u tasks on %d threads: done in %fs on average over %d runs\n",
+         num_tasks,
+         BLI_task_scheduler_num_threads(scheduler),
+         averaged_timing / NUM_RUN_CONTENTION,
+         NUM_RUN_CONTENTION);
+
+  BLI_task_scheduler_free(scheduler);
+  BLI_system_numa_scheduling_set(false);
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(task, PoolContentionFlat100k)
+{
+  /* All tasks pushed from the main thread, no spawning from within tasks. */
+  task_pool_contention_test("Task pool contention - Flat - 100000 tasks", 0, 100000, 0, false);
+}
+
+TEST(task, PoolContentionSpawn128k)
+{
+  task_pool_contention_test(
+      "Task pool contention - Spawned from tasks - 131056 tasks", 0, 16, 12, false);
+}
+
+TEST(task, PoolContentionSpawnNUMA128k)
+{
+  /* Same as above, with worker threads bound to NUMA nodes (when there are multiple ones). */
+  task_pool_contention_test(
+      "Task pool contention - NUMA - Spawned from tasks - 131056 tasks", 0, 16, 12, true);
+}
+
+static void task_range_contention_iter_func(void *userdata,
+                                            const int index,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  int *data = (int *)userdata;
+  data[index] += index;
+}
+
+TEST(task, ParallelRangeContention1M)
+{
+  const int num_items = 1000000;
+  int *data = (int *)MEM_calloc_arrayN(num_items, sizeof(*data), __func__);
+
+  BLI_threadapi_init();
+
+  /* Smallest possible chunks, so threads constantly fetch new work. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+  settings.min_iter_per_thread = 1;
+
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_CONTENTION; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    BLI_task_parallel_range(0, num_items, data, task_range_contention_iter_func, &settings);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+  }
+
+  for (int i = 0; i < num_items; i++) {
+    EXPECT_EQ(data[i], i * NUM_RUN_CONTENTION);
+  }
+
+  printf("\tParallel range contention - 1000000 items: done in %fs on average over %d runs\n",
+         averaged_timing / NUM_RUN_CONTENTION,
+         NUM_RUN_CONTENTION);
+
+  MEM_freeN(data);
+  BLI_threadapi_exit();
+}
+
+/* *** Parallel range with per-thread userdata chunks, optionally NUMA-aware. *** */
+
+typedef struct RangeChunkData {
+  int *data;
+  int64_t total;
+} RangeChunkData;
+
+static void task_range_chunk_iter_func(void *userdata,
+                                       const int index,
+                                       const TaskParallelTLS *__restrict tls)
+{
+  RangeChunkData *range_data = (RangeChunkData *)userdata;
+  int64_t *sum = (int64_t *)tls->userdata_chunk;
+
+  range_data->data[index] = index % 7;
+  *sum += range_data->data[index];
+}
+
+static void task_range_chunk_finalize_func(void *__restrict userdata,
+                                           void *__restrict userdata_chunk)
+{
+  RangeChunkData *range_data = (RangeChunkData *)userdata;
+  int64_t *sum = (int64_t *)userdata_chunk;
+
+  range_data->total += *sum;
+}
+
+static void task_range_chunk_test(const char *id, const int num_items, const bool use_numa)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+  /* Must be set before the global scheduler is created. */
+  BLI_system_numa_scheduling_set(use_numa);
+
+  RangeChunkData range_data;
+  range_data.data = (int *)MEM_calloc_arrayN(num_items, sizeof(*range_data.data), __func__);
+
+  int64_t expected_total = 0;
+  for (int i = 0; i < num_items; i++) {
+    expected_total += i % 7;
+  }
+
+  int64_t sum = 0;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &sum;
+  settings.userdata_chunk_size = sizeof(sum);
+  settings.func_finalize = task_range_chunk_finalize_func;
+
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_CONTENTION; i++) {
+    range_data.total = 0;
+    const double init_time = PIL_check_seconds_timer();
+    BLI_task_parallel_range(0, num_items, &range_data, task_range_chunk_iter_func, &settings);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+
+    EXPECT_EQ(range_data.total, expected_total);
+  }
+
+  printf("\t%s: done in %fs on average over %d runs\n",
+         use_numa ? "NUMA" : "Default",
+         averaged_timing / NUM_RUN_CONTENTION,
+         NUM_RUN_CONTENTION);
+
+  MEM_freeN(range_data.data);
+  BLI_system_numa_scheduling_set(false);
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(task, ParallelRangeChunk10M)
+{
+  task_range_chunk_test("Parallel range with userdata chunks - 10000000 items", 10000000, false);
+}
+
+TEST(task, ParallelRangeChunkNUMA10M)
+{
+  task_range_chunk_test(
+      "Parallel range with userdata chunks - NUMA - 10000000 items", 10000000, true);
+}
@@ -13,6 +13,8 @@ extern "C" {
 #include "BLI_task.h"
 
 #include "MEM_guardedalloc.h"
+
+#include "PIL_time.h"
 };
 
 #define NUM_ITEMS 10000
@@ -127,3 +129,44 @@ TEST(task, ListBaseIter)
   MEM_freeN(items_buffer);
   BLI_threadapi_exit();
 }
+
+/* *** Order of tasks pushed to a suspended pool. *** */
+
+#define NUM_TASKS 64
+
+typedef struct TaskPoolOrderData {
+  int first_task_calling_thread;
+  int num_tasks_done;
+} TaskPoolOrderData;
+
+static void task_pool_order_func(TaskPool *__restrict pool, void *taskdata, int thread_id)
+{
+  TaskPoolOrderData *data = (TaskPoolOrderData *)BLI_task_pool_userdata(pool);
+  if (thread_id == 0) {
+    atomic_cas_int32(&data->first_task_calling_thread, -1, POINTER_AS_INT(taskdata));
+  }
+  PIL_sleep_ms(1);
+  atomic_add_and_fetch_int32(&data->num_tasks_done, 1);
+}
+
+/* The thread waiting for the pool runs the first pushed task first, other threads take tasks
+ * from the end. The dependency graph scheduler relies on this order. */
+TEST(task, SuspendedPoolOrder)
+{
+  BLI_threadapi_init();
+  TaskScheduler *scheduler = BLI_task_scheduler_create(4);
+  TaskPoolOrderData data = {-1, 0};
+  TaskPool *pool = BLI_task_pool_create_suspended(scheduler, &data);
+
+  for (int i = 0; i < NUM_TASKS; i++) {
+    BLI_task_pool_push(pool, task_pool_order_func, POINTER_FROM_INT(i), false, TASK_PRIORITY_HIGH);
+  }
+  BLI_task_pool_work_and_wait(pool);
+
+  EXPECT_EQ(data.num_tasks_done, NUM_TASKS);
+  EXPECT_EQ(data.first_task_calling_thread, 0);
+
+  BLI_task_pool_free(pool);
+  BLI_task_scheduler_free(scheduler);
+  BLI_threadapi_exit();
+}
@@ -0,0 +1,117 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <string.h>
+#include <vector>
+
+#include "zlib.h"
+
+extern "C" {
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_genfile.h"
+#include "DNA_listBase.h"
+#include "DNA_sdna_types.h"
+
+#include "BLO_blend_defs.h"
+#include "BLO_readfile.h"
+
+#include "intern/readfile.h"
+}
+
+/* Payload larger than #BLO_ZLIB_BLOCK_SIZE, so it spans several gzip members. */
+#define DATA_LEN ((3 << 20) + 123)
+
+static void blendfile_append(std::vector<char> &file, const void *data, size_t data_len)
+{
+  const char *data_c = (const char *)data;
+  file.insert(file.end(), data_c, data_c + data_len);
+}
+
+static void blendfile_append_bhead(std::vector<char> &file, int code, const void *data, int len)
+{
+  BHead bhead = {0};
+  bhead.code = code;
+  bhead.len = len;
+  bhead.old = (const void *)(uintptr_t)(file.size() + 1);
+  bhead.nr = 1;
+  blendfile_append(file, &bhead, sizeof(bhead));
+  if (len) {
+    blendfile_append(file, data, (size_t)len);
+  }
+}
+
+/* Compress the file the way the writer does, as a series of independent gzip members of at
+ * most #BLO_ZLIB_BLOCK_SIZE bytes each. */
+static std::vector<char> blendfile_compress(const std::vector<char> &file)
+{
+  std::vector<char> result;
+  for (size_t offset = 0; offset < file.size(); offset += BLO_ZLIB_BLOCK_SIZE) {
+    const size_t in_len = MIN2(file.size() - offset, (size_t)BLO_ZLIB_BLOCK_SIZE);
+    std::vector<char> out(compressBound((uLong)in_len) + 64);
+
+    z_stream strm = {NULL};
+    EXPECT_EQ(deflateInit2(&strm, 1, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY), Z_OK);
+    strm.next_in = (Bytef *)&file[offset];
+    strm.avail_in = (uInt)in_len;
+    strm.next_out = (Bytef *)out.data();
+    strm.avail_out = (uInt)out.size();
+    EXPECT_EQ(deflate(&strm, Z_FINISH), Z_STREAM_END);
+    blendfile_append(result, out.data(), strm.total_out);
+    deflateEnd(&strm);
+  }
+  return result;
+}
+
+TEST(blenloader_readfile, GzipMembersFromMemory)
+{
+  DNA_sdna_current_init();
+
+  const int endian_test = 1;
+  std::vector<char> file;
+  char header[SIZEOFBLENDERHEADER + 1];
+  BLI_snprintf(header,
+               sizeof(header),
+               "BLENDER%c%c280",
+               (sizeof(void *) == 8) ? '-' : '_',
+               (*(const char *)&endian_test == 1) ? 'v' : 'V');
+  blendfile_append(file, header, SIZEOFBLENDERHEADER);
+
+  std::vector<int> data(DATA_LEN / sizeof(int));
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = (int)i;
+  }
+  blendfile_append_bhead(file, DATA, data.data(), (int)(data.size() * sizeof(int)));
+  blendfile_append_bhead(file, DNA1, DNAstr, DNAlen);
+  blendfile_append_bhead(file, ENDB, NULL, 0);
+  EXPECT_GT(file.size(), (size_t)BLO_ZLIB_BLOCK_SIZE);
+
+  std::vector<char> file_gz = blendfile_compress(file);
+  EXPECT_GT(file_gz.size(), (size_t)0);
+
+  FileData *fd = blo_filedata_from_memory(file_gz.data(), (int)file_gz.size(), NULL);
+  ASSERT_TRUE(fd != NULL);
+
+  int codes_found = 0;
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code == DATA) {
+      EXPECT_EQ(bhead->len, (int)(data.size() * sizeof(int)));
+      EXPECT_EQ(memcmp(bhead + 1, data.data(), data.size() * sizeof(int)), 0);
+      codes_found |= 1 << 0;
+    }
+    else if (bhead->code == DNA1) {
+      EXPECT_EQ(bhead->len, DNAlen);
+      codes_found |= 1 << 1;
+    }
+    else if (bhead->code == ENDB) {
+      codes_found |= 1 << 2;
+      break;
+    }
+  }
+  EXPECT_EQ(codes_found, 7);
+
+  blo_filedata_free(fd);
+  DNA_sdna_current_free();
+}
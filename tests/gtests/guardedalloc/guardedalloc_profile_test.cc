@@ -0,0 +1,162 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <string.h>
+
+extern "C" {
+#include "BLI_utildefines.h"
+}
+
+#include "MEM_guardedalloc.h"
+
+#define CHECK_ALIGNMENT(ptr, align) EXPECT_EQ((size_t)ptr % align, 0)
+
+namespace {
+
+const MEM_ProfileStats *find_stats(const MEM_ProfileStats *stats,
+                                   unsigned int len,
+                                   const char *name)
+{
+  for (unsigned int i = 0; i < len; i++) {
+    if (STREQ(stats[i].name, name)) {
+      return &stats[i];
+    }
+  }
+  return NULL;
+}
+
+}  // namespace
+
+TEST(guardedalloc, ProfileExact)
+{
+  /* Sizes are at least the interval, so every allocation is sampled with its own size. */
+  MEM_profile_sample_interval_set(1);
+
+  const size_t mem_in_use_init = MEM_get_memory_in_use();
+  void *a = MEM_mallocN(64, "profile_a");
+  void *b = MEM_callocN(128, "profile_b");
+  void *c = MEM_mallocN_aligned(256, 64, "profile_b");
+  CHECK_ALIGNMENT(c, 64);
+  EXPECT_EQ(MEM_allocN_len(c), 256);
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use_init + 64 + 128 + 256);
+  for (int i = 0; i < 128; i++) {
+    EXPECT_EQ(((char *)b)[i], 0);
+  }
+
+  unsigned int len;
+  MEM_ProfileStats *stats = MEM_profile_stats_get(false, &len);
+  const MEM_ProfileStats *stats_a = find_stats(stats, len, "profile_a");
+  const MEM_ProfileStats *stats_b = find_stats(stats, len, "profile_b");
+  ASSERT_NE(stats_a, nullptr);
+  ASSERT_NE(stats_b, nullptr);
+  EXPECT_EQ(stats_a->mem_in_use, 64);
+  EXPECT_EQ(stats_a->blocks_in_use, 1);
+  EXPECT_EQ(stats_b->mem_in_use, 128 + 256);
+  EXPECT_EQ(stats_b->blocks_in_use, 2);
+  EXPECT_EQ(stats_b->call_site, nullptr);
+  MEM_profile_stats_free(stats);
+
+  /* Reallocation keeps the alignment and accounts to the new name. */
+  c = MEM_reallocN_id(c, 512, "profile_c");
+  CHECK_ALIGNMENT(c, 64);
+  void *a_dup = MEM_dupallocN(a);
+
+  MEM_freeN(b);
+  MEM_profile_sample_interval_set(0);
+
+  stats = MEM_profile_stats_get(true, &len);
+  stats_b = find_stats(stats, len, "profile_b");
+  const MEM_ProfileStats *stats_c = find_stats(stats, len, "profile_c");
+  ASSERT_NE(stats_b, nullptr);
+  ASSERT_NE(stats_c, nullptr);
+  EXPECT_EQ(stats_b->mem_in_use, 0);
+  EXPECT_EQ(stats_b->total_blocks, 1);
+  EXPECT_EQ(stats_c->mem_in_use, 512);
+  EXPECT_NE(stats_c->call_site, nullptr);
+  MEM_profile_stats_free(stats);
+
+  MEM_freeN(a);
+  MEM_freeN(a_dup);
+  MEM_freeN(c);
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use_init);
+
+  MEM_profile_reset();
+  stats = MEM_profile_stats_get(false, &len);
+  for (unsigned int i = 0; i < len; i++) {
+    if (strncmp(stats[i].name, "profile_", 8) == 0) {
+      EXPECT_EQ(stats[i].mem_in_use, 0);
+      EXPECT_EQ(stats[i].peak_mem, 0);
+      EXPECT_EQ(stats[i].total_mem, 0);
+    }
+  }
+  MEM_profile_stats_free(stats);
+}
+
+TEST(guardedalloc, ProfileSampled)
+{
+  MEM_profile_sample_interval_set(4096);
+
+  void *blocks[10000];
+  for (int i = 0; i < ARRAY_SIZE(blocks); i++) {
+    blocks[i] = MEM_mallocN(64, "profile_sampled");
+  }
+
+  unsigned int len;
+  MEM_ProfileStats *stats = MEM_profile_stats_get(false, &len);
+  const MEM_ProfileStats *stats_sampled = find_stats(stats, len, "profile_sampled");
+  ASSERT_NE(stats_sampled, nullptr);
+  /* Estimate should be in the right order of magnitude. */
+  EXPECT_GT(stats_sampled->mem_in_use, ARRAY_SIZE(blocks) * 64 / 2);
+  EXPECT_LT(stats_sampled->mem_in_use, ARRAY_SIZE(blocks) * 64 * 2);
+  MEM_profile_stats_free(stats);
+
+  for (int i = 0; i < ARRAY_SIZE(blocks); i++) {
+    MEM_freeN(blocks[i]);
+  }
+  MEM_profile_sample_interval_set(0);
+
+  stats = MEM_profile_stats_get(false, &len);
+  stats_sampled = find_stats(stats, len, "profile_sampled");
+  ASSERT_NE(stats_sampled, nullptr);
+  EXPECT_EQ(stats_sampled->mem_in_use, 0);
+  EXPECT_EQ(stats_sampled->blocks_in_use, 0);
+  MEM_profile_stats_free(stats);
+}
+
+TEST(guardedalloc, ProfileCallSite)
+{
+  MEM_profile_sample_interval_set(1);
+
+  /* Allocations done through wrappers are reported for the code calling the wrapper, so every
+   * call below has its own call site. */
+  void *blocks[3];
+  blocks[0] = MEM_malloc_arrayN(4, 16, "profile_call_site");
+  blocks[1] = MEM_malloc_arrayN(4, 16, "profile_call_site");
+  blocks[2] = MEM_calloc_arrayN(4, 16, "profile_call_site");
+
+  unsigned int len;
+  MEM_ProfileStats *stats = MEM_profile_stats_get(true, &len);
+  const void *call_sites[ARRAY_SIZE(blocks)];
+  int call_sites_len = 0;
+  for (unsigned int i = 0; i < len; i++) {
+    if (STREQ(stats[i].name, "profile_call_site")) {
+      ASSERT_LT(call_sites_len, ARRAY_SIZE(call_sites));
+      EXPECT_EQ(stats[i].mem_in_use, 64);
+      EXPECT_NE(stats[i].call_site, nullptr);
+      call_sites[call_sites_len++] = stats[i].call_site;
+    }
+  }
+  MEM_profile_stats_free(stats);
+  EXPECT_EQ(call_sites_len, ARRAY_SIZE(blocks));
+  for (int i = 0; i < call_sites_len; i++) {
+    for (int j = i + 1; j < call_sites_len; j++) {
+      EXPECT_NE(call_sites[i], call_sites[j]);
+    }
+  }
+
+  for (int i = 0; i < ARRAY_SIZE(blocks); i++) {
+    MEM_freeN(blocks[i]);
+  }
+  MEM_profile_sample_interval_set(0);
+}
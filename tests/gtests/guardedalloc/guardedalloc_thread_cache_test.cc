@@ -0,0 +1,135 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "BLI_utildefines.h"
+}
+
+#include "MEM_guardedalloc.h"
+
+#define NUM_BLOCKS 1000
+
+namespace {
+
+struct ThreadCacheTest : public ::testing::Test {
+  size_t mem_in_use_init;
+  unsigned int blocks_init;
+
+  void SetUp() override
+  {
+    MEM_use_thread_cached_allocator();
+    mem_in_use_init = MEM_get_memory_in_use();
+    blocks_init = MEM_get_memory_blocks_in_use();
+  }
+
+  void TearDown() override
+  {
+    EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use_init);
+    EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_init);
+  }
+};
+
+void alloc_blocks(std::vector<void *> &blocks)
+{
+  for (int i = 0; i < NUM_BLOCKS; i++) {
+    blocks.push_back(MEM_mallocN((size_t)(i % 600) + 1, __func__));
+  }
+}
+
+void free_blocks(std::vector<void *> &blocks)
+{
+  for (void *ptr : blocks) {
+    MEM_freeN(ptr);
+  }
+  blocks.clear();
+}
+
+}  // namespace
+
+TEST_F(ThreadCacheTest, AllocFree)
+{
+  std::vector<void *> blocks;
+
+  /* Twice, so the second time blocks come from the cache. */
+  for (int pass = 0; pass < 2; pass++) {
+    alloc_blocks(blocks);
+    EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_init + NUM_BLOCKS);
+    EXPECT_GE(MEM_get_peak_memory(), MEM_get_memory_in_use());
+    for (int i = 0; i < NUM_BLOCKS; i++) {
+      EXPECT_EQ(MEM_allocN_len(blocks[i]), (size_t)((i % 600) + 4) & ~(size_t)3);
+    }
+    free_blocks(blocks);
+  }
+}
+
+TEST_F(ThreadCacheTest, Calloc)
+{
+  char *ptr = (char *)MEM_mallocN(64, __func__);
+  memset(ptr, 1, 64);
+  MEM_freeN(ptr);
+
+  ptr = (char *)MEM_callocN(64, __func__);
+  for (int i = 0; i < 64; i++) {
+    EXPECT_EQ(ptr[i], 0);
+  }
+  MEM_freeN(ptr);
+}
+
+TEST_F(ThreadCacheTest, ReallocDup)
+{
+  int *ptr = (int *)MEM_mallocN(sizeof(int) * 8, __func__);
+  for (int i = 0; i < 8; i++) {
+    ptr[i] = i;
+  }
+
+  int *dup = (int *)MEM_dupallocN(ptr);
+  EXPECT_EQ(MEM_allocN_len(dup), sizeof(int) * 8);
+
+  /* Grow past the largest cached size. */
+  ptr = (int *)MEM_reallocN(ptr, sizeof(int) * 1024);
+  EXPECT_EQ(MEM_allocN_len(ptr), sizeof(int) * 1024);
+  ptr = (int *)MEM_recallocN(ptr, sizeof(int) * 4);
+  EXPECT_EQ(MEM_allocN_len(ptr), sizeof(int) * 4);
+
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(ptr[i], i);
+    EXPECT_EQ(dup[i], i);
+  }
+
+  MEM_freeN(ptr);
+  MEM_freeN(dup);
+}
+
+TEST_F(ThreadCacheTest, FreeOtherThread)
+{
+  std::vector<void *> blocks;
+
+  std::thread alloc_thread([&blocks]() { alloc_blocks(blocks); });
+  alloc_thread.join();
+  /* Counters of the exited thread must have been merged. */
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_init + NUM_BLOCKS);
+
+  std::thread free_thread([&blocks]() { free_blocks(blocks); });
+  free_thread.join();
+}
+
+TEST_F(ThreadCacheTest, ManyThreads)
+{
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([]() {
+      std::vector<void *> blocks;
+      for (int pass = 0; pass < 10; pass++) {
+        alloc_blocks(blocks);
+        free_blocks(blocks);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}